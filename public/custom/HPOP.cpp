@@ -25,6 +25,7 @@
 #include <condition_variable>
 #include <functional>
 #include <chrono>
+#include <memory>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -34,10 +35,18 @@
 #endif
 
 #include "GNU_iomanip.h"
+#include "SAT_Batch.h"
+#include "SAT_Access.h"
 #include "SAT_Const.h"
+#include "SAT_Context.h"
 #include "SAT_DE.h"
+#include "SAT_Density.h"
+#include "SAT_Ephem.h"
 #include "SAT_Force.h"
+#include "SAT_Gravity.h"
+#include "SAT_Parallel.h"
 #include "SAT_RefSys.h"
+#include "SAT_SunMoon.h"
 #include "SAT_Time.h"
 #include "SAT_VecMat.h"
 #include "APC_Moon.h"
@@ -53,21 +62,39 @@ using namespace std;
 // Global types and data
 //
 //------------------------------------------------------------------------------
-Matrix cnm(361,361),snm(361,361);
 const double R_ref = 6378.1363e3;   // Earth's radius [m]; GGM03C
 const double GM_ref =398600.4415e9; // [m^3/s^2]; GGM03C
-eopdata eoparr[eopsize];
-spwdata spwarr[spwsize];
-int dat;
-double jdeopstart,dut1,lod,xp,yp,ddpsi,ddeps,dx,dy,x,y,s,deltapsi,deltaeps;
-double jdspwstart,f107a,f107,f107bar,ap,avgap,kp,sumkp,aparr[8],kparr[8];
+const int    N_ggm = 360;           // Maximum degree of GGM03C
+GravityField ggm(0,GM_ref,R_ref);   // Normalized coefficients of GGM03C
+                                    // (LoadGravityModel)
+eoptable eoptab;                    // EOP and space weather tables (shared,
+spwtable spwtab;                    // read-only after LoadEarthData)
+
+// Integration methods of Ephemeris
+enum INTEGRATOR {
+  INT_RK4   = 0,    // 4th-order Runge-Kutta, step size = output step
+  INT_RKF78 = 1,    // Runge-Kutta-Fehlberg 7(8) with step size control
+  INT_GJ8   = 2,    // 8th-order Gauss-Jackson, step size = output step
+  INT_DE    = 3     // Shampine-Gordon variable order multistep method
+};
 
 // Record for passing global data between Deriv and the calling program
 struct AuxParam {
   double  Mjd_UTC;
   double  Area_drag,Area_solar,mass,CR,CD;
   int     n,m;
-  bool    Sun,Moon,SRad,Drag,SolidEarthTides,OceanTides,Relativity;
+  bool    Sun,Moon,SRad,SolidEarthTides,OceanTides,Relativity;
+  DENSITY_MODEL DragModel;          // Density model of the drag (DENS_NONE: off)
+  PropagationContext* Ctx;          // EOP/space weather state of the job
+  const HarmonicGravity* Gravity;   // Harmonic gravity field (degree n, order m)
+  const FrameCache*   Frames;       // Precession-nutation table (optional)
+  const SunMoonCache* Bodies;       // Sun/Moon ephemeris cache (optional)
+  const DensityModel* Atmosphere;   // Atmospheric density model (optional)
+  double  TideInterval;             // Reuse of tidal corrections [s]
+  INTEGRATOR Integrator;            // Integration method of Ephemeris
+  double  relerr,abserr;            // Accuracy requirements (RKF78, DE) and
+                                    // corrector tolerances (GJ8)
+  int     CorrIter;                 // Corrector re-evaluations per step (GJ8)
 };
 
 //------------------------------------------------------------------------------
@@ -84,6 +111,8 @@ struct AuxParam {
 //
 // Input/Output:
 //
+//   Ctx         Propagation context; updated for the given epoch
+//   Gravity     Harmonic gravity field (degree n, order m)
 //   Mjd_UTC     Modified Julian Date (UTC)
 //   r           Satellite position vector in the ICRF/EME2000 system
 //   v           Satellite velocity vector in the ICRF/EME2000 system
@@ -92,44 +121,32 @@ struct AuxParam {
 //   mass        Spacecraft mass
 //   CR          Radiation pressure coefficient
 //   CD          Drag coefficient
-//   n           Maximum degree
-//   m           Maximum order (m_max<=n_max; m_max=0 for zonals, only)
 //   <return>    Acceleration (a=d^2r/dt^2) in the ICRF/EME2000 system
 //
 //------------------------------------------------------------------------------
-Vector Accel(double Mjd_UTC, const Vector& r, const Vector& v, double Area_drag,
-             double Area_solar,double mass, double CR, double CD, int n, int m,
-             bool FlagSun, bool FlagMoon, bool FlagSRad, bool FlagDrag, bool
-             FlagSolidEarthTides, bool FlagOceanTides, bool FlagRelativity)
+Vec3 Accel(PropagationContext& Ctx, const HarmonicGravity& Gravity,
+           double Mjd_UTC, const Vec3& r, const Vec3& v,
+           double Area_drag, double Area_solar,double mass, double CR, double CD,
+           bool FlagSun, bool FlagMoon, bool FlagSRad, bool FlagDrag,
+           bool FlagSolidEarthTides, bool FlagOceanTides, bool FlagRelativity)
 {
-  double Mjd_UT1, Mjd_TT, jd, mfme;
-  double T1;     // Julian cent. since J2000
-  Vector a(3), r_Sun(3), r_Moon(3);
-  Matrix P(3,3),N(3,3), T(3,3), E(3,3);
-  char interp = 'l';
-
-  jd = Mjd_UTC + 2400000.5;
-  mfme = 1440.0*(Mjd_UTC - floor(Mjd_UTC));
-  findeopparam(jd, mfme, interp, eoparr, jdeopstart, dut1, dat, lod, xp, yp,
-               ddpsi, ddeps, dx, dy, x, y, s, deltapsi, deltaeps);
-  IERS::Set(dut1, -dat, xp, yp);
-  Mjd_UT1 = Mjd_UTC + IERS::UT1_UTC(Mjd_UTC)/86400.0;
-  Mjd_TT = Mjd_UTC + IERS::TT_UTC(Mjd_UTC)/86400.0;
-
-  P = PrecMatrix(MJD_J2000,Mjd_TT);
-  N = NutMatrix(Mjd_TT);
-  T = N*P;
-  E = PoleMatrix(Mjd_UTC) * GHAMatrix(Mjd_UT1,Mjd_TT) * T;
-
-  T1   = (Mjd_TT-MJD_J2000)/36525.0;
-  r_Sun  = AU*Transp(EclMatrix(Mjd_TT)*P)*SunPos(T1);
-  r_Moon = Transp(EclMatrix(Mjd_TT)*P)*MoonPos(T1);
+  Vec3   a, r_Sun, r_Moon;
+  EarthFrame F;
+  bool   Tides = FlagSolidEarthTides || FlagOceanTides;
+
+  ComputeEarthFrame(Ctx, Mjd_UTC, F);
+  const Mat3& T = F.T;
+  const Mat3& E = F.E;
+
+  // Sun and Moon positions (only if required by the force model)
+  if (FlagSun || FlagSRad || Tides) r_Sun  = SunPosition(Ctx, F);
+  if (FlagMoon || Tides)            r_Moon = MoonPosition(Ctx, F);
 
   // Acceleration due to harmonic gravity field
-  if (FlagSolidEarthTides || FlagOceanTides){
-  a = AccelHarmonic_AnelasticEarth(Mjd_UTC, r, r_Sun, r_Moon, E, GM_ref, R_ref, cnm, snm,
-                                   n, m, xp, yp, FlagSolidEarthTides, FlagOceanTides);
-  }else{ a = AccelHarmonic(r, E, GM_ref, R_ref, cnm, snm, n, m); }
+  if (Tides){
+  a = AccelHarmonic_AnelasticEarth(Ctx, Mjd_UTC, r, r_Sun, r_Moon, E, Gravity,
+                                   FlagSolidEarthTides, FlagOceanTides);
+  }else{ a = Gravity.Accel(r, E); }
 
   // Luni-solar perturbations
   if (FlagSun)  a += AccelPointMass(r, r_Sun,  GM_Sun );
@@ -139,7 +156,7 @@ Vector Accel(double Mjd_UTC, const Vector& r, const Vector& v, double Area_drag,
   if (FlagSRad) a += AccelSolrad(r, r_Sun, Area_solar, mass, CR, P_Sol, AU);
 
   // Atmospheric drag
-  if (FlagDrag) a += AccelDrag(Mjd_UTC, r, v, T, E, Area_drag, mass, CD);
+  if (FlagDrag) a += AccelDrag(Ctx, Mjd_UTC, r, v, T, E, Area_drag, mass, CD);
 
   // Relativistic Effects
   if (FlagRelativity) a += Relativity(r,v);
@@ -172,32 +189,161 @@ void Deriv(double t, const Vector& y, Vector& yp, void* pAux)
   double  Mjd_UTC = (*p).Mjd_UTC + t/86400.0;
 
   // State vector components
-  Vector r = y.slice(0,2);
-  Vector v = y.slice(3,5);
+  Vec3 r ( y(0), y(1), y(2) );
+  Vec3 v ( y(3), y(4), y(5) );
 
   // Acceleration
-  Vector a(3);
+  Vec3 a;
 
-  a = Accel(Mjd_UTC, r, v, (*p).Area_drag, (*p).Area_solar, (*p).mass, (*p).CR, (*p).CD,
-            (*p).n, (*p).m, (*p).Sun, (*p).Moon, (*p).SRad, (*p).Drag, (*p).SolidEarthTides,
+  a = Accel(*(*p).Ctx, *(*p).Gravity, Mjd_UTC, r, v, (*p).Area_drag, (*p).Area_solar, (*p).mass, (*p).CR, (*p).CD,
+            (*p).Sun, (*p).Moon, (*p).SRad, (*p).DragModel!=DENS_NONE, (*p).SolidEarthTides,
             (*p).OceanTides, (*p).Relativity);
 
   // State vector derivative
-  yp = Stack(v, a);
+  for (int i=0; i<3; i++) {
+    yp(i)   = v(i);
+    yp(i+3) = a(i);
+  }
 };
 
-void Ephemeris(const Vector& Y0, int N_Step, double Step, AuxParam p, Vector Eph[])
+// Propagation of Y0 to the N_Step+1 output points; returns the number of
+// evaluations of Deriv
+long Ephemeris(const Vector& Y0, int N_Step, double Step, AuxParam p, Vector Eph[])
 {
     int       i;
     double    t = 0.0;
-    RK4       Orbit(Deriv,6,&p);
+    PropagationContext Ctx;            // Private EOP/space weather state
     Vector    Y(6);
 
+    p.Ctx = &Ctx;
+    Ctx.Frames = p.Frames;
+    Ctx.Bodies = p.Bodies;
+    Ctx.Atmosphere = p.Atmosphere;
+    Ctx.TideInterval = p.TideInterval;
+
+    if (p.Integrator == INT_RKF78) {
+        // Step size control; the output points are interpolated
+        RKF78 Orbit(Deriv,6,&p,true);
+
+        Orbit.Init(t, Y0, Step, p.relerr, p.abserr);
+        for (i = 0; i <= N_Step; i++) {
+            Orbit.Integ(Step*i, Y);
+            Eph[i] = Y;
+        }
+        return Orbit.nfev;
+    }
+
+    if (p.Integrator == INT_GJ8) {
+        // One evaluation per step after the start-up
+        GJ8 Orbit(Deriv,6,&p);
+
+        Orbit.max_iter = p.CorrIter;
+        Orbit.Init(t, Y0, Step, p.relerr, p.abserr);
+        Eph[0] = Y0;
+        for (i = 1; i <= N_Step; i++) {
+            Orbit.Step(Y);
+            Eph[i] = Y;
+        }
+        return Orbit.nfev;
+    }
+
+    if (p.Integrator == INT_DE) {
+        // Steps independent of the output points (integration past each
+        // output point and interpolation)
+        DE Orbit(Deriv,6,&p);
+
+        Orbit.Init(t, p.relerr, p.abserr);
+        Y = Y0;
+        Eph[0] = Y0;
+        for (i = 1; i <= N_Step; i++) {
+            Orbit.Integ(Step*i, Y);
+            Eph[i] = Y;
+        }
+        return Orbit.nfev;
+    }
+
+    RK4       Orbit(Deriv,6,&p);
+
     Y = Y0;
     for (i = 0; i <= N_Step; i++) {
         Eph[i] = Y;
         Orbit.Step(t, Y, Step);
     }
+    return 4L*(N_Step+1);
+}
+
+//------------------------------------------------------------------------------
+//
+// LoadGravityModel
+//
+// Purpose:
+//
+//   Loads the GGM03C coefficients up to the degree needed by the run into
+//   ggm. The binary model file (hpop_convert ggm) is mapped into memory;
+//   the text file is only parsed if no binary file is available.
+//
+// Input/Output:
+//
+//   exeDir    Directory of the executable; the model files are expected
+//             in the parent directory
+//   n         Maximum degree required
+//   <return>  false if no model file could be read
+//
+//------------------------------------------------------------------------------
+static bool LoadGravityModel(const string& exeDir, int n)
+{
+    if (n < 0 || n > N_ggm) {
+        cerr << "Error: Degree " << n << " of the gravity field is outside "
+             << "0.." << N_ggm << endl;
+        return false;
+    }
+
+    string binPath = exeDir + "/../GGM03C.bin";
+    string ggmPath = exeDir + "/../GGM03C.txt";
+
+    if (ReadGravityBinary(binPath, n, ggm))
+        return true;
+    if (ReadGravityText(ggmPath, n, GM_ref, R_ref, ggm))
+        return true;
+
+    cerr << "Error: Could not read GGM03C.bin or GGM03C.txt at "
+         << exeDir << "/.." << endl;
+    return false;
+}
+
+//------------------------------------------------------------------------------
+//
+// LoadEarthData
+//
+// Purpose:
+//
+//   Loads the EOP and space weather tables into eoptab and spwtab. Binary
+//   tables (hpop_convert eop/spw) are mapped into memory; the CSSI text
+//   files are only parsed if no binary file is available.
+//
+// Input/Output:
+//
+//   exeDir    Directory of the executable; the data files are expected in
+//             the parent directory
+//   <return>  false if a table could not be read
+//
+//------------------------------------------------------------------------------
+static bool LoadEarthData(const string& exeDir)
+{
+    string eopBase = exeDir + "/../EOP-All_2025";
+    string spwBase = exeDir + "/../sw_2025";
+
+    if (!readeopbin((eopBase + ".bin").c_str(), eoptab) &&
+        !initeop((eopBase + ".txt").c_str(), eoptab)) {
+        cerr << "Error: Could not read EOP data at " << eopBase << ".bin/.txt" << endl;
+        return false;
+    }
+    if (!readspwbin((spwBase + ".bin").c_str(), spwtab) &&
+        !initspw((spwBase + ".txt").c_str(), spwtab)) {
+        cerr << "Error: Could not read space weather data at " << spwBase << ".bin/.txt" << endl;
+        return false;
+    }
+    return true;
 }
 
 //------------------------------------------------------------------------------
@@ -220,8 +366,109 @@ int main(int argc, char* argv[]) {
     exeDir = exeDir.substr(0, exeDir.find_last_of("\\/"));
 #endif
 
+    // Options of the form --key=value may appear anywhere on the command
+    // line; they are removed from argv before the positional arguments
+    // are evaluated
+    int n_threads = 0;                 // Worker threads (0: number of cores)
+    double frame_step = 0.25;          // Frame cache node spacing [d] (0: off)
+    double body_seg   = 2.0;           // Sun/Moon cache segment length [d] (0: off)
+    double tide_dt    = 0.0;           // Reuse of tidal corrections [s]
+    DENSITY_MODEL density = DENS_NRL;  // Atmospheric density model
+    bool   set_density = false;        // Model given on the command line
+    INTEGRATOR integrator = INT_RK4;   // Integration method of Ephemeris
+    double relerr     = 0.0;           // Accuracy requirements of the adaptive
+    double abserr     = 0.0;           // and GJ8 integrators (0: default)
+    int    corr_iter  = 0;             // GJ8 corrector re-evaluations (0: PEC)
+    bool   set_integrator = false;     // Integrator options on the command line
+    double dop_step   = 0.0;           // DOP epoch spacing [s] (0: step size)
+    string sites_file;                 // Ground sites of the access report
+    double el_mask    = 0.0;           // Elevation mask of the access [deg]
+    int n_arg = 1;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            argv[n_arg++] = argv[i];
+        }
+        else if (arg.compare(0, 10, "--threads=") == 0) {
+            n_threads = atoi(arg.c_str() + 10);
+        }
+        else if (arg.compare(0, 13, "--frame-step=") == 0) {
+            frame_step = atof(arg.c_str() + 13);
+        }
+        else if (arg.compare(0, 15, "--body-segment=") == 0) {
+            body_seg = atof(arg.c_str() + 15);
+        }
+        else if (arg.compare(0, 16, "--tide-interval=") == 0) {
+            tide_dt = atof(arg.c_str() + 16);
+        }
+        else if (arg.compare(0, 10, "--density=") == 0) {
+            if (!ParseDensityModel(arg.substr(10), density)) {
+                std::cerr << "Error: Unknown density model " << arg.substr(10) << std::endl;
+                return 1;
+            }
+            set_density = true;
+        }
+        else if (arg.compare(0, 13, "--integrator=") == 0) {
+            string name = arg.substr(13);
+            if      (name == "rk4")   integrator = INT_RK4;
+            else if (name == "rkf78") integrator = INT_RKF78;
+            else if (name == "gj8")   integrator = INT_GJ8;
+            else if (name == "de")    integrator = INT_DE;
+            else {
+                std::cerr << "Error: Unknown integrator " << name << std::endl;
+                return 1;
+            }
+            set_integrator = true;
+        }
+        else if (arg.compare(0, 9, "--relerr=") == 0) {
+            relerr = atof(arg.c_str() + 9);
+            set_integrator = true;
+        }
+        else if (arg.compare(0, 9, "--abserr=") == 0) {
+            abserr = atof(arg.c_str() + 9);
+            set_integrator = true;
+        }
+        else if (arg.compare(0, 12, "--corrector=") == 0) {
+            corr_iter = atoi(arg.c_str() + 12);
+            set_integrator = true;
+        }
+        else if (arg.compare(0, 11, "--dop-step=") == 0) {
+            dop_step = atof(arg.c_str() + 11);
+            if (dop_step < 1.0 || dop_step != floor(dop_step)) {
+                std::cerr << "Error: --dop-step must be a whole number of seconds"
+                          << std::endl;
+                return 1;
+            }
+        }
+        else if (arg.compare(0, 8, "--sites=") == 0) {
+            sites_file = arg.substr(8);
+        }
+        else if (arg.compare(0, 10, "--el-mask=") == 0) {
+            el_mask = atof(arg.c_str() + 10);
+        }
+        else {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+    argc = n_arg;
+
+    // Default tolerances: RKF78 at about 1 cm over 6 h in LEO with 35% fewer
+    // evaluations than RK4 (which is off by several m); GJ8 and DE at the
+    // mm level
+    if (relerr <= 0.0) relerr = (integrator == INT_RKF78) ? 1.0e-11 : 1.0e-13;
+    if (abserr <= 0.0) abserr = (integrator == INT_RKF78) ? 1.0e-4  : 1.0e-6;
+
     if (argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " <function> (e.g., orbit_cal or dop_cal)" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <function> (e.g., orbit_cal or dop_cal)"
+                  << " [--threads=N] [--frame-step=days]"
+                  << " [--body-segment=days] [--tide-interval=s]"
+                  << " [--density=none|nrl|table|hp|exp]"
+                  << " [--dop-step=s] [--sites=file] [--el-mask=deg]"
+                  << " (scene_edit)"
+                  << " [--integrator=rk4|rkf78|gj8|de] [--relerr=r] [--abserr=a]"
+                  << " [--corrector=n] (Perturbation_force; scene_edit uses"
+                  << " batched RK4)" << std::endl;
         return 1;
     }
 
@@ -232,36 +479,11 @@ int main(int argc, char* argv[]) {
     Vector    Kep(6);
     AuxParam  Aux;
 
-    // Input files - relative to executable
-    string ggmPath = exeDir + "/../GGM03C.txt";
-    ifstream inp(ggmPath.c_str());
-    if (!inp.is_open()) {
-        cerr << "Error: Could not open GGM03C.txt at " << ggmPath << endl;
-        return 1;
-    }
-
-    int z=0, n=360;
-    double temp;
     int Year, Month, Day, Hour, Min;
     double Sec;
 
-    do {
-        for(int x=0;x<=z;x++) {
-            inp >> temp;
-            inp >> temp;
-            inp >> temp;
-            cnm(z,x) = temp;
-            inp >> temp;
-            snm(z,x) = temp;
-            inp >> temp;
-            inp >> temp;
-        }  
-        z++;
-    } while(z<=n);
-    inp.close();
-
-    initeop(eoparr,jdeopstart);
-    initspw(spwarr,jdspwstart);
+    if (!LoadEarthData(exeDir))
+        return 1;
 
     string moduel_name = argv[1];
     if (moduel_name == "scene_edit"){
@@ -271,7 +493,6 @@ int main(int argc, char* argv[]) {
         // start = clock();
 
         // Variables        
-        Aux.Mjd_UTC = Mjd_UTC;
         Aux.Area_drag  = 55.64;
         Aux.Area_solar = 88.4;
         Aux.mass       = 8000.0;
@@ -282,10 +503,21 @@ int main(int argc, char* argv[]) {
         Aux.Sun        = false;
         Aux.Moon       = false;
         Aux.SRad       = false;
-        Aux.Drag       = false;
+        Aux.DragModel  = set_density ? density : DENS_NONE;  // Off by default
         Aux.SolidEarthTides = false;
         Aux.OceanTides = false;
         Aux.Relativity = false;
+        Aux.Ctx        = 0;          // Set up per job by Ephemeris
+        Aux.Frames     = 0;
+        Aux.Bodies     = 0;
+        Aux.Atmosphere = 0;
+        Aux.Gravity    = 0;
+        Aux.TideInterval = tide_dt;
+
+        // The constellation is propagated by BatchRK4 with the output step
+        if (set_integrator)
+            std::cerr << "Warning: --integrator, --relerr, --abserr and --corrector"
+                      << " apply to Perturbation_force only; ignored" << std::endl;
 
         double Step = 60.0;
         // const int N_Step = 2*60*24;
@@ -347,14 +579,114 @@ int main(int argc, char* argv[]) {
         double init_Sec = Sec;
         // fscanf(f1,"%d %d %d %d:%d:%lf\n", &Day, &Month, &Year, &Hour, &Min, &Sec);
         Mjd_UTC = Mjd(Year, Month, Day, Hour, Min, Sec);
+        Aux.Mjd_UTC = Mjd_UTC;
         ostringstream epoch_block;
         epoch_block << " \"epoch\": \"" << Year << "-" << setfill('0') << setw(2) << Month
                     << "-" << setw(2) << Day << " " << setw(2) << Hour << ":"
                     << setw(2) << Min << ":" << fixed << setprecision(0) << Sec << "Z\",\n";
 
         char satelliteIdBuffer[100];
-        string satelliteId;
-        Vector Eph [N_Step+1];
+        vector<string> satelliteIds;
+        vector<Vector> Y0s;
+
+        while (fscanf(f1, "%99s", satelliteIdBuffer) == 1) {
+            Vector Y0(6);
+            for(int j=0;j<6;j++) {
+                fscanf(f1,"%lf\n", &Y0(j));
+            }
+            satelliteIds.push_back(satelliteIdBuffer);
+            Y0s.push_back(Y0 * 1000);
+        }
+        fclose(f1);
+
+        int num_sats = (int)satelliteIds.size();
+
+        // Propagation of all satellites. The constellation is split into
+        // batches, which are propagated by BatchRK4 on the thread pool; every
+        // batch owns its PropagationContext and writes to its own slices of
+        // Eph and to its own Earth-fixed tracks.
+        vector<Vector> Eph (num_sats*(N_Step+1));
+        vector<EphemerisTrack> Tracks(num_sats, EphemerisTrack(Mjd_UTC));
+
+        // Gravity model up to the degree of this run
+        if (!LoadGravityModel(exeDir, Aux.n))
+            return 1;
+
+        BatchForceModel Model;
+        Model.Mjd_UTC    = Aux.Mjd_UTC;
+        Model.GM         = GM_ref;
+        Model.R_ref      = R_ref;
+        Model.Field      = &ggm;
+        Model.n          = Aux.n;
+        Model.m          = Aux.m;
+        Model.Area_drag  = Aux.Area_drag;
+        Model.Area_solar = Aux.Area_solar;
+        Model.mass       = Aux.mass;
+        Model.CR         = Aux.CR;
+        Model.CD         = Aux.CD;
+        Model.Sun        = Aux.Sun;
+        Model.Moon       = Aux.Moon;
+        Model.SRad       = Aux.SRad;
+        Model.Drag       = (Aux.DragModel != DENS_NONE);
+        Model.SolidEarthTides = Aux.SolidEarthTides;
+        Model.OceanTides = Aux.OceanTides;
+        Model.Relativity = Aux.Relativity;
+
+        HarmonicGravity Gravity(ggm.Truncate(Aux.n, min(Aux.m, Aux.n)));
+        Model.Gravity    = &Gravity;
+        Model.TideInterval = Aux.TideInterval;
+
+        // Precession-nutation table shared by all batches (the margin
+        // covers the TT-UTC offset)
+        std::unique_ptr<FrameCache> Frames;
+        if (frame_step > 0.0)
+            Frames.reset(new FrameCache(Mjd_UTC, Mjd_UTC+(Step*N_Step)/86400.0+1.0,
+                                        frame_step));
+        Model.Frames     = Frames.get();
+
+        std::unique_ptr<SunMoonCache> Bodies;
+        if (body_seg > 0.0)
+            Bodies.reset(new SunMoonCache(Mjd_UTC, Mjd_UTC+(Step*N_Step)/86400.0+1.0,
+                                          body_seg));
+        Model.Bodies     = Bodies.get();
+
+        std::unique_ptr<DensityModel> Atmosphere(
+            NewDensityModel(Aux.DragModel, Mjd_UTC, Mjd_UTC+(Step*N_Step)/86400.0));
+        Model.Atmosphere = Atmosphere.get();
+
+        WorkStealingPool pool(n_threads);
+
+        // At least one batch per worker, so that small constellations are
+        // spread over all threads; large ones are split into batches of
+        // about Batch_Size satellites, up to four per worker
+        const int Batch_Size = 64;     // Satellites per batch of large runs
+        int n_batch = max(pool.Size(), (num_sats+Batch_Size-1)/Batch_Size);
+        n_batch = min(n_batch, min(4*pool.Size(), num_sats));
+        if (n_batch < 1) n_batch = 1;
+
+        ParallelFor(pool, n_batch, [&](int b) {
+            int    k_0 = ( b   *num_sats)/n_batch;
+            int    k_1 = ((b+1)*num_sats)/n_batch;
+            double t   = 0.0;
+            BatchRK4 Orbit(Model, k_1-k_0);
+            PropagationContext Ctx;
+            Ctx.Frames = Model.Frames;
+            Ctx.Bodies = Model.Bodies;
+
+            for (int k = k_0; k < k_1; k++) Orbit.SetState(k-k_0, Vec6(Y0s[k]));
+            for (int i = 0; i <= N_Step; i++) {
+                for (int k = k_0; k < k_1; k++)
+                    Eph[k*(N_Step+1)+i] = Vector(Orbit.State(k-k_0));
+                if (i < N_Step) Orbit.Step(t, Step);
+            }
+            for (int k = k_0; k < k_1; k++) {
+                Tracks[k].Reserve(N_Step+1);
+                for (int i = 0; i <= N_Step; i++) {
+                    Tracks[k].Append(Step*i, ECI2ECEF(Ctx, (Mjd_UTC+(Step*i)/86400.0),
+                                                      Vec6(Eph[k*(N_Step+1)+i])));
+                }
+            }
+        });
 
         // Output JSON file
         string jsonPath = exeDir + "/" + type + "All_J2000_Ephemeris.json";
@@ -367,18 +699,19 @@ int main(int argc, char* argv[]) {
         jsonOut << "{\n";
         bool firstSat = true;
 
-        int num_sats = 0;
-        while (fscanf(f1, "%99s", satelliteIdBuffer) == 1) {
-            num_sats = num_sats + 1;
-            satelliteId = satelliteIdBuffer;
-        
-            Vector Y0(6),Y(6);
-            for(int j=0;j<6;j++) {
-                fscanf(f1,"%lf\n", &Y0(j));
-            }
-            
-            Y0 = Y0 * 1000;
-            Ephemeris(Y0, N_Step, Step, Aux, Eph);
+        // Create output subdirectory
+        string ecefDir = exeDir + "/" + type + "_ecef";
+    #ifdef _WIN32
+        CreateDirectoryA(ecefDir.c_str(), NULL);
+    #else
+        mkdir(ecefDir.c_str(), 0777);
+    #endif
+
+        // Results in the order of the initial state file
+        for (int k = 0; k < num_sats; k++) {
+            const string& satelliteId = satelliteIds[k];
+            const Vector* Eph_k  = &Eph [k*(N_Step+1)];
+            const EphemerisTrack& Track_k = Tracks[k];
 
             if (!firstSat) jsonOut << ",\n";
             firstSat = false;
@@ -388,7 +721,7 @@ int main(int argc, char* argv[]) {
             jsonOut << "    \"cartesian\": [\n";
 
             for (int i = 0; i <= N_Step; i += 1) {
-                Vector Y = Eph[i];
+                const Vector& Y = Eph_k[i];
                 int t_sec = i * Step;
                 jsonOut << "      [" << t_sec << ", " << fixed << setprecision(8)
                         << Y(0) << ", " << Y(1) << ", " << Y(2) << ", " << Y(3) << ", " << Y(4) << ", " << Y(5) << "]";
@@ -396,14 +729,6 @@ int main(int argc, char* argv[]) {
                 jsonOut << "\n";
             }
             jsonOut << "    ]\n  }";
-            
-            // Create output subdirectory
-            string ecefDir = exeDir + "/" + type + "_ecef";
-    #ifdef _WIN32
-            CreateDirectoryA(ecefDir.c_str(), NULL);
-    #else
-            mkdir(ecefDir.c_str(), 0777);
-    #endif
 
             // Output ECEF file
             string ecefFilePath = ecefDir + "/" + satelliteId + "_ECEF.txt";
@@ -414,13 +739,12 @@ int main(int argc, char* argv[]) {
             }
         
             for (int i = 0; i <= N_Step; i += 1) {
-                Vector Y = Eph[i];
                 CalDat((Mjd_UTC + (Step * i) / 86400.0), Year, Month, Day, Hour, Min, Sec);
         
                 fprintf(f3,"%4d-%02d-%02d ",Year,Month,Day);
                 fprintf(f3,"%02d:%02d:%06.3f\t",Hour,Min,Sec);
                 
-                Y = ECI2ECEF((Mjd_UTC+(Step*i)/86400.0), Y);
+                const Vec6& Y = Track_k.Node(i);
                 for(int j = 0; j < 3; j++) {
                     fprintf(f3,"%20.6f\t",Y(j));
                 }
@@ -431,25 +755,59 @@ int main(int argc, char* argv[]) {
             }
             fclose(f3);
         }
-        fclose(f1);
         jsonOut << "\n}\n";
         jsonOut.close();
 
         printf("\n  All J2000 ephemerides saved as JSON.\n");
+
+        // Access intervals of the ground sites (rise and set times refined
+        // on the interpolated Earth-fixed tracks)
+        if (!sites_file.empty()) {
+            vector<AccessSite> Sites;
+            if (!ReadAccessSites(sites_file, Sites)) {
+                cerr << "Error: Could not read sites from " << sites_file << endl;
+                return 1;
+            }
+
+            vector<vector<AccessInterval>> Access;
+            ComputeAccess(pool, Sites, Tracks, el_mask*Rad, Step, Access);
+
+            string accessPath = exeDir + "/" + type + "_access_report.txt";
+            ofstream accessOut(accessPath.c_str());
+            if (!accessOut.is_open()) {
+                cerr << "Error: Could not create access report at " << accessPath << endl;
+                return 1;
+            }
+            WriteAccessReport(accessOut, Sites, satelliteIds, Access, Mjd_UTC, el_mask*Rad);
+            printf("  Access report of %d sites saved as %s\n", (int)Sites.size(),
+                   accessPath.c_str());
+        }
         // end = clock();
         // printf("\n     elapsed time: %f seconds\n", (end - start) / CLK_TCK);
 
-        // DOP calculation
-        string ecefDir = exeDir + "/" + type + "_ecef";
-        auto sat_positions = LoadAllSatellites(num_sats, N_Step, ecefDir + "/");
+        // DOP calculation at the epochs 0, dop_step, ... interpolated from
+        // the Earth-fixed tracks; the window covers the first NUM_Step output
+        // steps (0-540 s) at any DOP spacing, limited to the end of the tracks
+        const int NUM_Step = 10;
+
+        if (dop_step <= 0.0) dop_step = Step;
+        double t_dop = min((NUM_Step-1)*Step, N_Step*Step);
+        int n_dop = (int)floor(t_dop/dop_step + 1.0e-9) + 1;
+
+        vector<vector<Vector3d>> sat_positions(num_sats);
+        for (int k = 0; k < num_sats; k++) {
+            sat_positions[k].reserve(n_dop);
+            for (int i = 0; i < n_dop; i++) {
+                Vec3 r = Tracks[k].Position(dop_step*i);
+                sat_positions[k].emplace_back(r(0), r(1), r(2));
+            }
+        }
 
         double lat_start = -90.0, lat_end = 90.0, lat_step = 1.0;
         double lon_start = -180.0, lon_end = 180.0, lon_step = 1.0;
         double alt_km = 0.0;
 
-        const int NUM_Step = 10;
-
-        ComputeGridPDOP(sat_positions, NUM_Step, Step,
+        ComputeGridPDOP(pool, sat_positions, n_dop, dop_step,
             lat_start, lat_end, lat_step,
             lon_start, lon_end, lon_step,
             init_Year, init_Month, init_Day, init_Hour, init_Min, init_Sec,
@@ -503,10 +861,20 @@ int main(int argc, char* argv[]) {
         Aux.Sun        = false;
         Aux.Moon       = false;
         Aux.SRad       = true;
-        Aux.Drag       = true;
+        Aux.DragModel  = density;
         Aux.SolidEarthTides = false;
         Aux.OceanTides = false;
         Aux.Relativity = false;
+        Aux.Ctx        = 0;          // Set up per job by Ephemeris
+        Aux.Frames     = 0;
+        Aux.Bodies     = 0;
+        Aux.Atmosphere = 0;
+        Aux.Gravity    = 0;
+        Aux.TideInterval = tide_dt;
+        Aux.Integrator = integrator;
+        Aux.relerr     = relerr;
+        Aux.abserr     = abserr;
+        Aux.CorrIter   = corr_iter;
 
         // ===== 5. 可进行摄动力判断/轨道外推后续逻辑 =====
         double Step = 30.0;
@@ -518,6 +886,28 @@ int main(int argc, char* argv[]) {
                     << setw(2) << Min << ":" << fixed << setprecision(0) << Sec << "Z\",\n";
         Vector Eph [N_Step+1];
 
+        std::unique_ptr<FrameCache> Frames;
+        if (frame_step > 0.0)
+            Frames.reset(new FrameCache(Mjd_UTC, Mjd_UTC+(Step*N_Step)/86400.0+1.0,
+                                        frame_step));
+        Aux.Frames = Frames.get();
+
+        std::unique_ptr<SunMoonCache> Bodies;
+        if (body_seg > 0.0)
+            Bodies.reset(new SunMoonCache(Mjd_UTC, Mjd_UTC+(Step*N_Step)/86400.0+1.0,
+                                          body_seg));
+        Aux.Bodies = Bodies.get();
+
+        std::unique_ptr<DensityModel> Atmosphere(
+            NewDensityModel(Aux.DragModel, Mjd_UTC, Mjd_UTC+(Step*N_Step)/86400.0));
+        Aux.Atmosphere = Atmosphere.get();
+
+        // Gravity model up to the degree of this run
+        if (!LoadGravityModel(exeDir, Aux.n))
+            return 1;
+        HarmonicGravity Gravity(ggm.Truncate(Aux.n, min(Aux.m, Aux.n)));
+        Aux.Gravity = &Gravity;
+
         // cout<<"\n      parameter contained     \n"<<endl;
 
         // Output JSON file
@@ -531,7 +921,7 @@ int main(int argc, char* argv[]) {
         jsonOut << "{\n";
         bool firstSat = true;
 
-        Ephemeris(Y0, N_Step, Step, Aux, Eph);
+        long n_eval = Ephemeris(Y0, N_Step, Step, Aux, Eph);
 
         if (!firstSat) jsonOut << ",\n";
         firstSat = false;
@@ -552,7 +942,33 @@ int main(int argc, char* argv[]) {
         jsonOut.close();
 
         printf("\n  All J2000 ephemerides saved as JSON.\n");
-    }   
+        printf("  Derivative evaluations: %ld (%.2f per output step)\n",
+               n_eval, double(n_eval)/N_Step);
+    }
+
+    else if (moduel_name == "density_check") {
+        if (argc < 5) {
+            cerr << "Usage: " << argv[0]
+                 << " density_check YYYY MM DD [days] [--density=nrl|table|hp|exp]"
+                 << endl;
+            return 1;
+        }
+
+        // Comparison of the selected density model with NRLMSISE-00 at
+        // random positions between 150 and 1000 km
+        Mjd_UTC = Mjd(atoi(argv[2]), atoi(argv[3]), atoi(argv[4]));
+        double Days = (argc > 5) ? atof(argv[5]) : 1.0;
+
+        std::unique_ptr<DensityModel> Atmosphere(
+            NewDensityModel(density, Mjd_UTC, Mjd_UTC+Days));
+        if (!Atmosphere) {
+            cerr << "Error: No density model selected" << endl;
+            return 1;
+        }
+
+        cout << "  Density model vs. NRLMSISE-00" << endl;
+        CheckDensityModel(*Atmosphere, Mjd_UTC, Days, 25, 2000, cout);
+    }
     printf("\n     press any key \n");
     return 0;
 }
\ No newline at end of file
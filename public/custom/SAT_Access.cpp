@@ -0,0 +1,322 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Access.cpp
+//
+// Purpose:
+//
+//   Visibility intervals (access) of satellites from ground sites
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "SAT_Access.h"
+#include "SAT_Const.h"
+#include "SAT_Parallel.h"
+#include "SAT_RefSys.h"
+#include "SAT_Time.h"
+
+using std::vector;
+using std::string;
+
+namespace {
+
+const double t_tol = 1.0e-3;    // Tolerance of the crossing times [s]
+
+
+// Elevation function of a site/satellite pair: sine of the elevation minus
+// the sine of the mask, and its time derivative
+
+struct Elevation
+{
+  const EphemerisTrack* Track;
+  Vec3   r_site, up;            // Site position and geodetic zenith
+  double s_mask;
+
+  double operator() (double t) const
+  {
+    Vec3 d = Track->Position(t) - r_site;
+    return Dot(d,up)/Norm(d) - s_mask;
+  }
+
+  void Eval (double t, double& f, double& df) const
+  {
+    Vec6   Y   = Track->State(t);
+    Vec3   d   = Y.Pos() - r_site, v = Y.Vel();
+    double rho = Norm(d), du = Dot(d,up);
+    f  = du/rho - s_mask;
+    df = Dot(v,up)/rho - du*Dot(d,v)/(rho*rho*rho);
+  }
+
+  double Rate (double t) const
+  {
+    double f, df;
+    Eval(t, f, df);
+    return df;
+  }
+};
+
+
+// Brent's method for a zero of f in [a,b] with f(a)*f(b)<=0
+
+template <class F>
+double Zero (const F& f, double a, double b, double fa, double fb)
+{
+  const double eps = 1.0e-15;
+  double c = b, fc = fb, d = b-a, e = d;
+
+  for (int it=0; it<100; it++) {
+    if ( (fb>0.0 && fc>0.0) || (fb<0.0 && fc<0.0) ) {
+      c = a; fc = fa; e = d = b-a;
+    }
+    if (fabs(fc)<fabs(fb)) {
+      a = b; b = c; c = a;
+      fa = fb; fb = fc; fc = fa;
+    }
+    double tol = 2.0*eps*fabs(b) + 0.5*t_tol;
+    double xm  = 0.5*(c-b);
+    if (fabs(xm)<=tol || fb==0.0) return b;
+
+    if (fabs(e)>=tol && fabs(fa)>fabs(fb)) {
+      // Inverse quadratic interpolation or secant step
+      double s = fb/fa, p, q, r;
+      if (a==c) {
+        p = 2.0*xm*s;
+        q = 1.0-s;
+      }
+      else {
+        q = fa/fc; r = fb/fc;
+        p = s*(2.0*xm*q*(q-r)-(b-a)*(r-1.0));
+        q = (q-1.0)*(r-1.0)*(s-1.0);
+      }
+      if (p>0.0) q = -q;
+      p = fabs(p);
+      if (2.0*p < std::min(3.0*xm*q-fabs(tol*q), fabs(e*q))) {
+        e = d; d = p/q;
+      }
+      else {
+        d = xm; e = d;
+      }
+    }
+    else {
+      d = xm; e = d;                       // Bisection
+    }
+    a = b; fa = fb;
+    b += (fabs(d)>tol) ? d : (xm>0.0 ? tol : -tol);
+    fb = f(b);
+  }
+  return b;
+}
+
+
+// Access intervals of a single site/satellite pair
+
+void PairAccess (const Elevation& El, int Sat, double dt_scan,
+                 vector<AccessInterval>& Access)
+{
+  const EphemerisTrack& Track = *El.Track;
+  double t_0 = Track.Begin(), t_1 = Track.End();
+  int    n   = std::max(1, (int)ceil((t_1-t_0)/dt_scan-1.0e-9));
+  auto   Rate = [&El](double t) { return El.Rate(t); };
+
+  double ta = t_0, fa, ra;
+  El.Eval(ta, fa, ra);
+
+  bool   visible = (fa>=0.0);
+  double t_AOS   = t_0;
+
+  for (int k=1; k<=n; k++) {
+    double tb = (k==n) ? t_1 : t_0+k*dt_scan;
+    double fb, rb;
+    El.Eval(tb, fb, rb);
+
+    if (!visible && fb<0.0 && ra>0.0 && rb<0.0) {
+      // Maximum inside the step; short pass if above the mask
+      double tm = Zero(Rate, ta, tb, ra, rb), fm = El(tm);
+      if (fm>=0.0) {
+        AccessInterval I = { Sat, Zero(El, ta, tm, fa, fm),
+                                  Zero(El, tm, tb, fm, fb) };
+        Access.push_back(I);
+      }
+    }
+    else if (visible && fb>=0.0 && ra<0.0 && rb>0.0) {
+      // Minimum inside the step; short gap if below the mask
+      double tm = Zero(Rate, ta, tb, ra, rb), fm = El(tm);
+      if (fm<0.0) {
+        AccessInterval I = { Sat, t_AOS, Zero(El, ta, tm, fa, fm) };
+        Access.push_back(I);
+        t_AOS = Zero(El, tm, tb, fm, fb);
+      }
+    }
+    else if (!visible && fb>=0.0) {
+      t_AOS   = Zero(El, ta, tb, fa, fb);
+      visible = true;
+    }
+    else if (visible && fb<0.0) {
+      AccessInterval I = { Sat, t_AOS, Zero(El, ta, tb, fa, fb) };
+      Access.push_back(I);
+      visible = false;
+    }
+
+    ta = tb; fa = fb; ra = rb;
+  }
+
+  if (visible) {
+    AccessInterval I = { Sat, t_AOS, t_1 };
+    Access.push_back(I);
+  }
+}
+
+
+// UTC date and time with millisecond resolution
+
+string TimeString (double Mjd_UTC_0, double t)
+{
+  double    Day_0 = floor(Mjd_UTC_0);
+  long long ms    = llround(((Mjd_UTC_0-Day_0)*86400.0+t)*1000.0);
+  long long n_day = ms/86400000;
+  int       Year, Month, Day, Hour, Min;
+  double    Sec;
+  char      buf[40];
+
+  if (ms<0) n_day--;
+  ms -= n_day*86400000;
+  CalDat(Day_0+n_day, Year, Month, Day, Hour, Min, Sec);
+  snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+           Year, Month, Day, int(ms/3600000), int(ms/60000%60),
+           int(ms/1000%60), int(ms%1000));
+  return string(buf);
+}
+
+}
+
+//------------------------------------------------------------------------------
+//
+// ReadAccessSites
+//
+//------------------------------------------------------------------------------
+bool ReadAccessSites (const string& path, vector<AccessSite>& Sites)
+{
+  std::ifstream in(path.c_str());
+  string        line;
+
+  if (!in.is_open()) return false;
+
+  Sites.clear();
+  while (std::getline(in, line)) {
+    std::istringstream is(line);
+    AccessSite S;
+    double     lat, lon;
+    if (!(is >> S.Name) || S.Name[0]=='#') continue;
+    if (!(is >> lat >> lon)) {
+      std::cerr << "ERROR: Invalid site " << S.Name << " in " << path
+                << std::endl;
+      return false;
+    }
+    if (!(is >> S.h)) S.h = 0.0;
+    S.lat = lat*Rad;
+    S.lon = lon*Rad;
+    Sites.push_back(S);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+//
+// ComputeAccess
+//
+//------------------------------------------------------------------------------
+void ComputeAccess (WorkStealingPool& Pool, const vector<AccessSite>& Sites,
+                    const vector<EphemerisTrack>& Tracks, double El_mask,
+                    double dt_scan, vector<vector<AccessInterval> >& Access)
+{
+  int n_site = (int)Sites.size();
+  int n_sat  = (int)Tracks.size();
+
+  if (dt_scan<=0.0) {
+    std::cerr << "ERROR: Invalid scan step in ComputeAccess" << std::endl;
+    exit(1);
+  }
+
+  // One task per site/satellite pair
+  vector<vector<AccessInterval> > Pairs(n_site*n_sat);
+
+  ParallelFor(Pool, n_site*n_sat, [&](int i) {
+    const AccessSite& S = Sites[i/n_sat];
+    int               k = i%n_sat;
+    Elevation         El;
+
+    if (Tracks[k].Size()<2) return;
+    El.Track  = &Tracks[k];
+    El.r_site = Vec3(Geodetic(S.lon, S.lat, S.h).Position());
+    El.up     = Vec3(cos(S.lat)*cos(S.lon), cos(S.lat)*sin(S.lon), sin(S.lat));
+    El.s_mask = sin(El_mask);
+    PairAccess(El, k, dt_scan, Pairs[i]);
+  });
+
+  // Merge in the order of the satellites
+  Access.assign(n_site, vector<AccessInterval>());
+  for (int j=0; j<n_site; j++)
+    for (int k=0; k<n_sat; k++) {
+      const vector<AccessInterval>& P = Pairs[j*n_sat+k];
+      Access[j].insert(Access[j].end(), P.begin(), P.end());
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+// WriteAccessReport
+//
+//------------------------------------------------------------------------------
+void WriteAccessReport (std::ostream& out, const vector<AccessSite>& Sites,
+                        const vector<string>& SatIds,
+                        const vector<vector<AccessInterval> >& Access,
+                        double Mjd_UTC_0, double El_mask)
+{
+  char buf[160];
+
+  snprintf(buf, sizeof(buf), "Access report (elevation mask %.3f deg)\n",
+           El_mask*Deg);
+  out << buf;
+
+  for (size_t j=0; j<Sites.size(); j++) {
+    const AccessSite& S = Sites[j];
+    const vector<AccessInterval>& A = Access[j];
+
+    snprintf(buf, sizeof(buf),
+             "\nSite %s  lat %9.4f deg  lon %9.4f deg  h %8.1f m\n",
+             S.Name.c_str(), S.lat*Deg, S.lon*Deg, S.h);
+    out << buf;
+    if (A.empty()) {
+      out << "  No access intervals.\n";
+      continue;
+    }
+
+    double Total = 0.0;
+    int    n     = 0;
+    for (size_t i=0; i<A.size(); i++) {
+      if (i==0 || A[i].Sat!=A[i-1].Sat) {
+        out << "\n  " << SatIds[A[i].Sat] << "\n"
+            << "    Access  Start Time (UTCG)         "
+            << "Stop Time (UTCG)          Duration (s)\n";
+        n = 0;
+      }
+      double Dur = A[i].t_LOS - A[i].t_AOS;
+      snprintf(buf, sizeof(buf), "    %6d  %s  %s  %12.3f\n", ++n,
+               TimeString(Mjd_UTC_0, A[i].t_AOS).c_str(),
+               TimeString(Mjd_UTC_0, A[i].t_LOS).c_str(), Dur);
+      out << buf;
+      Total += Dur;
+    }
+    snprintf(buf, sizeof(buf), "\n  %d intervals, total duration %.3f s\n",
+             (int)A.size(), Total);
+    out << buf;
+  }
+}
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Access.h
+//
+// Purpose:
+//
+//   Visibility intervals (access) of satellites from ground sites
+//
+// Notes:
+//
+//   The sine of the elevation above the geodetic horizon is scanned at
+//   a coarse step along the interpolated Earth-fixed ephemeris of each
+//   satellite. Sign changes relative to the elevation mask bracket the
+//   rise (AOS) and set (LOS) times, which are refined by Brent's method to
+//   a millisecond. A maximum of the elevation within a scan step is located
+//   from the sign change of its derivative, so that passes shorter than
+//   the scan step are found as long as they contain no more than one
+//   elevation maximum per step. Intervals that are open at the start or
+//   end of the ephemeris are cut there.
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifndef INC_SAT_ACCESS_H
+#define INC_SAT_ACCESS_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "SAT_Ephem.h"
+
+class WorkStealingPool;
+
+
+// Ground site and visibility interval
+
+struct AccessSite {
+  std::string Name;
+  double      lon, lat, h;     // Geodetic coordinates [rad, rad, m]
+};
+
+struct AccessInterval {
+  int         Sat;             // Index of the satellite
+  double      t_AOS, t_LOS;    // Start and end [s since the track epoch]
+};
+
+//------------------------------------------------------------------------------
+//
+// ReadAccessSites
+//
+// Purpose:
+//
+//   Reads a list of ground sites
+//
+// Input/Output:
+//
+//   path        Text file with lines "name lat[deg] lon[deg] [h[m]]";
+//               empty lines and lines starting with '#' are skipped
+//   Sites       Ground sites
+//   <return>    false if the file could not be read
+//
+//------------------------------------------------------------------------------
+bool ReadAccessSites (const std::string& path, std::vector<AccessSite>& Sites);
+
+//------------------------------------------------------------------------------
+//
+// ComputeAccess
+//
+// Purpose:
+//
+//   Visibility intervals of all satellites from all sites
+//
+// Input/Output:
+//
+//   Pool        Thread pool; the site/satellite pairs are processed in
+//               parallel
+//   Sites       Ground sites
+//   Tracks      Earth-fixed (ITRF) ephemerides of the satellites [m, m/s]
+//   El_mask     Elevation mask [rad]
+//   dt_scan     Step of the coarse scan [s]
+//   Access      Intervals of each site ordered by satellite and time
+//
+//------------------------------------------------------------------------------
+void ComputeAccess (WorkStealingPool& Pool,
+                    const std::vector<AccessSite>& Sites,
+                    const std::vector<EphemerisTrack>& Tracks,
+                    double El_mask, double dt_scan,
+                    std::vector<std::vector<AccessInterval> >& Access);
+
+//------------------------------------------------------------------------------
+//
+// WriteAccessReport
+//
+// Purpose:
+//
+//   Access report with start, stop (UTC, 1 ms resolution) and duration of
+//   every interval
+//
+// Input/Output:
+//
+//   out         Output stream
+//   Sites       Ground sites
+//   SatIds      Names of the satellites
+//   Access      Intervals of each site (ComputeAccess)
+//   Mjd_UTC_0   Epoch of the tracks (UTC)
+//   El_mask     Elevation mask [rad]
+//
+//------------------------------------------------------------------------------
+void WriteAccessReport (std::ostream& out,
+                        const std::vector<AccessSite>& Sites,
+                        const std::vector<std::string>& SatIds,
+                        const std::vector<std::vector<AccessInterval> >& Access,
+                        double Mjd_UTC_0, double El_mask);
+
+#endif  // include-Blocker
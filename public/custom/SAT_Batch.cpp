@@ -0,0 +1,282 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Batch.cpp
+//
+// Purpose:
+//
+//   Simultaneous propagation of many satellites with a common epoch and
+//   step size (batched 4th-order Runge-Kutta integrator)
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#include <math.h>
+
+#include "SAT_Batch.h"
+#include "SAT_Const.h"
+#include "SAT_Density.h"
+#include "SAT_Force.h"
+#include "SAT_RefSys.h"
+#include "SAT_SunMoon.h"
+
+//------------------------------------------------------------------------------
+//
+// BatchRK4 (class implementation)
+//
+//------------------------------------------------------------------------------
+
+// Constructor
+
+BatchRK4::BatchRK4 (const BatchForceModel& Model_, int n_sat)
+  : Model(Model_)
+{
+  Ctx.Frames = Model.Frames;
+  Ctx.Bodies = Model.Bodies;
+  Ctx.Atmosphere = Model.Atmosphere;
+  Ctx.TideInterval = Model.TideInterval;
+  Y.resize(n_sat);
+  k_1.resize(n_sat); k_2.resize(n_sat); k_3.resize(n_sat); k_4.resize(n_sat);
+  Y_tmp.resize(n_sat);
+  for (int j=0; j<10; j++) w[j].assign(n_sat,0.0);
+}
+
+// State vector of satellite i
+
+void BatchRK4::SetState (int i, const Vec6& Y_i)
+{
+  for (int j=0; j<6; j++) Y.c[j][i] = Y_i(j);
+}
+
+Vec6 BatchRK4::State (int i) const
+{
+  Vec6 Y_i;
+  for (int j=0; j<6; j++) Y_i(j) = Y.c[j][i];
+  return Y_i;
+}
+
+// Integration step (same stage arithmetic as RK4::Step)
+
+void BatchRK4::Step (double& t, double h)
+{
+  int n = Size();
+
+  Deriv( t, Y, k_1 );
+  for (int j=0; j<6; j++) {
+    const double *y=&Y.c[j][0], *k=&k_1.c[j][0]; double *z=&Y_tmp.c[j][0];
+    for (int i=0; i<n; i++) z[i] = y[i]+(h/2.0)*k[i];
+  }
+  Deriv( t+h/2.0, Y_tmp, k_2 );
+  for (int j=0; j<6; j++) {
+    const double *y=&Y.c[j][0], *k=&k_2.c[j][0]; double *z=&Y_tmp.c[j][0];
+    for (int i=0; i<n; i++) z[i] = y[i]+(h/2.0)*k[i];
+  }
+  Deriv( t+h/2.0, Y_tmp, k_3 );
+  for (int j=0; j<6; j++) {
+    const double *y=&Y.c[j][0], *k=&k_3.c[j][0]; double *z=&Y_tmp.c[j][0];
+    for (int i=0; i<n; i++) z[i] = y[i]+h*k[i];
+  }
+  Deriv( t+h, Y_tmp, k_4 );
+
+  for (int j=0; j<6; j++) {
+    double *y=&Y.c[j][0];
+    const double *a=&k_1.c[j][0], *b=&k_2.c[j][0], *c=&k_3.c[j][0], *d=&k_4.c[j][0];
+    for (int i=0; i<n; i++) y[i] += (h/6.0)*( a[i] + 2.0*b[i] + 2.0*c[i] + d[i] );
+  }
+
+  // Update independent variable
+  t = t + h;
+}
+
+// Time derivative of the batch state
+
+void BatchRK4::Deriv (double t, const BatchState& Y_, BatchState& Yp)
+{
+  int    n = Y_.size();
+  double Mjd_UTC;
+  Vec3   r_Sun, r_Moon;
+  EarthFrame F;
+  bool   Tides = Model.SolidEarthTides || Model.OceanTides;
+
+  // Time-dependent quantities (once for all satellites)
+  Mjd_UTC = Model.Mjd_UTC + t/86400.0;
+
+  ComputeEarthFrame(Ctx, Mjd_UTC, F);
+  const Mat3& T = F.T;
+  const Mat3& E = F.E;
+
+  if (Model.Sun || Model.SRad || Tides) r_Sun  = SunPosition(Ctx, F);
+  if (Model.Moon || Tides)              r_Moon = MoonPosition(Ctx, F);
+
+  // Velocities
+  for (int j=0; j<3; j++) Yp.c[j] = Y_.c[j+3];
+
+  // Harmonic gravity field
+  if (Tides || Model.m>0) {
+    for (int i=0; i<n; i++) {
+      Vec3 r(Y_.c[0][i],Y_.c[1][i],Y_.c[2][i]), a;
+      if (Tides)
+        a = AccelHarmonic_AnelasticEarth(Ctx, Mjd_UTC, r, r_Sun, r_Moon, E,
+              *Model.Gravity, Model.SolidEarthTides, Model.OceanTides);
+      else
+        a = Model.Gravity->Accel(r, E);
+      for (int j=0; j<3; j++) Yp.c[j+3][i] = a(j);
+    }
+  }
+  else {
+    AccelZonal(E, Y_, Yp);
+  }
+
+  // Luni-solar perturbations
+  if (Model.Sun)  AccelPointMass(r_Sun,  GM_Sun,  Y_, Yp);
+  if (Model.Moon) AccelPointMass(r_Moon, GM_Moon, Y_, Yp);
+
+  // Solar radiation pressure
+  if (Model.SRad) AccelSolrad(r_Sun, Y_, Yp);
+
+  // Atmospheric densities of all satellites (one call of the density model)
+  if (Model.Drag) {
+    r_ecef.resize(n);
+    dens.resize(n);
+    for (int i=0; i<n; i++)
+      r_ecef[i] = E*Vec3(Y_.c[0][i],Y_.c[1][i],Y_.c[2][i]);
+    if (Ctx.Atmosphere)
+      Ctx.Atmosphere->Density(Ctx, Mjd_UTC, n, &r_ecef[0], &dens[0]);
+    else
+      Density_NRL(Ctx, Mjd_UTC, n, &r_ecef[0], &dens[0]);
+  }
+
+  // Atmospheric drag and relativistic effects (per satellite)
+  if (Model.Drag || Model.Relativity) {
+    for (int i=0; i<n; i++) {
+      Vec3 r(Y_.c[0][i],Y_.c[1][i],Y_.c[2][i]);
+      Vec3 v(Y_.c[3][i],Y_.c[4][i],Y_.c[5][i]);
+      Vec3 a;
+      if (Model.Drag)
+        a += AccelDrag(dens[i], r, v, T, Model.Area_drag, Model.mass, Model.CD);
+      if (Model.Relativity) a += Relativity(r,v);
+      for (int j=0; j<3; j++) Yp.c[j+3][i] += a(j);
+    }
+  }
+}
+
+//
+// Central body and zonal harmonics up to degree Model.n
+//
+// The body-fixed acceleration of degree n follows from the potential
+// U_n = GM/r (R/r)^n C_n0 sqrt(2n+1) P_n(u), u=z/r, as
+//
+//   a = GM/r^2 (R/r)^n C_n0 sqrt(2n+1) *
+//       { [ -(n+1) P_n(u) - u P_n'(u) ] r/r + P_n'(u) e_z }
+//
+// Legendre polynomials and their derivatives are obtained by recursion
+// in n, with the satellite loop innermost.
+//
+
+void BatchRK4::AccelZonal (const Mat3& E, const BatchState& Y_, BatchState& Yp)
+{
+  int     n = Y_.size();
+  const double *x=&Y_.c[0][0], *y=&Y_.c[1][0], *z=&Y_.c[2][0];
+  double  *ax=&Yp.c[3][0], *ay=&Yp.c[4][0], *az=&Yp.c[5][0];
+  double  *ex=&w[0][0], *ey=&w[1][0], *u=&w[2][0];     // Body-fixed unit vector
+  double  *rho=&w[3][0], *f=&w[4][0];                   // R/r, GM/r^2*(R/r)^n
+  double  *P2=&w[5][0], *P1=&w[6][0], *dP1=&w[7][0];    // P_n-2, P_n-1, P_n-1'
+  double  *A=&w[8][0], *B=&w[9][0];                     // Radial and z-terms
+  double  c_0 = Model.Field->C(0,0);
+  double  c_1 = (Model.n>=1) ? Model.Field->C(1,0)*sqrt(3.0) : 0.0;
+
+  // Body-fixed position; degrees 0 and 1
+  for (int i=0; i<n; i++) {
+    double xb = E(0,0)*x[i]+E(0,1)*y[i]+E(0,2)*z[i];
+    double yb = E(1,0)*x[i]+E(1,1)*y[i]+E(1,2)*z[i];
+    double zb = E(2,0)*x[i]+E(2,1)*y[i]+E(2,2)*z[i];
+    double d  = sqrt(xb*xb+yb*yb+zb*zb);
+    ex[i]  = xb/d;
+    ey[i]  = yb/d;
+    u[i]   = zb/d;
+    rho[i] = Model.R_ref/d;
+    f[i]   = Model.GM/(d*d);
+    A[i]   = -f[i]*c_0;
+    f[i]  *= rho[i];
+    A[i]  += f[i]*c_1*(-3.0*u[i]);
+    B[i]   = f[i]*c_1;
+    P2[i]  = 1.0;
+    P1[i]  = u[i];
+    dP1[i] = 1.0;
+  }
+
+  // Degrees 2..n
+  for (int k=2; k<=Model.n; k++) {
+    double a_k = (2.0*k-1.0)/k, b_k = (k-1.0)/k;
+    double c_k = Model.Field->C(k,0)*sqrt(2.0*k+1.0);
+    for (int i=0; i<n; i++) {
+      double P  = a_k*u[i]*P1[i] - b_k*P2[i];
+      double dP = k*P1[i] + u[i]*dP1[i];
+      P2[i]  = P1[i];
+      P1[i]  = P;
+      dP1[i] = dP;
+      f[i]  *= rho[i];
+      A[i]  += f[i]*c_k*(-(k+1.0)*P - u[i]*dP);
+      B[i]  += f[i]*c_k*dP;
+    }
+  }
+
+  // Inertial acceleration a = E^T a_bf
+  for (int i=0; i<n; i++) {
+    double abx = A[i]*ex[i];
+    double aby = A[i]*ey[i];
+    double abz = A[i]*u[i] + B[i];
+    ax[i] = E(0,0)*abx+E(1,0)*aby+E(2,0)*abz;
+    ay[i] = E(0,1)*abx+E(1,1)*aby+E(2,1)*abz;
+    az[i] = E(0,2)*abx+E(1,2)*aby+E(2,2)*abz;
+  }
+}
+
+//
+// Point mass perturbation (see AccelPointMass in SAT_Force)
+//
+
+void BatchRK4::AccelPointMass (const Vec3& s, double GM, const BatchState& Y_,
+                               BatchState& Yp)
+{
+  int    n  = Y_.size();
+  const double *x=&Y_.c[0][0], *y=&Y_.c[1][0], *z=&Y_.c[2][0];
+  double *ax=&Yp.c[3][0], *ay=&Yp.c[4][0], *az=&Yp.c[5][0];
+  double s3 = pow(Norm(s),3);
+  double sx = s(0)/s3, sy = s(1)/s3, sz = s(2)/s3;
+
+  for (int i=0; i<n; i++) {
+    double dx = x[i]-s(0), dy = y[i]-s(1), dz = z[i]-s(2);
+    double d  = sqrt(dx*dx+dy*dy+dz*dz);
+    double d3 = d*d*d;
+    ax[i] += (-GM)*(dx/d3+sx);
+    ay[i] += (-GM)*(dy/d3+sy);
+    az[i] += (-GM)*(dz/d3+sz);
+  }
+}
+
+//
+// Solar radiation pressure with cylindrical shadow model (see AccelSolrad
+// and Illumination in SAT_Force)
+//
+
+void BatchRK4::AccelSolrad (const Vec3& r_Sun, const BatchState& Y_, BatchState& Yp)
+{
+  int    n  = Y_.size();
+  const double *x=&Y_.c[0][0], *y=&Y_.c[1][0], *z=&Y_.c[2][0];
+  double *ax=&Yp.c[3][0], *ay=&Yp.c[4][0], *az=&Yp.c[5][0];
+  Vec3   e_Sun = r_Sun/Norm(r_Sun);
+  double Fac   = Model.CR*(Model.Area_solar/Model.mass)*P_Sol*(AU*AU);
+
+  for (int i=0; i<n; i++) {
+    double s  = x[i]*e_Sun(0)+y[i]*e_Sun(1)+z[i]*e_Sun(2);
+    double px = x[i]-s*e_Sun(0), py = y[i]-s*e_Sun(1), pz = z[i]-s*e_Sun(2);
+    double nu = ( s>0 || px*px+py*py+pz*pz>R_Earth*R_Earth ) ? 1.0 : 0.0;
+    double dx = x[i]-r_Sun(0), dy = y[i]-r_Sun(1), dz = z[i]-r_Sun(2);
+    double d  = sqrt(dx*dx+dy*dy+dz*dz);
+    double g  = nu*Fac/(d*d*d);
+    ax[i] += g*dx;
+    ay[i] += g*dy;
+    az[i] += g*dz;
+  }
+}
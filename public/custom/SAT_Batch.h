@@ -0,0 +1,129 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Batch.h
+//
+// Purpose:
+//
+//   Simultaneous propagation of many satellites with a common epoch and
+//   step size (batched 4th-order Runge-Kutta integrator)
+//
+// Notes:
+//
+//   The states of all satellites are held in structure-of-arrays layout.
+//   Quantities depending on time only (precession, nutation, Earth rotation
+//   and polar motion matrices, EOP values, Sun and Moon positions) are
+//   computed once per stage for the whole batch. Central body, zonal
+//   harmonics, point-mass and solar radiation pressure terms are evaluated
+//   by loops running over all satellites. Tesseral harmonics (HarmonicGravity),
+//   tides, drag and relativity are evaluated per satellite.
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifndef INC_SAT_BATCH_H
+#define INC_SAT_BATCH_H
+
+#include <vector>
+
+#include "SAT_Context.h"
+#include "SAT_Gravity.h"
+#include "SAT_RefSys.h"
+#include "SAT_SunMoon.h"
+#include "SAT_VecMat.h"
+
+//------------------------------------------------------------------------------
+//
+// BatchForceModel
+//
+// Purpose:
+//
+//   Force model parameters shared by all satellites of a batch
+//
+//------------------------------------------------------------------------------
+struct BatchForceModel
+{
+  double        Mjd_UTC;                   // Epoch of t=0 (UTC)
+  double        GM, R_ref;                 // Gravity model constants
+  const GravityField* Field;               // Normalized harmonic coefficients
+  int           n, m;                      // Maximum degree and order
+  double        Area_drag, Area_solar, mass, CR, CD;
+  bool          Sun, Moon, SRad, Drag, SolidEarthTides, OceanTides, Relativity;
+  const FrameCache* Frames;                // Precession-nutation table or 0
+  const SunMoonCache* Bodies;              // Sun/Moon ephemeris cache or 0
+  const DensityModel* Atmosphere;          // Density model or 0 (NRLMSISE-00)
+  const HarmonicGravity* Gravity;          // Gravity field (degree n, order m)
+  double        TideInterval;              // Reuse of tidal corrections [s]
+};
+
+//------------------------------------------------------------------------------
+//
+// BatchState
+//
+// Purpose:
+//
+//   Position and velocity of all satellites of a batch (structure of arrays)
+//
+//------------------------------------------------------------------------------
+struct BatchState
+{
+  std::vector<double> c[6];                // x,y,z,vx,vy,vz [m, m/s]
+
+  void resize (int n) { for (int j=0; j<6; j++) c[j].assign(n,0.0); };
+  int  size () const  { return (int)c[0].size(); };
+};
+
+//------------------------------------------------------------------------------
+//
+// BatchRK4 (class definition)
+//
+// Purpose:
+//
+//   Batched 4th-order Runge-Kutta integrator for the equations of motion
+//   of a set of Earth satellites
+//
+//------------------------------------------------------------------------------
+class BatchRK4
+{
+  public:
+
+    // Constructor
+    BatchRK4 (
+      const BatchForceModel& Model_,  // Force model
+      int                    n_sat    // Number of satellites
+    );
+
+    // Number of satellites
+    int Size () const { return Y.size(); };
+
+    // State vector of satellite i
+    void SetState (int i, const Vec6& Y_i);
+    Vec6 State    (int i) const;
+
+    // Integration step for all satellites
+    void Step (
+      double&  t,           // Time since epoch [s]; updated by t+h
+      double   h            // Step size [s]
+    );
+
+    // Time derivative of the batch state
+    void Deriv (double t, const BatchState& Y_, BatchState& Yp);
+
+  private:
+
+    // Acceleration terms evaluated for the whole batch
+    void AccelZonal     (const Mat3& E, const BatchState& Y_, BatchState& Yp);
+    void AccelPointMass (const Vec3& s, double GM, const BatchState& Y_,
+                         BatchState& Yp);
+    void AccelSolrad    (const Vec3& r_Sun, const BatchState& Y_, BatchState& Yp);
+
+    BatchForceModel     Model;
+    PropagationContext  Ctx;
+    BatchState          Y;                         // States at time t
+    BatchState          k_1,k_2,k_3,k_4,Y_tmp;     // Stage buffers
+    std::vector<double> w[10];                     // Workspace of AccelZonal
+    std::vector<Vec3>   r_ecef;                    // Earth-fixed positions and
+    std::vector<double> dens;                      // densities of the drag model
+};
+
+#endif  // include-Blocker
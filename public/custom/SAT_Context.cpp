@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Context.cpp
+//
+// Purpose:
+//
+//   Per-job state of the orbit propagation (Earth orientation and space
+//   weather lookups, IERS time differences)
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#include <math.h>
+
+#include "SAT_Const.h"
+#include "SAT_Context.h"
+#include "SAT_RefSys.h"
+#include "eopspw.h"
+
+// Tables loaded in the main program
+extern eoptable eoptab;
+extern spwtable spwtab;
+
+//------------------------------------------------------------------------------
+//
+// PropagationContext (class implementation)
+//
+//------------------------------------------------------------------------------
+
+// Constructors
+
+PropagationContext::PropagationContext ()
+  : eop(&::eoptab), spw(&::spwtab), Frames(0), Bodies(0), Atmosphere(0),
+    dat(0), dut1(0.0), lod(0.0), xp(0.0), yp(0.0), ddpsi(0.0), ddeps(0.0),
+    dx(0.0), dy(0.0), x(0.0), y(0.0), s(0.0), deltapsi(0.0), deltaeps(0.0),
+    f107(0.0), f107bar(0.0), ap(0.0), avgap(0.0), kp(0.0), sumkp(0.0),
+    SpwBin(-1), SpwDoy(0), SpwF107(0.0), SpwF107A(0.0),
+    Mjd_Tides(0.0), TideFlags(-1), TideInterval(0.0),
+    UT1_TAI_(0.0), UTC_TAI_(0.0), x_pole_(0.0), y_pole_(0.0)
+{
+  for (int i=0; i<8; i++) aparr[i]=kparr[i]=0.0;
+  for (int i=0; i<7; i++) SpwAp[i]=0.0;
+}
+
+PropagationContext::PropagationContext (const eoptable* eop_,
+                                        const spwtable* spw_)
+  : eop(eop_), spw(spw_), Frames(0), Bodies(0), Atmosphere(0),
+    dat(0), dut1(0.0), lod(0.0), xp(0.0), yp(0.0), ddpsi(0.0), ddeps(0.0),
+    dx(0.0), dy(0.0), x(0.0), y(0.0), s(0.0), deltapsi(0.0), deltaeps(0.0),
+    f107(0.0), f107bar(0.0), ap(0.0), avgap(0.0), kp(0.0), sumkp(0.0),
+    SpwBin(-1), SpwDoy(0), SpwF107(0.0), SpwF107A(0.0),
+    Mjd_Tides(0.0), TideFlags(-1), TideInterval(0.0),
+    UT1_TAI_(0.0), UTC_TAI_(0.0), x_pole_(0.0), y_pole_(0.0)
+{
+  for (int i=0; i<8; i++) aparr[i]=kparr[i]=0.0;
+  for (int i=0; i<7; i++) SpwAp[i]=0.0;
+}
+
+// Earth orientation parameters for given epoch
+// (UT1-UTC [s], UTC-TAI [s], x ["], y ["] as in IERS::Set)
+
+void PropagationContext::Update (double Mjd_UTC)
+{
+  double jd, mfme;
+  char   interp = 'l';
+
+  jd   = Mjd_UTC + 2400000.5;
+  mfme = 1440.0*(Mjd_UTC - floor(Mjd_UTC));
+  findeopparam(jd, mfme, interp, *eop, dut1, dat, lod, xp, yp,
+               ddpsi, ddeps, dx, dy, x, y, s, deltapsi, deltaeps);
+
+  UT1_TAI_ = dut1 - dat;
+  UTC_TAI_ = -dat;
+  x_pole_  = xp / Arcs;
+  y_pole_  = yp / Arcs;
+}
+
+// Time differences [s]
+
+double PropagationContext::TT_UTC() const
+{
+  return IERS::TT_TAI - UTC_TAI_;
+}
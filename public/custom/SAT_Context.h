@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Context.h
+//
+// Purpose:
+//
+//   Per-job state of the orbit propagation (Earth orientation and space
+//   weather lookups, IERS time differences)
+//
+// Notes:
+//
+//   Each propagation job owns a PropagationContext and passes it down to
+//   the force model and reference system transformations. The EOP and space
+//   weather tables are shared read-only between all contexts, so that
+//   several satellites may be propagated concurrently.
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifndef INC_SAT_CONTEXT_H
+#define INC_SAT_CONTEXT_H
+
+#include "SAT_Gravity.h"
+#include "eopspw.h"
+#include "nrlmsise-00.h"
+
+class DensityModel;
+class FrameCache;
+class SunMoonCache;
+
+//------------------------------------------------------------------------------
+//
+// PropagationContext (class definition)
+//
+// Purpose:
+//
+//   Earth orientation parameters, IERS time differences and space weather
+//   scratch data of a single propagation job. Replaces the process-global
+//   EOP/space weather variables and the static state of class IERS.
+//
+//------------------------------------------------------------------------------
+class PropagationContext
+{
+  public:
+
+    // Constructors
+    PropagationContext ();                       // Uses the global tables
+    PropagationContext (const eoptable* eop_, const spwtable* spw_);
+
+    // Earth orientation parameters for given epoch; sets the time
+    // differences and pole coordinates returned below
+    void Update (double Mjd_UTC);
+
+    // Time differences [s]
+    double UTC_TAI() const { return UTC_TAI_; };
+    double UT1_TAI() const { return UT1_TAI_; };
+    double  TT_UTC() const;
+    double UT1_UTC() const { return UT1_TAI_ - UTC_TAI_; };
+
+    // Pole coordinates [rad]
+    double x_pole() const { return x_pole_; };
+    double y_pole() const { return y_pole_; };
+
+    // Shared tables (read-only)
+    const eoptable* eop;
+    const spwtable* spw;
+
+    // Interpolation table of the precession-nutation matrix (optional,
+    // shared and read-only; 0 for the rigorous evaluation)
+    const FrameCache* Frames;
+
+    // Chebyshev approximation of the Sun and Moon positions (optional,
+    // shared; 0 for the direct evaluation of the analytical series)
+    const SunMoonCache* Bodies;
+
+    // Atmospheric density model of the drag acceleration (optional,
+    // shared; 0 for the direct evaluation of NRLMSISE-00)
+    const DensityModel* Atmosphere;
+
+    // Earth orientation parameters of the last Update (as in findeopparam)
+    int    dat;
+    double dut1, lod, xp, yp, ddpsi, ddeps, dx, dy, x, y, s, deltapsi, deltaeps;
+
+    // Space weather data (scratch variables of findatmosparam)
+    double f107, f107bar, ap, avgap, kp, sumkp, aparr[8], kparr[8];
+
+    // NRLMSISE-00 space weather input (day of year, F10.7 of the previous
+    // day, 81-day average and ap array) of the 3-hour interval SpwBin
+    // (counted from MJD 0 UTC; -1: not set); see Density_NRL
+    long   SpwBin;
+    int    SpwDoy;
+    double SpwF107, SpwF107A, SpwAp[7];
+
+    // Intermediate results of NRLMSISE-00 (see Density_NRL)
+    nrlmsise_workspace Msis;
+
+    // Tidal corrections of the gravity field at epoch Mjd_Tides (UTC) for
+    // the tide models TideFlags (1: solid Earth, 2: ocean; -1: not set);
+    // reused for epochs within TideInterval [s]
+    TideDelta Tides;
+    double    Mjd_Tides;
+    int       TideFlags;
+    double    TideInterval;
+
+  private:
+
+    double UT1_TAI_;                     // UT1-TAI time difference [s]
+    double UTC_TAI_;                     // UTC-TAI time difference [s]
+    double x_pole_;                      // Pole coordinate [rad]
+    double y_pole_;                      // Pole coordinate [rad]
+};
+
+#endif  // include-Blocker
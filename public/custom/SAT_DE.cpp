@@ -6,14 +6,20 @@
 //
 //   Numerical integration methods for ordinaray differential equations
 //
-//   This module provides implemenations of the 4th-order Runge-Kutta method
-//   and the variable order variable stepsize multistep method of Shampine &
+//   This module provides implemenations of the 4th-order Runge-Kutta method,
+//   the Runge-Kutta-Fehlberg 7(8) method with step size control, the
+//   8th-order Gauss-Jackson method for second-order equations and the
+//   variable order variable stepsize multistep method of Shampine &
 //   Gordon.
 // 
 // Reference:
 //
 //   Shampine, Gordon: "Computer solution of Ordinary Differential Equations",
 //   Freeman and Comp., San Francisco (1975).
+//   Fehlberg: "Classical fifth-, sixth-, seventh-, and eighth-order
+//   Runge-Kutta formulas with stepsize control", NASA TR R-287 (1968).
+//   Berry, Healy: "Implementation of Gauss-Jackson integration for orbit
+//   propagation", J. Astronaut. Sci. 52, 331-357 (2004).
 //
 // Last modified:
 //
@@ -64,6 +70,96 @@ namespace // Unnamed namespace
    return (b>=0.0) ? fabs(a) : - fabs(a);
   };
 
+
+  // Coefficients of the Runge-Kutta-Fehlberg 7(8) method
+
+  const double c_78[13] = {
+    0.0, 2.0/27.0, 1.0/9.0, 1.0/6.0, 5.0/12.0, 1.0/2.0, 5.0/6.0, 1.0/6.0,
+    2.0/3.0, 1.0/3.0, 1.0, 0.0, 1.0 };
+
+  const double a_78[13][12] = {
+    { 0.0 },
+    { 2.0/27.0 },
+    { 1.0/36.0, 1.0/12.0 },
+    { 1.0/24.0, 0.0, 1.0/8.0 },
+    { 5.0/12.0, 0.0, -25.0/16.0, 25.0/16.0 },
+    { 1.0/20.0, 0.0, 0.0, 1.0/4.0, 1.0/5.0 },
+    { -25.0/108.0, 0.0, 0.0, 125.0/108.0, -65.0/27.0, 125.0/54.0 },
+    { 31.0/300.0, 0.0, 0.0, 0.0, 61.0/225.0, -2.0/9.0, 13.0/900.0 },
+    { 2.0, 0.0, 0.0, -53.0/6.0, 704.0/45.0, -107.0/9.0, 67.0/90.0, 3.0 },
+    { -91.0/108.0, 0.0, 0.0, 23.0/108.0, -976.0/135.0, 311.0/54.0,
+      -19.0/60.0, 17.0/6.0, -1.0/12.0 },
+    { 2383.0/4100.0, 0.0, 0.0, -341.0/164.0, 4496.0/1025.0, -301.0/82.0,
+      2133.0/4100.0, 45.0/82.0, 45.0/164.0, 18.0/41.0 },
+    { 3.0/205.0, 0.0, 0.0, 0.0, 0.0, -6.0/41.0, -3.0/205.0, -3.0/41.0,
+      3.0/41.0, 6.0/41.0, 0.0 },
+    { -1777.0/4100.0, 0.0, 0.0, -341.0/164.0, 4496.0/1025.0, -289.0/82.0,
+      2193.0/4100.0, 51.0/82.0, 33.0/164.0, 12.0/41.0, 0.0, 1.0 } };
+
+  // Weights of the 8th-order solution
+  const double b_78[13] = {
+    0.0, 0.0, 0.0, 0.0, 0.0, 34.0/105.0, 9.0/35.0, 9.0/35.0, 9.0/280.0,
+    9.0/280.0, 0.0, 41.0/840.0, 41.0/840.0 };
+
+  // Local error estimate: difference of the 7th- and 8th-order solutions,
+  // (41/840)*h*(k_0+k_10-k_11-k_12)
+  const double e_78 = 41.0/840.0;
+
+
+  // Gauss-Jackson weights. With the sums s(n+1)=s(n)+(a(n)+a(n+1))/2 and
+  // S(n+1)=S(n)+s(n)+a(n)/2 the velocity and position are
+  //   v(n) = h*(s(n)+A(D)a(n)),  r(n) = h^2*(S(n)+B(D)a(n)),
+  // where D=h*d/dt and
+  //   A(D) = 1/D-coth(D/2)/2       = -sum B_2k D^(2k-1)/(2k)!
+  //   B(D) = 1/D^2-1/(4sinh^2(D/2)) = sum (2k-1) B_2k D^(2k-2)/(2k)!
+  // (B_2k: Bernoulli numbers). The series are applied to the polynomial
+  // interpolating the accelerations at x=-4..4 and evaluated at x=j-4,
+  // j=0..9 (j=9: one step beyond the stencil); l holds the values of the
+  // Lagrange polynomials at x=5.
+
+  void GJ_Weights (double a[10][9], double b[10][9], double l[9])
+  {
+    const double Bern[5] = { 1.0/6.0, -1.0/30.0, 1.0/42.0, -1.0/30.0,
+                             5.0/66.0 };
+    double A[9] = {0.0}, B[9] = {0.0}, fac = 1.0;
+
+    for (int k=1; k<=5; k++) {
+      fac *= (2*k-1)*(2*k);
+      if (2*k-1<9) A[2*k-1] = -Bern[k-1]/fac;
+      B[2*k-2] = (2*k-1)*Bern[k-1]/fac;
+    }
+
+    for (int k=0; k<9; k++) {
+
+      // Monomial coefficients of the Lagrange polynomial of point k
+      double c[9] = {1.0};
+      int    deg  = 0;
+      for (int i=0; i<9; i++) {
+        if (i==k) continue;
+        for (int q=deg+1; q>0; q--) c[q] = (c[q-1]-(i-4)*c[q])/(k-i);
+        c[0] = -(i-4)*c[0]/(k-i);
+        deg++;
+      }
+
+      for (int j=0; j<10; j++) {
+        double x = j-4;
+        a[j][k] = b[j][k] = 0.0;
+        for (int p=0; p<9; p++) {
+          // p-th derivative at x
+          double d = 0.0;
+          for (int q=8; q>=p; q--) {
+            double ff = 1.0;
+            for (int r=q-p+1; r<=q; r++) ff *= r;
+            d = d*x + ff*c[q];
+          }
+          a[j][k] += A[p]*d;
+          b[j][k] += B[p]*d;
+          if (j==9 && p==0) l[k] = d;
+        }
+      }
+    }
+  }
+
 }
 
 
@@ -77,14 +173,18 @@ namespace // Unnamed namespace
 
 void RK4::Step (double& t, Vector& y, double h) {
 
-  // Elementary RK4 step
+  // Elementary RK4 step; the vector expressions are evaluated in place 
+  // into the preallocated stage buffers
 
-  f( t      , y            , k_1, pAux );
-  f( t+h/2.0, y+(h/2.0)*k_1, k_2, pAux );
-  f( t+h/2.0, y+(h/2.0)*k_2, k_3, pAux );
-  f( t+h    , y+h*k_3      , k_4, pAux );
+  f( t      , y    , k_1, pAux );
+  y_tmp = y+(h/2.0)*k_1;
+  f( t+h/2.0, y_tmp, k_2, pAux );
+  y_tmp = y+(h/2.0)*k_2;
+  f( t+h/2.0, y_tmp, k_3, pAux );
+  y_tmp = y+h*k_3;
+  f( t+h    , y_tmp, k_4, pAux );
   
-  y = y + (h/6.0)*( k_1 + 2.0*k_2 + 2.0*k_3 + k_4 );
+  y += (h/6.0)*( k_1 + 2.0*k_2 + 2.0*k_3 + k_4 );
 
   // Update independent variable
 
@@ -93,6 +193,361 @@ void RK4::Step (double& t, Vector& y, double h) {
 };
 
 
+//------------------------------------------------------------------------------
+//
+// RKF78 class (implementation)
+//
+//------------------------------------------------------------------------------
+
+
+//
+// Constructor
+//
+
+RKF78::RKF78 (
+      RK4funct   f_,            // Differential equation
+      int        n_eqn_,        // Dimension
+      void*      pAux_,         // Pointer to auxiliary data
+      bool       SecondOrder_   // y=(r,v) with y'=(v,a)
+      )
+: relerr(0.0), abserr(0.0), h_max(0.0), t(0.0), nfev(0), nstep(0), nrej(0),
+  f(f_), n_eqn(n_eqn_), pAux(pAux_), SecondOrder(SecondOrder_ && n_eqn_%2==0),
+  h(0.0), t_0(0.0),
+  y_0(n_eqn_), yp_0(n_eqn_), y_1(n_eqn_), yp_1(n_eqn_), y_tmp(n_eqn_)
+{
+  for (int i=0; i<13; i++) k[i] = Vector(n_eqn_);
+};
+
+
+//
+// Initialization
+//
+
+void RKF78::Init (double t0, const Vector& y0, double h0, double rel,
+                  double abs)
+{
+  if (h0==0.0 || rel<0.0 || abs<0.0 || rel+abs<=0.0) {
+    std::cerr << "ERROR: Invalid step size or accuracy in RKF78::Init"
+              << std::endl;
+    exit(1);
+  }
+
+  relerr = rel;
+  abserr = abs;
+  h      = h0;
+  t      = t_0 = t0;
+  y_1    = y0;
+  f( t, y_1, yp_1, pAux );
+  y_0    = y_1;
+  yp_0   = yp_1;
+  nfev   = 1;
+  nstep  = nrej = 0;
+};
+
+
+//
+// Integration step with step size control
+//
+
+void RKF78::Step ()
+{
+  double err, sc, e, fac;
+
+  for (;;) {
+
+    if (h_max>0.0 && fabs(h)>h_max) h = sign(h_max,h);
+    if (fabs(h) <= fouru*fabs(t)) {
+      std::cerr << "ERROR: Step size underflow in RKF78 at t=" << t
+                << std::endl;
+      exit(1);
+    }
+
+    // Stage derivatives; the first stage is the derivative at t
+    k[0] = yp_1;
+    for (int i=1; i<13; i++) {
+      for (int j=0; j<n_eqn; j++) {
+        double sum = 0.0;
+        for (int l=0; l<i; l++) sum += a_78[i][l]*k[l](j);
+        y_tmp(j) = y_1(j) + h*sum;
+      }
+      f( t+c_78[i]*h, y_tmp, k[i], pAux );
+    }
+    nfev += 12;
+
+    // 8th-order solution and weighted maximum norm of the local error
+    err = 0.0;
+    for (int j=0; j<n_eqn; j++) {
+      double sum = 0.0;
+      for (int i=5; i<13; i++) sum += b_78[i]*k[i](j);
+      y_tmp(j) = y_1(j) + h*sum;
+      e  = fabs( e_78*h*(k[0](j)+k[10](j)-k[11](j)-k[12](j)) );
+      sc = abserr + relerr*max(fabs(y_1(j)),fabs(y_tmp(j)));
+      err = max(err, e/sc);
+    }
+
+    // New step size (safety factor 0.9, change by at most 1/5 ... 5)
+    fac = (err>0.0) ? 0.9*pow(err,-1.0/8.0) : 5.0;
+    fac = min(5.0, max(0.2, fac));
+
+    if (err <= 1.0) {
+      // Accept step; the derivative at the new point is the first stage
+      // of the next step
+      t_0  = t;
+      y_0  = y_1;
+      yp_0 = yp_1;
+      t    = t + h;
+      y_1  = y_tmp;
+      f( t, y_1, yp_1, pAux );
+      nfev++;
+      nstep++;
+      h *= fac;
+      return;
+    }
+
+    nrej++;
+    h *= fac;
+  }
+};
+
+
+//
+// Integration up to or past tout and interpolation at tout
+//
+
+void RKF78::Integ (double tout, Vector& y)
+{
+  while ( (tout-t)*h > 0.0 ) Step();
+  Intrp(tout, y);
+};
+
+
+//
+// Interpolation within the last step [t_0,t]: quintic Hermite polynomials
+// for the positions of a second-order system (position, velocity and
+// acceleration at both ends), cubic Hermite polynomials otherwise
+//
+
+void RKF78::Intrp (double tout, Vector& y) const
+{
+  double dt = t - t_0;
+
+  if (y.size()==0) y = Vector(n_eqn);
+  if (dt==0.0) { y = y_1; return; }
+
+  double s  = (tout-t_0)/dt;
+  double s2 = s*s, s3 = s2*s, s4 = s3*s, s5 = s4*s;
+
+  if (SecondOrder) {
+    int    m = n_eqn/2;
+    double H0 = 1.0 - 10.0*s3 + 15.0*s4 - 6.0*s5,  D0 = -30.0*s2 + 60.0*s3 - 30.0*s4;
+    double H1 = s - 6.0*s3 + 8.0*s4 - 3.0*s5,      D1 = 1.0 - 18.0*s2 + 32.0*s3 - 15.0*s4;
+    double H2 = 0.5*s2 - 1.5*s3 + 1.5*s4 - 0.5*s5, D2 = s - 4.5*s2 + 6.0*s3 - 2.5*s4;
+    double H3 = 1.0 - H0,                          D3 = -D0;
+    double H4 = -4.0*s3 + 7.0*s4 - 3.0*s5,         D4 = -12.0*s2 + 28.0*s3 - 15.0*s4;
+    double H5 = 0.5*s3 - s4 + 0.5*s5,              D5 = 1.5*s2 - 4.0*s3 + 2.5*s4;
+
+    for (int j=0; j<m; j++) {
+      y(j)   = H0*y_0(j) + dt*H1*yp_0(j) + dt*dt*H2*yp_0(m+j)
+             + H3*y_1(j) + dt*H4*yp_1(j) + dt*dt*H5*yp_1(m+j);
+      y(m+j) = ( D0*y_0(j) + dt*D1*yp_0(j) + dt*dt*D2*yp_0(m+j)
+               + D3*y_1(j) + dt*D4*yp_1(j) + dt*dt*D5*yp_1(m+j) ) / dt;
+    }
+  }
+  else {
+    double H00 = 2.0*s3 - 3.0*s2 + 1.0, H10 = s3 - 2.0*s2 + s;
+    double H01 = 3.0*s2 - 2.0*s3,       H11 = s3 - s2;
+
+    for (int j=0; j<n_eqn; j++)
+      y(j) = H00*y_0(j) + dt*H10*yp_0(j) + H01*y_1(j) + dt*H11*yp_1(j);
+  }
+};
+
+
+//------------------------------------------------------------------------------
+//
+// GJ8 class (implementation)
+//
+//------------------------------------------------------------------------------
+
+
+//
+// Constructor
+//
+
+GJ8::GJ8 (
+      RK4funct   f_,            // Differential equation
+      int        n_eqn_,        // Dimension (even)
+      void*      pAux_          // Pointer to auxiliary data
+      )
+: relerr(0.0), abserr(0.0), max_iter(0), t(0.0), nfev(0), nstep(0), niter(0),
+  f(f_), n_eqn(n_eqn_), pAux(pAux_), m(n_eqn_/2), h(0.0), i_0(0),
+  s(n_eqn_/2), S(n_eqn_/2), n_start(0),
+  y_tmp(n_eqn_), yp_tmp(n_eqn_), s_new(n_eqn_/2), S_new(n_eqn_/2)
+{
+  double l[9];
+
+  if (n_eqn%2!=0) {
+    std::cerr << "ERROR: Odd dimension in GJ8" << std::endl;
+    exit(1);
+  }
+
+  // Weights; the velocity predictor includes the term a(n+1)/2 of s(n+1)
+  GJ_Weights(a, b, l);
+  for (int k=0; k<9; k++) {
+    p[k]       = a[9][k] + 0.5*l[k];
+    acc[k]     = Vector(m);
+    y_start[k] = Vector(n_eqn);
+  }
+};
+
+
+//
+// Positions and velocities from the sums and the stencil acc[i_0..i_0+8]
+//
+
+double GJ8::Solve (const Vector& s_, const Vector& S_, const double wa[9],
+                   const double wb[9], Vector& y) const
+{
+  double err = 0.0;
+
+  for (int j=0; j<m; j++) {
+    double sa = 0.0, sb = 0.0;
+    for (int k=0; k<9; k++) {
+      double acc_k = acc[(i_0+k)%9](j);
+      sa += wa[k]*acc_k;
+      sb += wb[k]*acc_k;
+    }
+    double r = h*h*(S_(j)+sb);
+    double v = h*(s_(j)+sa);
+    err = max(err, fabs(r-y(j))  /(abserr+relerr*fabs(r)));
+    err = max(err, fabs(v-y(m+j))/(abserr+relerr*fabs(v)));
+    y(j) = r; y(m+j) = v;
+  }
+
+  return err;
+};
+
+
+//
+// Initialization and start-up
+//
+
+void GJ8::Init (double t0, const Vector& y0, double h_, double rel,
+                double abs)
+{
+  const int max_start = 20;   // Maximum number of start-up iterations
+
+  if (h_==0.0 || rel<0.0 || abs<=0.0) {
+    std::cerr << "ERROR: Invalid step size or accuracy in GJ8::Init"
+              << std::endl;
+    exit(1);
+  }
+
+  relerr = rel;
+  abserr = abs;
+  h      = h_;
+  t      = t0;
+  i_0    = 0;
+  nstep  = niter = 0;
+
+  // Solution at the first nine points from RKF78
+  RKF78 Start(f, n_eqn, pAux, true);
+
+  Start.Init(t0, y0, h, rel, abs);
+  y_start[0] = y0;
+  for (int n=1; n<9; n++) Start.Integ(t0+n*h, y_start[n]);
+  for (int n=0; n<9; n++) {
+    f( t0+n*h, y_start[n], yp_tmp, pAux );
+    for (int j=0; j<m; j++) acc[n](j) = yp_tmp(m+j);
+  }
+  nfev = Start.nfev + 9;
+
+  // Iteration of the corrector at the points 1..8 until the solution is
+  // consistent with the accelerations; the sums start from y0 at point 0.
+  // The last pass only forms the sums at point 8.
+  double err = 1.0e30;
+
+  for (int it=0; it<=max_start; it++) {
+
+    bool last = (err<=1.0 || it==max_start);
+
+    for (int j=0; j<m; j++) {
+      double sa = 0.0, sb = 0.0;
+      for (int k=0; k<9; k++) {
+        sa += a[0][k]*acc[k](j);
+        sb += b[0][k]*acc[k](j);
+      }
+      s(j) = y0(m+j)/h - sa;
+      S(j) = y0(j)/(h*h) - sb;
+    }
+
+    err = 0.0;
+    for (int n=1; n<9; n++) {
+      S += s + 0.5*acc[n-1];
+      s += 0.5*(acc[n-1]+acc[n]);
+      if (last) continue;
+      err = max(err, Solve(s, S, a[n], b[n], y_start[n]));
+      f( t0+n*h, y_start[n], yp_tmp, pAux );
+      for (int j=0; j<m; j++) acc[n](j) = yp_tmp(m+j);
+    }
+    if (last) break;
+    nfev += 8;
+  }
+
+  n_start = 8;
+};
+
+
+//
+// Integration step
+//
+
+void GJ8::Step (Vector& y)
+{
+  if (y.size()==0) y = Vector(n_eqn);
+
+  // Points of the start-up
+  if (n_start>0) {
+    y = y_start[9-n_start];
+    n_start--;
+    t = t + h;
+    nstep++;
+    return;
+  }
+
+  Vector& acc_n = acc[(i_0+8)%9];
+
+  // Predictor
+  S_new = S + s + 0.5*acc_n;
+  s_new = s + 0.5*acc_n;
+  Solve(s_new, S_new, p, b[9], y_tmp);
+
+  // Evaluation; the new acceleration replaces the oldest one
+  f( t+h, y_tmp, yp_tmp, pAux );
+  nfev++;
+  i_0 = (i_0+1)%9;
+  Vector& acc_1 = acc[(i_0+8)%9];
+  for (int j=0; j<m; j++) acc_1(j) = yp_tmp(m+j);
+
+  // Corrector; re-evaluation while the correction exceeds the tolerance
+  for (int it=0; ; it++) {
+    s_new = s + 0.5*(acc[(i_0+7)%9]+acc_1);
+    double err = Solve(s_new, S_new, a[8], b[8], y_tmp);
+    if (err<=1.0 || it>=max_iter) break;
+    f( t+h, y_tmp, yp_tmp, pAux );
+    nfev++;
+    niter++;
+    for (int j=0; j<m; j++) acc_1(j) = yp_tmp(m+j);
+  }
+
+  s = s_new;
+  S = S_new;
+  y = y_tmp;
+  t = t + h;
+  nstep++;
+};
+
+
 //------------------------------------------------------------------------------
 //
 // DE class (implementation)
@@ -114,6 +569,7 @@ DE::DE ()
   t          = 0.0;
   relerr     = 0.0;             // Accuracy requirements
   abserr     = 0.0;
+  nfev       = 0;               // Function evaluations
 };
 
 
@@ -141,6 +597,7 @@ DE::DE (
   t          = 0.0;
   relerr     = 0.0;             // Accuracy requirements
   abserr     = 0.0;
+  nfev       = 0;               // Function evaluations
 };
 
 
@@ -168,6 +625,7 @@ void DE::Define (
   t          = 0.0;
   relerr     = 0.0;             // Accuracy requirements
   abserr     = 0.0;
+  nfev       = 0;               // Function evaluations
 };
 
 
@@ -241,6 +699,7 @@ void DE::Step (double& x, Vector& y, double& eps, bool& crash)
   if (start) {
     // Initialize. Compute appropriate step size for first step. 
     f(x, y, yp, pAux);
+    nfev++;
     sum = 0.0;
     for (l=0;l<n_eqn;l++) {
       phi(l,1) = yp(l);
@@ -409,6 +868,7 @@ void DE::Step (double& x, Vector& y, double& eps, bool& crash)
     x = x + h;
     absh = fabs(h);
     f(x, p, yp, pAux);
+    nfev++;
   
     // Estimate errors at orders k, k-1, k-2 
     erkm2 = 0.0;
@@ -524,6 +984,7 @@ void DE::Step (double& x, Vector& y, double& eps, bool& crash)
     };
   
   f(x,y,yp,pAux);
+  nfev++;
 
   
   // Update differences for next step 
@@ -751,6 +1212,7 @@ void DE::Integ_ (
     if ( !PermitTOUT && ( fabs(tout-x) < fouru*fabs(x) ) ) {
       h = tout - x;
       f(x,yy,yp,pAux);              // Compute derivative yp(x)
+      nfev++;
       y = yy + h*yp;                // Extrapolate vector from x to tout
       State     = DE_DONE;          // Set return code
       t         = tout;             // Set independent variable
@@ -818,6 +1280,7 @@ void DE::Init (
   relerr = rel;
   abserr = abs;
   State  = DE_INIT;
+  nfev   = 0;
 };
 
 
@@ -6,14 +6,19 @@
 //
 //   Numerical integration methods for ordinaray differential equations
 // 
-//   This module provides implemenations of the 4th-order Runge-Kutta method
-//   and the variable order variable stepsize multistep method of Shampine &
-//   Gordon.
+//   This module provides implemenations of the 4th-order Runge-Kutta method,
+//   the Runge-Kutta-Fehlberg 7(8) method with step size control, the
+//   8th-order Gauss-Jackson method for second-order equations and the
+//   variable order variable stepsize multistep method of Shampine & Gordon.
 //
 // Reference:
 //
 //   Shampine, Gordon: "Computer solution of Ordinary Differential Equations",
 //   Freeman and Comp., San Francisco (1975).
+//   Fehlberg: "Classical fifth-, sixth-, seventh-, and eighth-order
+//   Runge-Kutta formulas with stepsize control", NASA TR R-287 (1968).
+//   Berry, Healy: "Implementation of Gauss-Jackson integration for orbit
+//   propagation", J. Astronaut. Sci. 52, 331-357 (2004).
 //
 // Last modified:
 //
@@ -58,10 +63,11 @@ class RK4
       int      n_eqn_,    // Dimension
       void*    pAux_      // Pointer to auxiliary data
       ) 
-    : f(f_), n_eqn(n_eqn_), pAux(pAux_)
-    { k_4=k_3=k_2=k_1=Vector(n_eqn_); };
+    : f(f_), n_eqn(n_eqn_), pAux(pAux_), 
+      k_1(n_eqn_), k_2(n_eqn_), k_3(n_eqn_), k_4(n_eqn_), y_tmp(n_eqn_)
+    {};
     
-    // Integration step
+    // Integration step (in place; stage vectors are allocated only once)
     void Step (         
       double&  t,         // Value of the independent variable; updated by t+h
       Vector&  y,         // Value of y(t); updated by y(t+h)
@@ -74,8 +80,166 @@ class RK4
     RK4funct  f;
     int       n_eqn;
     void*     pAux;
-    Vector    k_1,k_2,k_3,k_4;
+    Vector    k_1,k_2,k_3,k_4;  // Stage derivatives
+    Vector    y_tmp;            // Intermediate state
+
+};
+
+
+//------------------------------------------------------------------------------
+//
+// RKF78 class (specification)
+//
+//------------------------------------------------------------------------------
+
+// Runge-Kutta-Fehlberg 7(8) integrator with step size control and dense
+// output (the solution is advanced with the 8th-order formula). The step
+// size follows from the accuracy requirement only; solutions at the
+// requested output points are interpolated within the last step.
+
+class RKF78
+{
+  public:
+
+    // Elements
+
+    double       relerr;      // Desired relative accuracy of the solution
+    double       abserr;      // Desired absolute accuracy of the solution
+    double       h_max;       // Maximum step size (default = 0: unlimited)
+    double       t;           // Value of independent variable (end of the
+                              // last step)
+    long         nfev;        // Number of function evaluations
+    long         nstep;       // Number of accepted steps
+    long         nrej;        // Number of rejected steps
+
+    // Constructor
+    RKF78 (
+      RK4funct   f_,          // Differential equation
+      int        n_eqn_,      // Dimension
+      void*      pAux_,       // Pointer to auxiliary data
+      bool       SecondOrder_ = false  // y=(r,v) with y'=(v,a); enables
+    );                                  // quintic Hermite interpolation
+
+    // Initialization
+    void Init (
+      double         t0,      // Initial value of the independent variable
+      const Vector&  y0,      // Initial value y(t0)
+      double         h0,      // Initial step size (its sign gives the
+                              // direction of integration)
+      double         rel,     // Relative accuracy requirement
+      double         abs      // Absolute accuracy requirement
+    );
+
+    // Integration up to or past tout; the solution at tout is interpolated
+    // (output points must be passed in the direction of integration)
+    void Integ (
+      double     tout,        // Desired output point
+      Vector&    y            // Solution vector
+    );
+
+    // Interpolation within the last step
+    void Intrp (
+      double     tout,        // Desired output point
+      Vector&    y            // Solution vector
+    ) const;
+
+  private:
+
+    // Elements
+    RK4funct  f;
+    int       n_eqn;
+    void*     pAux;
+    bool      SecondOrder;
+    double    h;              // Step size for the next step
+    double    t_0;            // Start of the last step
+    Vector    y_0,yp_0;       // Solution and derivative at t_0
+    Vector    y_1,yp_1;       // Solution and derivative at t
+    Vector    k[13];          // Stage derivatives
+    Vector    y_tmp;          // Intermediate state
+
+    // Integration step with step size control
+    void Step ();
+};
+
+
+//------------------------------------------------------------------------------
+//
+// GJ8 class (specification)
+//
+//------------------------------------------------------------------------------
+
+// Gauss-Jackson 8th-order fixed-step integrator for second-order systems
+// y=(r,v) with y'=(v,a): summed Stoermer-Cowell formula for the positions
+// and summed Adams formula for the velocities. The accelerations of the
+// first nine points are started up with RKF78 and refined by iterating the
+// corrector. Each further step predicts, evaluates and corrects (PEC, one
+// evaluation of f). Optionally the acceleration is evaluated again at the
+// corrected state (PECE) while the correction of a component exceeds
+// abserr+relerr*|y|, at most max_iter times per step.
+
+class GJ8
+{
+  public:
+
+    // Elements
 
+    double       relerr;      // Relative tolerance of the corrector (and
+                              // accuracy of the RKF78 start-up)
+    double       abserr;      // Absolute tolerance of the corrector
+    int          max_iter;    // Maximum number of corrector re-evaluations
+                              // per step (default = 0: PEC only)
+    double       t;           // Value of independent variable
+    long         nfev;        // Number of function evaluations
+    long         nstep;       // Number of steps
+    long         niter;       // Number of corrector re-evaluations
+
+    // Constructor
+    GJ8 (
+      RK4funct   f_,          // Differential equation
+      int        n_eqn_,      // Dimension (even)
+      void*      pAux_        // Pointer to auxiliary data
+    );
+
+    // Initialization and start-up of the first eight steps
+    void Init (
+      double         t0,      // Initial value of the independent variable
+      const Vector&  y0,      // Initial value y(t0)
+      double         h_,      // Step size (its sign gives the direction of
+                              // integration)
+      double         rel,     // Relative accuracy requirement
+      double         abs      // Absolute accuracy requirement
+    );
+
+    // Integration step
+    void Step (
+      Vector&    y            // Solution y(t+h); t is updated by t+h
+    );
+
+  private:
+
+    // Elements
+    RK4funct  f;
+    int       n_eqn;
+    void*     pAux;
+    int       m;              // Number of positions (n_eqn/2)
+    double    h;              // Step size
+    double    a[10][9];       // Velocity (Adams) and position (Stoermer)
+    double    b[10][9];       // weights of the nine-point stencil at its
+    double    p[9];           // points 0..8 and for extrapolation (9);
+                              // p: velocity predictor incl. the sum term
+    Vector    acc[9];         // Accelerations of the last nine points
+    int       i_0;            // Index of the oldest acceleration in acc
+    Vector    s, S;           // First and second sums at t
+    Vector    y_start[9];     // Start-up solution
+    int       n_start;        // Number of start-up points still to return
+    Vector    y_tmp, yp_tmp;  // Intermediate state and derivative
+    Vector    s_new, S_new;   // Sums at t+h
+
+    // Positions and velocities from the sums and the weights w of the
+    // nine-point stencil acc[i_0..i_0+8]; returns the largest change of a
+    // component relative to the tolerance
+    double Solve (const Vector& s_, const Vector& S_, const double wa[9],
+                  const double wb[9], Vector& y) const;
 };
 
 
@@ -123,6 +287,7 @@ class DE
     bool         PermitTOUT;  // Flag for integrating past tout
                               // (default = true)
     double       t;           // Value of independent variable
+    long         nfev;        // Number of function evaluations (since Init)
 
     // Constructor
     DE ();                    // Default constructor
@@ -0,0 +1,514 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Density.cpp
+//
+// Purpose:
+//
+//   Atmospheric density models for the drag acceleration
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "SAT_Const.h"
+#include "SAT_Context.h"
+#include "SAT_Density.h"
+#include "SAT_Force.h"
+#include "SAT_RefSys.h"
+#include "APC_Sun.h"
+
+using std::cerr;
+using std::endl;
+
+namespace {
+
+// Greenwich apparent sidereal time [rad] as in Density_NRL
+
+double SiderealTime(const PropagationContext& Ctx, double Mjd_UTC)
+{
+  double Mjd_UT1 = Mjd_UTC + Ctx.UT1_UTC()/86400.0;
+  double Mjd_TT  = Mjd_UTC + Ctx.TT_UTC()/86400.0;
+
+  if (Ctx.Frames && Ctx.Frames->Covers(Mjd_TT))
+    return GMST(Mjd_UT1) + Ctx.Frames->EqE(Mjd_TT);
+  else
+    return GAST(Mjd_UT1, Mjd_TT);
+}
+
+// Height above the WGS-84 ellipsoid [m] to first order in the flattening
+// (at most 30 m below the geodetic height)
+
+double EllipsoidHeight(const Vec3& r)
+{
+  double r_abs = Norm(r);
+  double s     = r(2)/r_abs;              // Sine of geocentric latitude
+  return r_abs - R_Earth*(1.0-f_Earth*s*s);
+}
+
+// Weights of cubic Lagrange interpolation with nodes 0,1,2,3
+
+void Lagrange4(double x, double w[4])
+{
+  w[0] = -(x-1.0)*(x-2.0)*(x-3.0)/6.0;
+  w[1] =   x     *(x-2.0)*(x-3.0)/2.0;
+  w[2] =  -x     *(x-1.0)*(x-3.0)/2.0;
+  w[3] =   x     *(x-1.0)*(x-2.0)/6.0;
+}
+
+// First of four nodes around x (0<=i_0<=n-4) and weights
+
+int Stencil(double x, int n, double w[4])
+{
+  int i_0 = (int)floor(x) - 1;
+  if (i_0 < 0)   i_0 = 0;
+  if (i_0 > n-4) i_0 = n-4;
+  Lagrange4(x-i_0, w);
+  return i_0;
+}
+
+}
+
+//------------------------------------------------------------------------------
+//
+// DensityModel (class implementation)
+//
+//------------------------------------------------------------------------------
+
+double DensityModel::Density (PropagationContext& Ctx, double Mjd_UTC,
+                              const Vec3& r_ecef) const
+{
+  double dens;
+
+  Density(Ctx, Mjd_UTC, 1, &r_ecef, &dens);
+
+  return dens;
+}
+
+//------------------------------------------------------------------------------
+//
+// NrlmsiseDensity (class implementation)
+//
+//------------------------------------------------------------------------------
+
+void NrlmsiseDensity::Density (PropagationContext& Ctx, double Mjd_UTC, int n,
+                               const Vec3 r_ecef[], double dens[]) const
+{
+  Density_NRL(Ctx, Mjd_UTC, n, r_ecef, dens);
+}
+
+//------------------------------------------------------------------------------
+//
+// DensityTable (class implementation)
+//
+//------------------------------------------------------------------------------
+
+// Constructor
+
+DensityTable::DensityTable (double Mjd_UTC_0, double Mjd_UTC_1, double h_min,
+                            double h_max, double dh, double dlat, double dlst)
+  : h_0(h_min), dh_(dh)
+{
+  if (Mjd_UTC_1<Mjd_UTC_0 || dh<=0.0 || dlat<=0.0 || dlst<=0.0) {
+    cerr << "ERROR: Invalid interval or grid spacing in DensityTable" << endl;
+    exit(1);
+  }
+
+  n_h   = (int)floor((h_max-h_min)/dh + 0.5) + 1;
+  n_lat = (int)floor(180.0/dlat + 0.5) + 1;
+  n_lst = (int)floor(24.0/dlst + 0.5);
+  if (n_h<4 || n_lat<4 || n_lst<4) {
+    cerr << "ERROR: DensityTable requires at least 4 grid points per axis"
+         << endl;
+    exit(1);
+  }
+  h_1   = h_0 + (n_h-1)*dh_;
+  dlat_ = pi/(n_lat-1);
+  dlst_ = pi2/n_lst;
+
+  bin_0 = (long)floor(8.0*Mjd_UTC_0);
+  n_bin = (int)((long)floor(8.0*Mjd_UTC_1) - bin_0) + 1;
+  grid.reset(new Grid[n_bin]);
+}
+
+// Check whether an epoch lies inside the covered interval
+
+bool DensityTable::Covers (double Mjd_UTC) const
+{
+  long bin = (long)floor(8.0*Mjd_UTC);
+  return (bin>=bin_0 && bin<bin_0+n_bin);
+}
+
+// Log densities of interval i at its middle epoch; the grid points are
+// mapped to Earth-fixed positions and evaluated by Density_NRL
+
+void DensityTable::Build (int i, PropagationContext& Ctx) const
+{
+  const double Mjd_UTC = (bin_0+i+0.5)/8.0;
+  const int    N = n_lst*n_lat*n_h;
+
+  PropagationContext C(Ctx.eop, Ctx.spw);
+  std::vector<Vec3>   r(N);
+  std::vector<double> dens(N);
+  double gast;
+
+  C.Frames = Ctx.Frames;
+  C.Update(Mjd_UTC);
+  gast = SiderealTime(C, Mjd_UTC);
+
+  for (int k=0; k<n_lst; k++)
+    for (int j=0; j<n_lat; j++)
+      for (int l=0; l<n_h; l++)
+        r[(k*n_lat+j)*n_h+l] = Vec3( Geodetic(k*dlst_-gast, -pi/2+j*dlat_,
+                                              h_0+l*dh_).Position() );
+
+  Density_NRL(C, Mjd_UTC, N, &r[0], &dens[0]);
+
+  grid[i].ln_rho.resize(N);
+  for (int m=0; m<N; m++) grid[i].ln_rho[m] = log(dens[m]);
+}
+
+// Tricubic interpolation for grid coordinates x_lst, x_lat, x_h
+
+double DensityTable::Interp (const std::vector<double>& g, double x_lst,
+                             double x_lat, double x_h) const
+{
+  double w_lst[4], w_lat[4], w_h[4], sum = 0.0;
+  int    k_0, j_0, l_0;
+
+  k_0 = (int)floor(x_lst) - 1;         // Periodic in local solar time
+  Lagrange4(x_lst-k_0, w_lst);
+  j_0 = Stencil(x_lat, n_lat, w_lat);
+  l_0 = Stencil(x_h,   n_h,   w_h);
+
+  for (int a=0; a<4; a++) {
+    int k = (k_0+a+n_lst) % n_lst;
+    for (int b=0; b<4; b++) {
+      const double* p = &g[(k*n_lat+j_0+b)*n_h+l_0];
+      double w = w_lst[a]*w_lat[b];
+      sum += w*(w_h[0]*p[0]+w_h[1]*p[1]+w_h[2]*p[2]+w_h[3]*p[3]);
+    }
+  }
+  return sum;
+}
+
+// Densities [kg/m^3]
+
+void DensityTable::Density (PropagationContext& Ctx, double Mjd_UTC, int n,
+                            const Vec3 r_ecef[], double dens[]) const
+{
+  if (!Covers(Mjd_UTC)) {
+    Density_NRL(Ctx, Mjd_UTC, n, r_ecef, dens);
+    return;
+  }
+
+  const int i = (int)((long)floor(8.0*Mjd_UTC) - bin_0);
+  std::call_once(grid[i].once, &DensityTable::Build, this, i, std::ref(Ctx));
+  const std::vector<double>& g = grid[i].ln_rho;
+
+  double gast = SiderealTime(Ctx, Mjd_UTC);
+
+  for (int m=0; m<n; m++) {
+    Geodetic SAT(r_ecef[m]);
+
+    if (SAT.h < h_0) {
+      dens[m] = Density_NRL(Ctx, Mjd_UTC, r_ecef[m]);
+      continue;
+    }
+
+    double lst   = fmod(SAT.lon+gast, pi2);
+    if (lst < 0.0) lst += pi2;
+    double x_lst = lst/dlst_;
+    double x_lat = (SAT.lat+pi/2)/dlat_;
+
+    if (SAT.h <= h_1) {
+      dens[m] = exp(Interp(g, x_lst, x_lat, (SAT.h-h_0)/dh_));
+    }
+    else {
+      // Exponential decay with the scale height of the highest grid step
+      double f_1 = Interp(g, x_lst, x_lat, n_h-1.0);
+      double f_0 = Interp(g, x_lst, x_lat, n_h-2.0);
+      dens[m] = exp(f_1 + (SAT.h-h_1)/dh_*(f_1-f_0));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+//
+// HarrisPriesterDensity (class implementation)
+//
+//------------------------------------------------------------------------------
+
+HarrisPriesterDensity::HarrisPriesterDensity (int n_prm_)
+  : n_prm(n_prm_)
+{
+}
+
+void HarrisPriesterDensity::Density (PropagationContext& Ctx, double Mjd_UTC,
+                                     int n, const Vec3 r_ecef[],
+                                     double dens[]) const
+{
+  // Constants
+
+  const double upper_limit = 1000.0;           // Upper height limit [km]
+  const double lower_limit =  100.0;           // Lower height limit [km]
+  const double ra_lag      = 0.523599;         // Right ascension lag [rad]
+
+  // Harris-Priester atmospheric density model parameters
+  // Height [km], minimum density, maximum density [gm/km^3]
+
+  const int    N_Coef = 50;
+  static const double Data_h[N_Coef]= {
+    100.0, 120.0, 130.0, 140.0, 150.0, 160.0, 170.0, 180.0, 190.0, 200.0,
+    210.0, 220.0, 230.0, 240.0, 250.0, 260.0, 270.0, 280.0, 290.0, 300.0,
+    320.0, 340.0, 360.0, 380.0, 400.0, 420.0, 440.0, 460.0, 480.0, 500.0,
+    520.0, 540.0, 560.0, 580.0, 600.0, 620.0, 640.0, 660.0, 680.0, 700.0,
+    720.0, 740.0, 760.0, 780.0, 800.0, 840.0, 880.0, 920.0, 960.0,1000.0};
+  static const double Data_c_min[N_Coef] = {
+    4.974e+05, 2.490e+04, 8.377e+03, 3.899e+03, 2.122e+03, 1.263e+03,
+    8.008e+02, 5.283e+02, 3.617e+02, 2.557e+02, 1.839e+02, 1.341e+02,
+    9.949e+01, 7.488e+01, 5.709e+01, 4.403e+01, 3.430e+01, 2.697e+01,
+    2.139e+01, 1.708e+01, 1.099e+01, 7.214e+00, 4.824e+00, 3.274e+00,
+    2.249e+00, 1.558e+00, 1.091e+00, 7.701e-01, 5.474e-01, 3.916e-01,
+    2.819e-01, 2.042e-01, 1.488e-01, 1.092e-01, 8.070e-02, 6.012e-02,
+    4.519e-02, 3.430e-02, 2.632e-02, 2.043e-02, 1.607e-02, 1.281e-02,
+    1.036e-02, 8.496e-03, 7.069e-03, 4.680e-03, 3.200e-03, 2.210e-03,
+    1.560e-03, 1.150e-03                                            };
+  static const double Data_c_max[N_Coef] = {
+    4.974e+05, 2.490e+04, 8.710e+03, 4.059e+03, 2.215e+03, 1.344e+03,
+    8.758e+02, 6.010e+02, 4.297e+02, 3.162e+02, 2.396e+02, 1.853e+02,
+    1.455e+02, 1.157e+02, 9.308e+01, 7.555e+01, 6.182e+01, 5.095e+01,
+    4.226e+01, 3.526e+01, 2.511e+01, 1.819e+01, 1.337e+01, 9.955e+00,
+    7.492e+00, 5.684e+00, 4.355e+00, 3.362e+00, 2.612e+00, 2.042e+00,
+    1.605e+00, 1.267e+00, 1.005e+00, 7.997e-01, 6.390e-01, 5.123e-01,
+    4.121e-01, 3.325e-01, 2.691e-01, 2.185e-01, 1.779e-01, 1.452e-01,
+    1.190e-01, 9.776e-02, 8.059e-02, 5.741e-02, 4.210e-02, 3.130e-02,
+    2.360e-02, 1.810e-02                                            };
+
+
+  // Variables
+
+  int    ih;                              // Section index
+  double d_c, d_s, c_psi2;                // Apex direction; cos^2(psi/2)
+  double ra_Sun, dec_Sun, lon_apex;       // Sun and apex of the bulge [rad]
+  double height, h_min, h_max, d_min, d_max;
+  double Mjd_UT1, Mjd_TT;
+  Mat3   Ecl;
+  Vec3   r_Sun, u;
+
+
+  // Right ascension and declination of the Sun (mean equator of date)
+  Mjd_UT1 = Mjd_UTC + Ctx.UT1_UTC()/86400.0;
+  Mjd_TT  = Mjd_UTC + Ctx.TT_UTC()/86400.0;
+  EclMatrix(Mjd_TT, Ecl);
+  r_Sun   = Transp(Ecl)*Vec3(SunPos((Mjd_TT-MJD_J2000)/36525.0));
+
+  ra_Sun  = atan2( r_Sun(1), r_Sun(0) );
+  dec_Sun = atan2( r_Sun(2), sqrt( r_Sun(0)*r_Sun(0)+r_Sun(1)*r_Sun(1) ) );
+
+  // Unit vector u towards the apex of the diurnal bulge in the Earth-fixed
+  // system (Earth rotation by GMST)
+  lon_apex = ra_Sun + ra_lag - GMST(Mjd_UT1);
+  d_c      = cos(dec_Sun);
+  d_s      = sin(dec_Sun);
+  u        = Vec3( d_c*cos(lon_apex), d_c*sin(lon_apex), d_s );
+
+  for (int m=0; m<n; m++) {
+
+    // Satellite height [km]
+    height = EllipsoidHeight(r_ecef[m])/1000.0;
+
+    // Exit with zero density outside height model limits
+    if ( height >= upper_limit || height <= lower_limit ) {
+      dens[m] = 0.0;
+      continue;
+    }
+
+    // Cosine of half angle between satellite position vector and
+    // apex of diurnal bulge
+    c_psi2 = 0.5 + 0.5*Dot(r_ecef[m],u)/Norm(r_ecef[m]);
+
+    // Height index search and exponential density interpolation
+    ih = 0;                               // section index reset
+    for (int i=0; i<N_Coef-1; i++)        // loop over N_Coef height regimes
+      if ( height >= Data_h[i] && height < Data_h[i+1] ) {
+        ih = i;                           // ih identifies height section
+        break;
+      }
+
+    h_min = ( Data_h[ih] - Data_h[ih+1] )/log( Data_c_min[ih+1]/Data_c_min[ih] );
+    h_max = ( Data_h[ih] - Data_h[ih+1] )/log( Data_c_max[ih+1]/Data_c_max[ih] );
+
+    d_min = Data_c_min[ih] * exp( (Data_h[ih]-height)/h_min );
+    d_max = Data_c_max[ih] * exp( (Data_h[ih]-height)/h_max );
+
+    // Density computation
+    dens[m] = ( d_min + (d_max-d_min)*pow(c_psi2,n_prm) ) * 1.0e-12;  // [kg/m^3]
+  }
+}
+
+//------------------------------------------------------------------------------
+//
+// ExponentialDensity (class implementation)
+//
+//------------------------------------------------------------------------------
+
+void ExponentialDensity::Density (PropagationContext&, double,
+                                  int n, const Vec3 r_ecef[],
+                                  double dens[]) const
+{
+  // Base altitude [km], nominal density [kg/m^3] and scale height [km]
+
+  const int    N_Layer = 28;
+  static const double h_0[N_Layer] = {
+       0.0,   25.0,   30.0,   40.0,   50.0,   60.0,   70.0,   80.0,
+      90.0,  100.0,  110.0,  120.0,  130.0,  140.0,  150.0,  180.0,
+     200.0,  250.0,  300.0,  350.0,  400.0,  450.0,  500.0,  600.0,
+     700.0,  800.0,  900.0, 1000.0                                  };
+  static const double rho_0[N_Layer] = {
+    1.225e+00, 3.899e-02, 1.774e-02, 3.972e-03, 1.057e-03, 3.206e-04,
+    8.770e-05, 1.905e-05, 3.396e-06, 5.297e-07, 9.661e-08, 2.438e-08,
+    8.484e-09, 3.845e-09, 2.070e-09, 5.464e-10, 2.789e-10, 7.248e-11,
+    2.418e-11, 9.518e-12, 3.725e-12, 1.585e-12, 6.967e-13, 1.454e-13,
+    3.614e-14, 1.170e-14, 5.245e-15, 3.019e-15                      };
+  static const double H[N_Layer] = {
+       7.249,    6.349,    6.682,    7.554,    8.382,    7.714,
+       6.549,    5.799,    5.382,    5.877,    7.263,    9.473,
+      12.636,   16.149,   22.523,   29.740,   37.105,   45.546,
+      53.628,   53.298,   58.515,   60.828,   63.822,   71.835,
+      88.667,  124.640,  181.050,  268.000                         };
+
+  double height;
+  int    i;
+
+  for (int m=0; m<n; m++) {
+
+    // Ellipsoidal height [km]
+    height = EllipsoidHeight(r_ecef[m])/1000.0;
+    if (height < 0.0) height = 0.0;
+
+    // Layer containing the height (binary search)
+    int lo = 0, hi = N_Layer-1;
+    while (lo < hi) {
+      i = (lo+hi+1)/2;
+      if (h_0[i] <= height) lo = i; else hi = i-1;
+    }
+    i = lo;
+
+    dens[m] = rho_0[i]*exp(-(height-h_0[i])/H[i]);   // [kg/m^3]
+  }
+}
+
+//------------------------------------------------------------------------------
+//
+// ParseDensityModel, NewDensityModel
+//
+// Purpose:
+//
+//   Selection of the density model by name and creation of the model
+//
+//------------------------------------------------------------------------------
+bool ParseDensityModel (const std::string& name, DENSITY_MODEL& model)
+{
+  if      (name == "none")  model = DENS_NONE;
+  else if (name == "nrl")   model = DENS_NRL;
+  else if (name == "table") model = DENS_TABLE;
+  else if (name == "hp")    model = DENS_HP;
+  else if (name == "exp")   model = DENS_EXP;
+  else return false;
+  return true;
+}
+
+DensityModel* NewDensityModel (DENSITY_MODEL model, double Mjd_UTC_0,
+                               double Mjd_UTC_1)
+{
+  switch (model) {
+    case DENS_NRL:   return new NrlmsiseDensity;
+    case DENS_TABLE: return new DensityTable(Mjd_UTC_0, Mjd_UTC_1);
+    case DENS_HP:    return new HarrisPriesterDensity;
+    case DENS_EXP:   return new ExponentialDensity;
+    default:         return 0;
+  }
+}
+
+//------------------------------------------------------------------------------
+//
+// CheckDensityModel
+//
+// Purpose:
+//
+//   Compares a density model with the direct evaluation of NRLMSISE-00
+//
+//------------------------------------------------------------------------------
+void CheckDensityModel (const DensityModel& Model, double Mjd_UTC, double Days,
+                        int n_epoch, int n_pts, std::ostream& out)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  PropagationContext  Ctx, Ctx_NRL;
+  std::mt19937        gen(20241205);
+  std::uniform_real_distribution<double> U(0.0,1.0);
+  std::vector<Vec3>   r(n_pts);
+  std::vector<double> d_ref(n_pts), d(n_pts);
+  double t_ref = 0.0, t_first = 0.0, t_model = 0.0;
+  double sum = 0.0, sum2 = 0.0, e_max = 0.0;
+  long   n_tot = 0;
+
+  for (int i=0; i<n_epoch; i++) {
+    double Mjd = Mjd_UTC + (n_epoch>1 ? Days*i/(n_epoch-1) : 0.0);
+
+    // Random positions with uniform distribution on the sphere
+    for (int m=0; m<n_pts; m++) {
+      double lon = pi2*U(gen);
+      double lat = asin(2.0*U(gen)-1.0);
+      double h   = 150.0e3 + 850.0e3*U(gen);
+      r[m] = Vec3( Geodetic(lon, lat, h).Position() );
+    }
+
+    Ctx.Update(Mjd);
+    Ctx_NRL.Update(Mjd);
+
+    Clock::time_point t_0 = Clock::now();
+    Density_NRL(Ctx_NRL, Mjd, n_pts, &r[0], &d_ref[0]);
+    Clock::time_point t_1 = Clock::now();
+    Model.Density(Ctx, Mjd, n_pts, &r[0], &d[0]);    // Includes set-up
+    Clock::time_point t_2 = Clock::now();
+    Model.Density(Ctx, Mjd, n_pts, &r[0], &d[0]);
+    Clock::time_point t_3 = Clock::now();
+
+    t_ref   += std::chrono::duration<double>(t_1-t_0).count();
+    t_first += std::chrono::duration<double>(t_2-t_1).count();
+    t_model += std::chrono::duration<double>(t_3-t_2).count();
+
+    for (int m=0; m<n_pts; m++) {
+      double e = d[m]/d_ref[m] - 1.0;
+      sum  += e;
+      sum2 += e*e;
+      if (fabs(e) > e_max) e_max = fabs(e);
+      n_tot++;
+    }
+  }
+
+  if (n_tot == 0) return;
+
+  out << std::fixed << std::setprecision(3)
+      << "  Relative density error (" << n_tot << " points)" << endl
+      << "    mean " << std::setw(9) << 100.0*sum/n_tot << " %" << endl
+      << "    rms  " << std::setw(9) << 100.0*sqrt(sum2/n_tot) << " %" << endl
+      << "    max  " << std::setw(9) << 100.0*e_max << " %" << endl
+      << "  Evaluation time per point" << endl
+      << "    NRLMSISE-00         " << std::setw(9) << 1.0e6*t_ref/n_tot
+      << " us" << endl
+      << "    Model (first call)  " << std::setw(9) << 1.0e6*t_first/n_tot
+      << " us" << endl
+      << "    Model               " << std::setw(9) << 1.0e6*t_model/n_tot
+      << " us" << endl
+      << "    Speed-up            " << std::setw(9)
+      << (t_model>0.0 ? t_ref/t_model : 0.0) << endl;
+}
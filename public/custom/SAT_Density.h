@@ -0,0 +1,249 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Density.h
+//
+// Purpose:
+//
+//   Atmospheric density models for the drag acceleration
+//
+// Notes:
+//
+//   AccelDrag obtains the density from the model referenced by the
+//   propagation context (PropagationContext::Atmosphere) or, if none is
+//   set, from Density_NRL. The Harris-Priester and exponential models
+//   depend on altitude (and the direction to the Sun) only and are meant
+//   for quick-look propagations; they are 50 to 150 times faster than
+//   NRLMSISE-00 but ignore the actual solar and geomagnetic activity.
+//   DensityTable replaces the evaluation of
+//   NRLMSISE-00 by the interpolation of a grid over altitude, latitude and
+//   local solar time. The grid of each 3-hour space weather interval is
+//   computed on first use (std::call_once), so that one table may be
+//   shared by all satellites and threads of a propagation. With the
+//   default grid (10 km, 10 deg, 1 h) the interpolation error is about
+//   1% rms; CheckDensityModel reports error and speed for a given epoch.
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifndef INC_SAT_DENSITY_H
+#define INC_SAT_DENSITY_H
+
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SAT_VecMat.h"
+
+class PropagationContext;
+
+
+// Atmospheric density models
+
+enum DENSITY_MODEL {
+  DENS_NONE  = 0,    // No atmospheric drag
+  DENS_NRL   = 1,    // NRLMSISE-00
+  DENS_TABLE = 2,    // Interpolated NRLMSISE-00 grids
+  DENS_HP    = 3,    // Harris-Priester
+  DENS_EXP   = 4     // Piecewise exponential
+};
+
+//------------------------------------------------------------------------------
+//
+// DensityModel (class definition)
+//
+// Purpose:
+//
+//   Interface of the atmospheric density models
+//
+//------------------------------------------------------------------------------
+class DensityModel
+{
+  public:
+
+    virtual ~DensityModel () {};
+
+    // Densities dens[0..n-1] [kg/m^3] at the positions r_ecef[0..n-1] in
+    // the Earth-fixed system [m]; Ctx is updated for Mjd_UTC
+    virtual void Density (PropagationContext& Ctx, double Mjd_UTC, int n,
+                          const Vec3 r_ecef[], double dens[]) const = 0;
+
+    // Density [kg/m^3] of a single position
+    double Density (PropagationContext& Ctx, double Mjd_UTC,
+                    const Vec3& r_ecef) const;
+};
+
+//------------------------------------------------------------------------------
+//
+// NrlmsiseDensity (class definition)
+//
+// Purpose:
+//
+//   Direct evaluation of NRLMSISE-00 (Density_NRL)
+//
+//------------------------------------------------------------------------------
+class NrlmsiseDensity : public DensityModel
+{
+  public:
+
+    virtual void Density (PropagationContext& Ctx, double Mjd_UTC, int n,
+                          const Vec3 r_ecef[], double dens[]) const;
+    using DensityModel::Density;
+};
+
+//------------------------------------------------------------------------------
+//
+// DensityTable (class definition)
+//
+// Purpose:
+//
+//   NRLMSISE-00 densities interpolated from precomputed grids
+//
+// Notes:
+//
+//   Each 3-hour interval of the space weather data has its own grid of
+//   log densities, which is evaluated at the middle of the interval and
+//   interpolated by tricubic Lagrange polynomials (periodic in local solar
+//   time). The longitude of a grid point follows from its local solar time,
+//   so that the UT and longitude terms of the model are only approximated.
+//   Above the highest altitude the log density is extrapolated linearly;
+//   positions below the lowest altitude and epochs outside the covered
+//   interval are passed to Density_NRL.
+//
+//------------------------------------------------------------------------------
+class DensityTable : public DensityModel
+{
+  public:
+
+    // Constructor
+    DensityTable (
+      double Mjd_UTC_0,          // Start of the covered interval (UTC)
+      double Mjd_UTC_1,          // End of the covered interval (UTC)
+      double h_min = 100.0e3,    // Lowest altitude [m]
+      double h_max = 1000.0e3,   // Highest altitude [m]
+      double dh    = 10.0e3,     // Altitude step [m]
+      double dlat  = 10.0,       // Latitude step [deg]
+      double dlst  = 1.0         // Local solar time step [h]
+    );
+
+    // Check whether an epoch lies inside the covered interval
+    bool Covers (double Mjd_UTC) const;
+
+    virtual void Density (PropagationContext& Ctx, double Mjd_UTC, int n,
+                          const Vec3 r_ecef[], double dens[]) const;
+    using DensityModel::Density;
+
+  private:
+
+    struct Grid {
+      std::once_flag      once;
+      std::vector<double> ln_rho;             // n_lst x n_lat x n_h values
+    };
+
+    void   Build  (int i, PropagationContext& Ctx) const;  // Grid of interval i
+    double Interp (const std::vector<double>& g, double x_lst, double x_lat,
+                   double x_h) const;
+
+    long                    bin_0;            // First 3-hour interval
+    int                     n_bin;            // Number of intervals
+    double                  h_0, h_1, dh_;    // Altitude range and step [m]
+    double                  dlat_, dlst_;     // Steps [rad]
+    int                     n_h, n_lat, n_lst;
+    std::unique_ptr<Grid[]> grid;             // Grids (filled on first use)
+
+    DensityTable (const DensityTable&);
+    DensityTable& operator= (const DensityTable&);
+};
+
+//------------------------------------------------------------------------------
+//
+// HarrisPriesterDensity (class definition)
+//
+// Purpose:
+//
+//   Modified Harris-Priester model (100 to 1000 km) with the diurnal
+//   density bulge lagging the Sun by 30 deg in right ascension
+//
+//------------------------------------------------------------------------------
+class HarrisPriesterDensity : public DensityModel
+{
+  public:
+
+    // Constructor
+    HarrisPriesterDensity (
+      int n_prm = 3              // Exponent of the bulge term; 2 (6) for
+    );                           // low (high) inclination orbits
+
+    virtual void Density (PropagationContext& Ctx, double Mjd_UTC, int n,
+                          const Vec3 r_ecef[], double dens[]) const;
+    using DensityModel::Density;
+
+  private:
+
+    int n_prm;
+};
+
+//------------------------------------------------------------------------------
+//
+// ExponentialDensity (class definition)
+//
+// Purpose:
+//
+//   Piecewise exponential model of the mean atmosphere (Vallado, Table 8-4;
+//   the last layer is extended beyond 1000 km)
+//
+//------------------------------------------------------------------------------
+class ExponentialDensity : public DensityModel
+{
+  public:
+
+    virtual void Density (PropagationContext& Ctx, double Mjd_UTC, int n,
+                          const Vec3 r_ecef[], double dens[]) const;
+    using DensityModel::Density;
+};
+
+//------------------------------------------------------------------------------
+//
+// ParseDensityModel, NewDensityModel
+//
+// Purpose:
+//
+//   Selection of the density model by name and creation of the model
+//
+// Input/Output:
+//
+//   name        "none", "nrl", "table", "hp" or "exp"
+//   model       Density model
+//   Mjd_UTC_0   Start of the propagation interval (UTC)
+//   Mjd_UTC_1   End of the propagation interval (UTC)
+//   <return>    false for an unknown name; new model (0 for DENS_NONE)
+//
+//------------------------------------------------------------------------------
+bool          ParseDensityModel (const std::string& name, DENSITY_MODEL& model);
+DensityModel* NewDensityModel   (DENSITY_MODEL model, double Mjd_UTC_0,
+                                 double Mjd_UTC_1);
+
+//------------------------------------------------------------------------------
+//
+// CheckDensityModel
+//
+// Purpose:
+//
+//   Compares a density model with the direct evaluation of NRLMSISE-00
+//
+// Input/Output:
+//
+//   Model       Density model
+//   Mjd_UTC     Start epoch (UTC)
+//   Days        Length of the tested interval [d]
+//   n_epoch     Number of test epochs
+//   n_pts       Number of random positions (150 to 1000 km) per epoch
+//   out         Report of the relative density errors and evaluation times
+//
+//------------------------------------------------------------------------------
+void CheckDensityModel (const DensityModel& Model, double Mjd_UTC, double Days,
+                        int n_epoch, int n_pts, std::ostream& out);
+
+#endif  // include-Blocker
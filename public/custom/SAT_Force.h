@@ -15,8 +15,11 @@
 //
 //------------------------------------------------------------------------------
 
+#include "SAT_Gravity.h"
 #include "SAT_VecMat.h"
 
+class PropagationContext;
+
 //--------------------------------------------------------------------------
 // Inputs:
 // n         maximum degree
@@ -41,6 +44,10 @@ Matrix Legendre(int n,int m,double fi);
 //--------------------------------------------------------------------------
 Matrix LegendreP(int n,int m,double fi);
 
+// Fixed-size (Vec3/Mat3) overloads of the force model functions below keep
+// all 3-vectors and rotation matrices on the stack and are used by the 
+// propagator's Accel(); the Vector/Matrix versions forward to them.
+
 //------------------------------------------------------------------------------
 //
 // AccelHarmonic
@@ -64,6 +71,8 @@ Matrix LegendreP(int n,int m,double fi);
 //------------------------------------------------------------------------------
 Vector AccelHarmonic (const Vector& r, const Matrix& E, double GM, double R_ref,
                       const Matrix& cnm, const Matrix& snm, int n_max, int m_max );
+Vec3   AccelHarmonic (const Vec3& r, const Mat3& E, double GM, double R_ref,
+                      const Matrix& cnm, const Matrix& snm, int n_max, int m_max );
 
 //------------------------------------------------------------------------------
 //
@@ -89,6 +98,11 @@ Vector AccelHarmonic (const Vector& r, const Matrix& E, double GM, double R_ref,
 //   m_max       Maximum order (m_max<=n_max; m_max=0 for zonals, only)
 //   xp          x_pole [arc seconds]
 //   yp          y_pole [arc seconds]
+//   Ctx         Propagation context updated for Mjd_UTC (provides the time
+//               differences and pole coordinates instead of xp, yp); the
+//               version with HarmonicGravity caches the tidal corrections
+//               in Ctx and adds them to the coefficients during summation
+//   Gravity     Harmonic gravity field (replaces GM,R_ref,cnm,snm,n_max,m_max)
 //   <return>    Acceleration (a=d^2r/dt^2)
 //
 //------------------------------------------------------------------------------
@@ -96,6 +110,44 @@ Vector AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vector& r, const Vecto
                      const Vector& r_Moon, const Matrix& E, double GM, double R_ref,
                      const Matrix& cnm, const Matrix& snm, int n_max, int m_max,
                      double xp, double yp, bool SolidEarthTides, bool OceanTides);
+Vec3   AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vec3& r, const Vec3& r_Sun,
+                     const Vec3& r_Moon, const Mat3& E, double GM, double R_ref,
+                     const Matrix& cnm, const Matrix& snm, int n_max, int m_max,
+                     double xp, double yp, bool SolidEarthTides, bool OceanTides);
+Vec3   AccelHarmonic_AnelasticEarth(const PropagationContext& Ctx, double Mjd_UTC,
+                     const Vec3& r, const Vec3& r_Sun, const Vec3& r_Moon,
+                     const Mat3& E, double GM, double R_ref,
+                     const Matrix& cnm, const Matrix& snm, int n_max, int m_max,
+                     bool SolidEarthTides, bool OceanTides);
+Vec3   AccelHarmonic_AnelasticEarth(PropagationContext& Ctx, double Mjd_UTC,
+                     const Vec3& r, const Vec3& r_Sun, const Vec3& r_Moon,
+                     const Mat3& E, const HarmonicGravity& Gravity,
+                     bool SolidEarthTides, bool OceanTides);
+
+//------------------------------------------------------------------------------
+//
+// TideCorrections
+//
+// Purpose:
+//
+//   Corrections of the normalized harmonic coefficients (n<=6) due to
+//   solid Earth tides, the permanent tide, the solid Earth pole tide and
+//   ocean tides (IERS Conventions 2010)
+//
+// Input/Output:
+//
+//   Ctx         Propagation context updated for Mjd_UTC
+//   Mjd_UTC     Modified Julian Date (UTC)
+//   r_Sun       Geocentric equatorial position of the Sun [m] (EME2000)
+//   r_Moon      Geocentric equatorial position of the Moon [m] (EME2000)
+//   GM          Gravitational coefficient
+//   R_ref       Reference radius
+//   Delta       Coefficient corrections
+//
+//------------------------------------------------------------------------------
+void   TideCorrections(const PropagationContext& Ctx, double Mjd_UTC,
+                     const Vec3& r_Sun, const Vec3& r_Moon, double GM, double R_ref,
+                     bool SolidEarthTides, bool OceanTides, TideDelta& Delta);
 
 //------------------------------------------------------------------------------
 //
@@ -114,6 +166,7 @@ Vector AccelHarmonic_AnelasticEarth(double Mjd_UTC, const Vector& r, const Vecto
 //
 //------------------------------------------------------------------------------
 Vector AccelPointMass (const Vector& r, const Vector& s, double GM);
+Vec3   AccelPointMass (const Vec3& r, const Vec3& s, double GM);
 
 //------------------------------------------------------------------------------
 // 
@@ -134,6 +187,7 @@ Vector AccelPointMass (const Vector& r, const Vector& s, double GM);
 //
 //------------------------------------------------------------------------------
 double Illumination ( const Vector& r, const Vector& r_Sun );
+double Illumination ( const Vec3& r, const Vec3& r_Sun );
 
 //------------------------------------------------------------------------------
 //
@@ -164,6 +218,9 @@ double Illumination ( const Vector& r, const Vector& r_Sun );
 Vector AccelSolrad (const Vector& r, const Vector& r_Sun,
                     double Area, double mass, double CR,
                     double P0, double AU );
+Vec3   AccelSolrad (const Vec3& r, const Vec3& r_Sun,
+                    double Area, double mass, double CR,
+                    double P0, double AU );
 
 //------------------------------------------------------------------------------
 //
@@ -182,11 +239,20 @@ Vector AccelSolrad (const Vector& r, const Vector& r_Sun,
 //   Area        Cross-section [m^2]
 //   mass        Spacecraft mass [kg]
 //   CD          Drag coefficient
+//   Ctx         Propagation context updated for Mjd_UTC (optional)
+//   dens        Atmospheric density [kg/m^3] (replaces Mjd_TT, E and Ctx)
 //   <return>    Acceleration (a=d^2r/dt^2) [m/s^2]
 //
 //------------------------------------------------------------------------------
 Vector AccelDrag ( double Mjd_TT, const Vector& r, const Vector& v, const Matrix& T,
                    const Matrix& E, double Area, double mass, double CD );
+Vec3   AccelDrag ( double Mjd_TT, const Vec3& r, const Vec3& v, const Mat3& T,
+                   const Mat3& E, double Area, double mass, double CD );
+Vec3   AccelDrag ( PropagationContext& Ctx, double Mjd_UTC, const Vec3& r,
+                   const Vec3& v, const Mat3& T, const Mat3& E, double Area,
+                   double mass, double CD );
+Vec3   AccelDrag ( double dens, const Vec3& r, const Vec3& v, const Mat3& T,
+                   double Area, double mass, double CD );
 
 //------------------------------------------------------------------------------
 //
@@ -200,10 +266,20 @@ Vector AccelDrag ( double Mjd_TT, const Vector& r, const Vector& v, const Matrix
 //
 //   Mjd_TT      Terrestrial Time (Modified Julian Date)
 //   r_ecef      Satellite position vector in the Earth-fixed system [m]
+//   Ctx         Propagation context updated for Mjd_UTC (optional); holds
+//               the space weather data of the last call and the model
+//               workspace
 //   <return>    Density [kg/m^3]
 //
+//   The batch version evaluates the densities dens[0..n-1] of n positions
+//   r_ecef[0..n-1] at a common epoch.
+//
 //---------------------------------------------------------------------------
 double Density_NRL( double Mjd_TT, const Vector& r_ecef );
+double Density_NRL( double Mjd_TT, const Vec3& r_ecef );
+double Density_NRL( PropagationContext& Ctx, double Mjd_UTC, const Vec3& r_ecef );
+void   Density_NRL( PropagationContext& Ctx, double Mjd_UTC, int n,
+                    const Vec3 r_ecef[], double dens[] );
 
 //--------------------------------------------------------------------------
 //
@@ -219,4 +295,5 @@ double Density_NRL( double Mjd_TT, const Vector& r_ecef );
 //
 //--------------------------------------------------------------------------
 Vector Relativity( const Vector& r, const Vector& v );
+Vec3   Relativity( const Vec3& r, const Vec3& v );
 
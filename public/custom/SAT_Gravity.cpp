@@ -0,0 +1,365 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Gravity.cpp
+//
+// Purpose:
+//
+//   Harmonic gravity field of the Earth evaluated by the Cunningham
+//   recursion of normalized V/W functions
+//
+// Notes:
+//
+//   With the normalization factors
+//
+//     Nb(n,m) = sqrt( (2-delta_0m)*(2n+1)*(n-m)!/(n+m)! )
+//
+//   the normalized functions Vb=Nb*V, Wb=Nb*W obey the recursions
+//
+//     Vb(m,m) = d(m) * ( x0*Vb(m-1,m-1) - y0*Wb(m-1,m-1) )
+//     Wb(m,m) = d(m) * ( x0*Wb(m-1,m-1) + y0*Vb(m-1,m-1) )
+//     Vb(n,m) = a(n,m)*z0*Vb(n-1,m) - b(n,m)*rho*Vb(n-2,m)
+//
+//   with x0=R_ref*x/r^2, y0=R_ref*y/r^2, z0=R_ref*z/r^2, rho=R_ref^2/r^2
+//   and the factors a, b, d given in the constructor. The acceleration
+//   terms of the unnormalized formulation (Montenbruck & Gill, Eq. 3.33)
+//   are converted by the ratios Nb(n,m)/Nb(n+1,k), k=m-1,m,m+1.
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <fstream>
+#include <iostream>
+
+#include "SAT_Gravity.h"
+#include "SAT_MappedFile.h"
+
+using std::cerr;
+using std::endl;
+
+//------------------------------------------------------------------------------
+//
+// GravityField (class implementation)
+//
+//------------------------------------------------------------------------------
+
+// Constructor
+
+GravityField::GravityField (int n_max, double GM_, double R_ref_)
+  : N(n_max), gm(GM_), r_ref(R_ref_)
+{
+  if (n_max<0) {
+    cerr << "ERROR: Negative degree in GravityField" << endl;
+    exit(1);
+  }
+
+  buf.assign(2*Index(N+1,0)+8, 0.0);
+  w  = reinterpret_cast<double*>(
+         (reinterpret_cast<uintptr_t>(&buf[0])+63) & ~uintptr_t(63) );
+  cs = w;
+}
+
+GravityField::GravityField (GravityField&& F)
+  : N(F.N), gm(F.gm), r_ref(F.r_ref), buf(std::move(F.buf)),
+    map(std::move(F.map)), w(F.w), cs(F.cs)
+{
+  F.w = 0; F.cs = 0;
+}
+
+GravityField& GravityField::operator= (GravityField&& F)
+{
+  if (this!=&F) {
+    N = F.N; gm = F.gm; r_ref = F.r_ref;
+    buf = std::move(F.buf);
+    map = std::move(F.map);
+    w   = F.w;  F.w  = 0;
+    cs  = F.cs; F.cs = 0;
+  }
+  return *this;
+}
+
+// Coefficients
+
+void GravityField::Set (int n, int m, double C_nm, double S_nm)
+{
+  if (n<0 || n>N || m<0 || m>n) {
+    cerr << "ERROR: Invalid degree/order in GravityField::Set" << endl;
+    exit(1);
+  }
+  if (!w) {
+    cerr << "ERROR: GravityField::Set on a mapped gravity model" << endl;
+    exit(1);
+  }
+  w[2*Index(n,m)]   = C_nm;
+  w[2*Index(n,m)+1] = S_nm;
+}
+
+// Truncated field
+
+GravityFieldView GravityField::Truncate (int n, int m) const
+{
+  if (n<0 || n>N || m<0 || m>n) {
+    cerr << "ERROR: Invalid truncation of GravityField" << endl;
+    exit(1);
+  }
+  return GravityFieldView(*this, n, m);
+}
+
+//------------------------------------------------------------------------------
+//
+// Gravity model files
+//
+//------------------------------------------------------------------------------
+
+namespace {
+
+  const char     GravityMagic[8]  = { 'H','P','O','P','G','R','A','V' };
+  const uint32_t GravityVersion   = 1;
+  const uint32_t GravityEndian    = 0x01020304;
+
+  struct GravityHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t endian;
+    int32_t  n_max;
+    int32_t  reserved_0;
+    double   GM, R_ref;
+    uint64_t data_offset;
+    uint64_t data_count;
+    uint64_t reserved_1;
+  };
+
+  static_assert(sizeof(GravityHeader)==64, "Unexpected gravity header size");
+
+}
+
+bool ReadGravityText (const std::string& path, int n_max, double GM,
+                      double R_ref, GravityField& Field)
+{
+  std::ifstream inp(path.c_str());
+  int           n, m;
+  double        C_nm, S_nm, sigma_C, sigma_S;
+
+  if (!inp.is_open()) return false;
+
+  GravityField F(n_max, GM, R_ref);
+
+  for (int i=0; i<GravityField::Index(n_max+1,0); i++) {
+    if (!(inp >> n >> m >> C_nm >> S_nm >> sigma_C >> sigma_S)) return false;
+    if (n<=n_max && m<=n) F.Set(n, m, C_nm, S_nm);
+  }
+
+  Field = std::move(F);
+  return true;
+}
+
+bool WriteGravityBinary (const std::string& path, const GravityField& Field)
+{
+  std::ofstream out(path.c_str(), std::ios::binary);
+  GravityHeader H;
+
+  if (!out.is_open()) return false;
+
+  memset(&H, 0, sizeof(H));
+  memcpy(H.magic, GravityMagic, sizeof(H.magic));
+  H.version     = GravityVersion;
+  H.endian      = GravityEndian;
+  H.n_max       = Field.n_max();
+  H.GM          = Field.GM();
+  H.R_ref       = Field.R_ref();
+  H.data_offset = sizeof(H);
+  H.data_count  = 2*(uint64_t)GravityField::Index(Field.n_max()+1,0);
+
+  out.write(reinterpret_cast<const char*>(&H), sizeof(H));
+  out.write(reinterpret_cast<const char*>(Field.data()),
+            H.data_count*sizeof(double));
+
+  return out.good();
+}
+
+bool ReadGravityBinary (const std::string& path, int n_max,
+                        GravityField& Field)
+{
+  std::shared_ptr<MappedFile> M(new MappedFile);
+  GravityHeader H;
+  size_t        n_bytes;
+
+  if (n_max<0) return false;
+
+  // Header and coefficient data up to degree n_max
+  n_bytes = sizeof(H) + 2*sizeof(double)*GravityField::Index(n_max+1,0);
+  if (!M->Open(path, n_bytes) || M->size()<sizeof(H)) return false;
+
+  memcpy(&H, M->data(), sizeof(H));
+  if ( memcmp(H.magic, GravityMagic, sizeof(H.magic))!=0 ||
+       H.version!=GravityVersion || H.endian!=GravityEndian ) {
+    cerr << "ERROR: Unknown format of gravity model file " << path << endl;
+    return false;
+  }
+  if (n_max>H.n_max) {
+    cerr << "ERROR: Gravity model file " << path << " has degree "
+         << H.n_max << " < " << n_max << endl;
+    return false;
+  }
+  if (H.data_offset!=sizeof(H) || M->size()<n_bytes) {
+    cerr << "ERROR: Truncated gravity model file " << path << endl;
+    return false;
+  }
+
+  GravityField F(0, H.GM, H.R_ref);
+
+  F.N   = n_max;
+  F.buf.clear();
+  F.map = M;
+  F.w   = 0;
+  F.cs  = reinterpret_cast<const double*>(M->data()+H.data_offset);
+
+  Field = std::move(F);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+//
+// TideDelta
+//
+//------------------------------------------------------------------------------
+void TideDelta::clear ()
+{
+  for (int n=0; n<=n_max; n++)
+    for (int m=0; m<=n_max; m++) dC[n][m] = dS[n][m] = 0.0;
+}
+
+//------------------------------------------------------------------------------
+//
+// HarmonicGravity (class implementation)
+//
+//------------------------------------------------------------------------------
+
+// Constructor
+
+HarmonicGravity::HarmonicGravity (const GravityFieldView& Field)
+  : gm(Field.GM()), r_ref(Field.R_ref()), N(Field.n_max()), M(Field.m_max()),
+    CS(Field.data())
+{
+  int K = Index(N+2,0);                 // Size for degrees 0..N+1
+
+  a.assign(K,0.0); b.assign(K,0.0);
+  f_p.assign(K,0.0); f_0.assign(K,0.0); f_m.assign(K,0.0);
+  d.assign(M+2,0.0);
+
+  // Recursion factors
+  for (int m=1; m<=M+1; m++)
+    d[m] = (m==1) ? sqrt(3.0) : sqrt((2.0*m+1.0)/(2.0*m));
+
+  for (int m=0; m<=M+1; m++)
+    for (int n=m+1; n<=N+1; n++) {
+      double nn=n, mm=m;
+      a[Index(n,m)] = sqrt( (2*nn+1)*(2*nn-1) / ((nn-mm)*(nn+mm)) );
+      b[Index(n,m)] = (n==m+1) ? 0.0 :
+                      sqrt( (2*nn+1)*(nn+mm-1)*(nn-mm-1) /
+                            ((nn-mm)*(nn+mm)*(2*nn-3)) );
+    }
+
+  // Normalization of the acceleration terms
+  for (int n=0; n<=N; n++)
+    for (int m=0; m<=n && m<=M; m++) {
+      double nn=n, mm=m, q=(2*nn+1)/(2*nn+3);
+      int    i=Index(n,m);
+      if (m==0) {
+        f_p[i] = sqrt( 0.5*q*(nn+1)*(nn+2) );
+        f_0[i] = (nn+1)*sqrt( q );
+      }
+      else {
+        f_p[i] = 0.5*sqrt( q*(nn+mm+1)*(nn+mm+2) );
+        f_0[i] = (nn-mm+1)*sqrt( q*(nn+mm+1)/(nn-mm+1) );
+        f_m[i] = 0.5*(nn-mm+1)*(nn-mm+2) *
+                 sqrt( (m==1 ? 2.0 : 1.0)*q/((nn-mm+1)*(nn-mm+2)) );
+      }
+    }
+}
+
+// Acceleration in the inertial system
+
+Vec3 HarmonicGravity::Accel (const Vec3& r, const Mat3& E) const
+{
+  return Transp(E)*AccelBodyFixed(E*r);
+}
+
+Vec3 HarmonicGravity::Accel (const Vec3& r, const Mat3& E,
+                             const TideDelta& D) const
+{
+  return Transp(E)*AccelBodyFixed(E*r, &D);
+}
+
+// Body-fixed acceleration
+
+Vec3 HarmonicGravity::AccelBodyFixed (const Vec3& r_bf, const TideDelta* D) const
+{
+  // Workspace of the calling thread (degrees 0..N+1)
+  static thread_local std::vector<double> V, W;
+
+  const int    K     = Index(N+2,0);
+  const double r_sqr = Dot(r_bf,r_bf);
+  const double rho   = r_ref*r_ref/r_sqr;
+  const double x0    = r_ref*r_bf(0)/r_sqr;
+  const double y0    = r_ref*r_bf(1)/r_sqr;
+  const double z0    = r_ref*r_bf(2)/r_sqr;
+
+  if ((int)V.size()<K) { V.resize(K); W.resize(K); }
+
+  // Normalized V/W functions up to degree N+1 and order M+1
+  V[0] = r_ref/sqrt(r_sqr);
+  W[0] = 0.0;
+  for (int m=0; m<=M+1; m++) {
+    int i = Index(m,m);
+    if (m>0) {
+      int j = Index(m-1,m-1);
+      V[i] = d[m]*( x0*V[j] - y0*W[j] );
+      W[i] = d[m]*( x0*W[j] + y0*V[j] );
+    }
+    if (m+1<=N+1) {
+      int j = Index(m+1,m);
+      V[j] = a[j]*z0*V[i];
+      W[j] = a[j]*z0*W[i];
+    }
+    for (int n=m+2; n<=N+1; n++) {
+      int j=Index(n,m), j1=Index(n-1,m), j2=Index(n-2,m);
+      V[j] = a[j]*z0*V[j1] - b[j]*rho*V[j2];
+      W[j] = a[j]*z0*W[j1] - b[j]*rho*W[j2];
+    }
+  }
+
+  // Acceleration
+  double ax=0.0, ay=0.0, az=0.0;
+
+  for (int n=0; n<=N; n++) {
+    const int     k  = Index(n+1,0);           // Row n+1 of V and W
+    const double* dC = (D && n<=TideDelta::n_max) ? D->dC[n] : 0;
+    const double* dS = (D && n<=TideDelta::n_max) ? D->dS[n] : 0;
+    int           i  = Index(n,0);
+    double        c, s;
+
+    // Zonal term
+    c = (dC ? CS[2*i]+dC[0] : CS[2*i]);
+    ax -= c*f_p[i]*V[k+1];
+    ay -= c*f_p[i]*W[k+1];
+    az -= c*f_0[i]*V[k];
+
+    // Tesseral and sectorial terms
+    for (int m=1; m<=n && m<=M; m++) {
+      i = Index(n,m);
+      c = (dC ? CS[2*i]+dC[m]   : CS[2*i]);
+      s = (dS ? CS[2*i+1]+dS[m] : CS[2*i+1]);
+      double Cp=c*f_p[i], Sp=s*f_p[i];
+      double Cm=c*f_m[i], Sm=s*f_m[i];
+      ax += -Cp*V[k+m+1] - Sp*W[k+m+1] + Cm*V[k+m-1] + Sm*W[k+m-1];
+      ay += -Cp*W[k+m+1] + Sp*V[k+m+1] - Cm*W[k+m-1] + Sm*V[k+m-1];
+      az += f_0[i]*( -c*V[k+m] - s*W[k+m] );
+    }
+  }
+
+  return (gm/(r_ref*r_ref))*Vec3(ax,ay,az);
+}
@@ -0,0 +1,268 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Gravity.h
+//
+// Purpose:
+//
+//   Harmonic gravity field of the Earth evaluated by the Cunningham
+//   recursion of normalized V/W functions
+//
+// Notes:
+//
+//   The recursion works on the Cartesian body-fixed coordinates and is free
+//   of singularities at the poles. It needs neither trigonometric functions
+//   nor powers of R_ref/r: the terms cos(m*lon), sin(m*lon) and (R_ref/r)^n
+//   are built up by the sectorial (x,y) and zonal (z) recursion steps. All
+//   recursion and normalization factors depend on (n_max,m_max) only and
+//   are computed once by the constructor.
+//
+//   The coefficients are held by GravityField in a packed lower triangle,
+//   degree by degree, with C(n,m) and S(n,m) stored next to each other.
+//   This is the order in which the summation consumes them, so that it
+//   streams linearly through memory.
+//
+//   The same layout is used by the binary gravity model files (see
+//   WriteGravityBinary), which are mapped into memory rather than parsed.
+//   As the pairs are ordered by degree, a model truncated to degree n only
+//   touches the first 16*(n+1)*(n+2)/2 bytes of coefficient data.
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifndef INC_SAT_GRAVITY_H
+#define INC_SAT_GRAVITY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SAT_VecMat.h"
+
+class MappedFile;
+
+//------------------------------------------------------------------------------
+//
+// GravityField (class definition)
+//
+// Purpose:
+//
+//   Normalized harmonic coefficients of a gravity field model in packed
+//   triangular storage: the pair (C(n,m),S(n,m)) of degree n<=n_max and
+//   order m<=n is stored at offset 2*(n*(n+1)/2+m) of a 64-byte aligned
+//   block
+//
+//------------------------------------------------------------------------------
+class GravityFieldView;
+
+class GravityField
+{
+  public:
+
+    // Constructor (all coefficients zero)
+    GravityField (
+      int    n_max,              // Maximum degree
+      double GM,                 // Gravitational coefficient [m^3/s^2]
+      double R_ref               // Reference radius [m]
+    );
+
+    // Move constructor and assignment (the coefficients are owned by the
+    // vector buffer or the file mapping and are not copied)
+    GravityField (GravityField&& F);
+    GravityField& operator= (GravityField&& F);
+
+    // Model constants
+    int    n_max () const { return N; };
+    double GM    () const { return gm; };
+    double R_ref () const { return r_ref; };
+
+    // Coefficients
+    static int Index (int n, int m) { return n*(n+1)/2 + m; };
+    double C (int n, int m) const { return cs[2*Index(n,m)];   };
+    double S (int n, int m) const { return cs[2*Index(n,m)+1]; };
+    void   Set (int n, int m, double C_nm, double S_nm);  // Not if mapped
+
+    // Packed (C,S) pairs
+    const double* data () const { return cs; };
+
+    // Field truncated to degree n and order m (m<=n<=n_max)
+    GravityFieldView Truncate (int n, int m) const;
+
+  private:
+
+    friend bool ReadGravityBinary (const std::string&, int, GravityField&);
+
+    int                         N;
+    double                      gm, r_ref;
+    std::vector<double>         buf;     // Storage including alignment padding
+    std::shared_ptr<MappedFile> map;     // Mapped binary model file
+    double*                     w;       // Writable pairs (0 if mapped)
+    const double*               cs;      // 64-byte aligned start of the pairs
+
+    GravityField (const GravityField&);
+    GravityField& operator= (const GravityField&);
+};
+
+//------------------------------------------------------------------------------
+//
+// ReadGravityText
+//
+// Purpose:
+//
+//   Reads normalized coefficients from a GGM-style text file with lines
+//   "n m C(n,m) S(n,m) sigma_C sigma_S" sorted by degree and order
+//
+// Input/Output:
+//
+//   path      File name
+//   n_max     Maximum degree to be read; reading stops after this degree
+//   GM        Gravitational coefficient of the model [m^3/s^2]
+//   R_ref     Reference radius of the model [m]
+//   Field     Gravity field of degree n_max
+//   <return>  false if the file cannot be opened or is incomplete
+//
+//------------------------------------------------------------------------------
+bool ReadGravityText (const std::string& path, int n_max, double GM,
+                      double R_ref, GravityField& Field);
+
+//------------------------------------------------------------------------------
+//
+// WriteGravityBinary, ReadGravityBinary
+//
+// Purpose:
+//
+//   Binary gravity model file. The file starts with a 64-byte header
+//
+//     char[8]  "HPOPGRAV"
+//     uint32   Format version (1)
+//     uint32   0x01020304 in the byte order of the writer
+//     int32    Maximum degree n_max
+//     int32    (reserved)
+//     double   GM [m^3/s^2], R_ref [m]
+//     uint64   Offset (64) and number of doubles of the coefficient data
+//     uint64   (reserved)
+//
+//   followed by the packed (C,S) pairs in the order of GravityField.
+//   ReadGravityBinary maps the header and the coefficients up to the
+//   requested degree only; the field refers to the mapping and cannot be
+//   modified.
+//
+// Input/Output:
+//
+//   path      File name
+//   n_max     Maximum degree required (ReadGravityBinary)
+//   Field     Gravity field
+//   <return>  false if the file cannot be opened or written, or if it has
+//             an unknown format or a lower degree than n_max
+//
+//------------------------------------------------------------------------------
+bool WriteGravityBinary (const std::string& path, const GravityField& Field);
+
+bool ReadGravityBinary (const std::string& path, int n_max,
+                        GravityField& Field);
+
+//------------------------------------------------------------------------------
+//
+// GravityFieldView (class definition)
+//
+// Purpose:
+//
+//   Gravity field model truncated to a maximum degree and order; refers to
+//   the coefficients of a GravityField, which must outlive the view
+//
+//------------------------------------------------------------------------------
+class GravityFieldView
+{
+  public:
+
+    GravityFieldView (const GravityField& F, int n, int m)
+      : Field(&F), N(n), M(m) {};
+
+    int    n_max () const { return N; };
+    int    m_max () const { return M; };
+    double GM    () const { return Field->GM(); };
+    double R_ref () const { return Field->R_ref(); };
+    double C (int n, int m) const { return Field->C(n,m); };
+    double S (int n, int m) const { return Field->S(n,m); };
+
+    // Packed (C,S) pairs of the complete field (see GravityField)
+    const double* data () const { return Field->data(); };
+
+  private:
+
+    const GravityField* Field;
+    int                 N, M;
+};
+
+//------------------------------------------------------------------------------
+//
+// TideDelta
+//
+// Purpose:
+//
+//   Time-variable corrections of the normalized harmonic coefficients up to
+//   degree and order 6 (solid Earth, ocean and pole tides)
+//
+//------------------------------------------------------------------------------
+struct TideDelta
+{
+  static const int n_max = 6;              // Maximum degree of the corrections
+
+  double dC[n_max+1][n_max+1];             // Corrections of C(n,m), S(n,m)
+  double dS[n_max+1][n_max+1];
+
+  void clear ();
+};
+
+//------------------------------------------------------------------------------
+//
+// HarmonicGravity (class definition)
+//
+// Purpose:
+//
+//   Acceleration due to the harmonic gravity field of the central body up
+//   to a fixed degree and order
+//
+//------------------------------------------------------------------------------
+class HarmonicGravity
+{
+  public:
+
+    // Constructor; the coefficients are referenced, not copied
+    explicit HarmonicGravity (const GravityFieldView& Field);
+
+    // Maximum degree and order
+    int n_max () const { return N; };
+    int m_max () const { return M; };
+
+    // Acceleration (a=d^2r/dt^2) for position r in the inertial system and
+    // transformation E to the body-fixed system
+    Vec3 Accel (const Vec3& r, const Mat3& E) const;
+
+    // Acceleration of the field with tidal corrections, which are added to
+    // the coefficients of degree n<=6 during the summation
+    Vec3 Accel (const Vec3& r, const Mat3& E, const TideDelta& D) const;
+
+    // Body-fixed acceleration for body-fixed position r_bf (D may be 0)
+    Vec3 AccelBodyFixed (const Vec3& r_bf, const TideDelta* D = 0) const;
+
+    // Gravity model constants
+    double GM    () const { return gm; };
+    double R_ref () const { return r_ref; };
+
+  private:
+
+    // Index of (n,m) in triangular storage
+    static int Index (int n, int m) { return n*(n+1)/2 + m; };
+
+    double gm, r_ref;
+    int    N, M;
+
+    const double*       CS;               // Packed (C,S) pairs of the field
+    std::vector<double> a, b;             // Column recursion (n<=N+1, m<=M+1)
+    std::vector<double> d;                // Sectorial recursion (m<=M+1)
+    std::vector<double> f_p, f_0, f_m;    // Normalization of the terms with
+                                          // V(n+1,m+1), V(n+1,m), V(n+1,m-1)
+};
+
+#endif  // include-Blocker
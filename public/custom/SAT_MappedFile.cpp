@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+//
+// SAT_MappedFile.cpp
+//
+// Purpose:
+//
+//   Read-only memory mapping of binary data files (POSIX and Win32)
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "SAT_MappedFile.h"
+
+//------------------------------------------------------------------------------
+//
+// MappedFile (class implementation)
+//
+//------------------------------------------------------------------------------
+
+MappedFile::MappedFile ()
+  : addr(0), len(0), file_len(0)
+#ifdef _WIN32
+    , hFile(INVALID_HANDLE_VALUE), hMap(0)
+#endif
+{
+}
+
+MappedFile::~MappedFile ()
+{
+  Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open (const std::string& path, size_t max_bytes)
+{
+  LARGE_INTEGER n;
+
+  Close();
+
+  hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile==INVALID_HANDLE_VALUE) return false;
+  if (!GetFileSizeEx(hFile, &n) || n.QuadPart==0) { Close(); return false; }
+
+  file_len = (size_t)n.QuadPart;
+  len      = (max_bytes>0 && max_bytes<file_len) ? max_bytes : file_len;
+
+  hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!hMap) { Close(); return false; }
+  addr = (const char*)MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, len);
+  if (!addr) { Close(); return false; }
+
+  return true;
+}
+
+void MappedFile::Close ()
+{
+  if (addr) UnmapViewOfFile(addr);
+  if (hMap) CloseHandle(hMap);
+  if (hFile!=INVALID_HANDLE_VALUE) CloseHandle(hFile);
+  addr = 0; hMap = 0; hFile = INVALID_HANDLE_VALUE;
+  len = file_len = 0;
+}
+
+#else
+
+bool MappedFile::Open (const std::string& path, size_t max_bytes)
+{
+  struct stat st;
+  void*       p;
+  int         fd;
+
+  Close();
+
+  fd = open(path.c_str(), O_RDONLY);
+  if (fd<0) return false;
+  if (fstat(fd, &st)!=0 || st.st_size==0) { close(fd); return false; }
+
+  file_len = (size_t)st.st_size;
+  len      = (max_bytes>0 && max_bytes<file_len) ? max_bytes : file_len;
+
+  p = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);                           // The mapping keeps the file open
+  if (p==MAP_FAILED) { len = file_len = 0; return false; }
+
+  addr = (const char*)p;
+  return true;
+}
+
+void MappedFile::Close ()
+{
+  if (addr) munmap((void*)addr, len);
+  addr = 0;
+  len = file_len = 0;
+}
+
+#endif
@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------
+//
+// SAT_MappedFile.h
+//
+// Purpose:
+//
+//   Read-only memory mapping of binary data files (POSIX and Win32)
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifndef INC_SAT_MAPPEDFILE_H
+#define INC_SAT_MAPPEDFILE_H
+
+#include <stddef.h>
+#include <string>
+
+//------------------------------------------------------------------------------
+//
+// MappedFile (class definition)
+//
+// Purpose:
+//
+//   Read-only view of (the leading part of) a file. The mapping is released
+//   by the destructor; pages are read from disk only when accessed.
+//
+//------------------------------------------------------------------------------
+class MappedFile
+{
+  public:
+
+    MappedFile ();
+    ~MappedFile ();
+
+    // Maps the first max_bytes bytes of a file (the whole file for
+    // max_bytes=0); returns false if the file cannot be opened
+    bool Open (const std::string& path, size_t max_bytes = 0);
+    void Close ();
+
+    // Mapped data (page aligned) and its size
+    const char* data () const { return addr; };
+    size_t      size () const { return len; };
+
+    // Total size of the file
+    size_t      file_size () const { return file_len; };
+
+  private:
+
+    const char* addr;
+    size_t      len, file_len;
+#ifdef _WIN32
+    void*       hFile;
+    void*       hMap;
+#endif
+
+    MappedFile (const MappedFile&);
+    MappedFile& operator= (const MappedFile&);
+};
+
+#endif  // include-Blocker
@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Parallel.cpp
+//
+// Purpose:
+//
+//   Work-stealing thread pool for the parallel propagation of satellites
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#include "SAT_Parallel.h"
+
+using std::mutex;
+using std::unique_lock;
+using std::lock_guard;
+
+//------------------------------------------------------------------------------
+//
+// WorkStealingPool (class implementation)
+//
+//------------------------------------------------------------------------------
+
+// Constructor
+
+WorkStealingPool::WorkStealingPool (int n_threads)
+  : queued(0), pending(0), stop(false), next(0)
+{
+  if (n_threads<=0) n_threads = (int)std::thread::hardware_concurrency();
+  if (n_threads<=0) n_threads = 1;
+
+  for (int i=0; i<n_threads; i++)
+    queues.push_back(std::unique_ptr<Queue>(new Queue));
+  for (int i=0; i<n_threads; i++)
+    workers.push_back(std::thread(&WorkStealingPool::Run, this, i));
+}
+
+// Destructor
+
+WorkStealingPool::~WorkStealingPool ()
+{
+  Wait();
+  {
+    lock_guard<mutex> lock(mtx);
+    stop = true;
+  }
+  cv_work.notify_all();
+  for (size_t i=0; i<workers.size(); i++) workers[i].join();
+}
+
+// Submission of a task
+
+void WorkStealingPool::Submit (Task task)
+{
+  int i = (int)(next++ % queues.size());
+
+  {
+    lock_guard<mutex> lock(mtx);
+    pending++;
+  }
+  {
+    lock_guard<mutex> lock(queues[i]->mtx);
+    queues[i]->tasks.push_back(std::move(task));
+  }
+  {
+    lock_guard<mutex> lock(mtx);
+    queued++;
+  }
+  cv_work.notify_one();
+}
+
+// Wait for completion of all submitted tasks
+
+void WorkStealingPool::Wait ()
+{
+  unique_lock<mutex> lock(mtx);
+  cv_done.wait(lock, [this]() { return pending==0; });
+}
+
+// Task from the back of the worker's own deque
+
+bool WorkStealingPool::Pop (int i, Task& task)
+{
+  lock_guard<mutex> lock(queues[i]->mtx);
+  if (queues[i]->tasks.empty()) return false;
+  task = std::move(queues[i]->tasks.back());
+  queues[i]->tasks.pop_back();
+  return true;
+}
+
+// Task from the front of another worker's deque
+
+bool WorkStealingPool::Steal (int i, Task& task)
+{
+  int n = (int)queues.size();
+
+  for (int k=1; k<n; k++) {
+    Queue& Q = *queues[(i+k)%n];
+    lock_guard<mutex> lock(Q.mtx);
+    if (Q.tasks.empty()) continue;
+    task = std::move(Q.tasks.front());
+    Q.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+// Worker loop
+
+void WorkStealingPool::Run (int i)
+{
+  Task task;
+
+  for (;;) {
+    {
+      unique_lock<mutex> lock(mtx);
+      cv_work.wait(lock, [this]() { return stop || queued>0; });
+      if (stop && queued==0) return;
+    }
+    if (!Pop(i,task) && !Steal(i,task)) continue;   // Taken by another worker
+    {
+      lock_guard<mutex> lock(mtx);
+      queued--;
+    }
+    task();
+    task = Task();
+    {
+      lock_guard<mutex> lock(mtx);
+      if (--pending==0) cv_done.notify_all();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+//
+// ParallelFor
+//
+//------------------------------------------------------------------------------
+void ParallelFor (WorkStealingPool& Pool, int n,
+                  const std::function<void(int)>& body)
+{
+  for (int i=0; i<n; i++) Pool.Submit( [&body,i]() { body(i); } );
+  Pool.Wait();
+}
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+//
+// SAT_Parallel.h
+//
+// Purpose:
+//
+//   Work-stealing thread pool for the parallel propagation of satellites
+//
+// Notes:
+//
+//   Every worker owns a task deque. A worker takes new tasks from the back
+//   of its own deque and, when this runs empty, steals from the front of
+//   the other workers' deques, so that jobs of unequal cost (e.g. orbits
+//   with and without drag) are balanced automatically.
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifndef INC_SAT_PARALLEL_H
+#define INC_SAT_PARALLEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+//
+// WorkStealingPool (class definition)
+//
+// Purpose:
+//
+//   Fixed set of worker threads with per-worker task deques
+//
+//------------------------------------------------------------------------------
+class WorkStealingPool
+{
+  public:
+
+    typedef std::function<void()> Task;
+
+    // Constructor; n_threads<=0 selects the number of hardware threads
+    explicit WorkStealingPool (int n_threads = 0);
+
+    // Destructor; waits for all submitted tasks
+    ~WorkStealingPool ();
+
+    // Number of worker threads
+    int Size() const { return (int)workers.size(); };
+
+    // Submission of a task (distributed round-robin over the workers)
+    void Submit (Task task);
+
+    // Wait for completion of all submitted tasks
+    void Wait ();
+
+  private:
+
+    struct Queue {
+      std::deque<Task> tasks;
+      std::mutex       mtx;
+    };
+
+    bool Pop   (int i, Task& task);        // Own deque (back)
+    bool Steal (int i, Task& task);        // Other deques (front)
+    void Run   (int i);                    // Worker loop
+
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread>             workers;
+
+    std::mutex              mtx;           // Protects the counters below
+    std::condition_variable cv_work;       // Signals new tasks or stop
+    std::condition_variable cv_done;       // Signals pending==0
+    int                     queued;        // Tasks waiting in the deques
+    int                     pending;       // Tasks submitted, not finished
+    bool                    stop;
+    std::atomic<unsigned>   next;          // Round-robin submission index
+
+    WorkStealingPool (const WorkStealingPool&);
+    WorkStealingPool& operator= (const WorkStealingPool&);
+};
+
+//------------------------------------------------------------------------------
+//
+// ParallelFor
+//
+// Purpose:
+//
+//   Executes body(i) for i=0,...,n-1 on the given pool and returns after all
+//   calls have been completed
+//
+// Input/Output:
+//
+//   Pool        Thread pool
+//   n           Number of iterations
+//   body        Loop body; calls for different i must be independent
+//
+//------------------------------------------------------------------------------
+void ParallelFor (WorkStealingPool& Pool, int n,
+                  const std::function<void(int)>& body);
+
+#endif  // include-Blocker
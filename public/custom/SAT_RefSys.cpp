@@ -28,18 +28,14 @@
 #endif
 
 #include "SAT_Const.h"
+#include "SAT_Context.h"
 #include "SAT_RefSys.h"
 #include "SAT_VecMat.h"
-#include "eopspw.h"
 
 using std::ostream;
 using std::cerr;
 using std::endl;
 
-extern int dat;
-extern double jdeopstart,dut1,lod,xp,yp,ddpsi,ddeps,dx,dy,x,y,s,deltapsi,deltaeps;
-extern eopdata eoparr[eopsize];
-
 //
 // Local declarations
 //
@@ -153,6 +149,11 @@ Matrix EclMatrix(double Mjd_TT)
   return R_x(MeanObliquity(Mjd_TT));
 }
 
+void EclMatrix(double Mjd_TT, Mat3& E)
+{
+  R_x(MeanObliquity(Mjd_TT), E);
+}
+
 //------------------------------------------------------------------------------
 //
 // PrecMatrix
@@ -169,6 +170,13 @@ Matrix EclMatrix(double Mjd_TT)
 //
 //------------------------------------------------------------------------------
 Matrix PrecMatrix(double Mjd_1, double Mjd_2)
+{
+  Mat3 P;
+  PrecMatrix(Mjd_1, Mjd_2, P);
+  return Matrix(P);
+}
+
+void PrecMatrix(double Mjd_1, double Mjd_2, Mat3& P)
 {
 
   // Constants
@@ -186,7 +194,9 @@ Matrix PrecMatrix(double Mjd_1, double Mjd_2)
                 ((0.42665+0.000217*T)+0.041833*dT)*dT )*dT/Arcs;
 
   // Precession matrix
-  return R_z(-z) * R_y(theta) * R_z(-zeta);
+  Mat3 U_z, U_y, U_zeta;
+  R_z(-z, U_z);  R_y(theta, U_y);  R_z(-zeta, U_zeta);
+  P = U_z * U_y * U_zeta;
 }
 
 //------------------------------------------------------------------------------
@@ -374,8 +384,16 @@ void NutAngles(double Mjd_TT, double& dpsi, double& deps)
 //
 //------------------------------------------------------------------------------
 Matrix NutMatrix(double Mjd_TT)
+{
+  Mat3 N;
+  NutMatrix(Mjd_TT, N);
+  return Matrix(N);
+}
+
+void NutMatrix(double Mjd_TT, Mat3& N)
 {
   double dpsi, deps, eps;
+  Mat3   U_1, U_2, U_3;
 
   // Mean obliquity of the ecliptic
   eps = MeanObliquity(Mjd_TT);
@@ -384,7 +402,8 @@ Matrix NutMatrix(double Mjd_TT)
   NutAngles (Mjd_TT, dpsi,deps);
 
   // Transformation from mean to true equator and equinox
-  return  R_x(-eps-deps)*R_z(-dpsi)*R_x(+eps);
+  R_x(-eps-deps, U_1);  R_z(-dpsi, U_2);  R_x(+eps, U_3);
+  N = U_1*U_2*U_3;
 }
 
 //------------------------------------------------------------------------------
@@ -535,6 +554,11 @@ Matrix GHAMatrix(double Mjd_UT1, double Mjd_TT)
   return R_z( GAST(Mjd_UT1, Mjd_TT) );
 }
 
+void GHAMatrix(double Mjd_UT1, double Mjd_TT, Mat3& G)
+{
+  R_z( GAST(Mjd_UT1, Mjd_TT), G );
+}
+
 //------------------------------------------------------------------------------
 //
 // PoleMatrix
@@ -555,6 +579,206 @@ Matrix PoleMatrix(double Mjd_UTC)
    return R_y(-IERS::x_pole(Mjd_UTC)) * R_x(-IERS::y_pole(Mjd_UTC));
 }
 
+void PoleMatrix(double Mjd_UTC, Mat3& Pi)
+{
+   Mat3 U_y, U_x;
+   R_y(-IERS::x_pole(Mjd_UTC), U_y);  R_x(-IERS::y_pole(Mjd_UTC), U_x);
+   Pi = U_y * U_x;
+}
+
+void PoleMatrix(const PropagationContext& Ctx, Mat3& Pi)
+{
+   Mat3 U_y, U_x;
+   R_y(-Ctx.x_pole(), U_y);  R_x(-Ctx.y_pole(), U_x);
+   Pi = U_y * U_x;
+}
+
+//------------------------------------------------------------------------------
+//
+// FrameCache (class implementation)
+//
+//------------------------------------------------------------------------------
+namespace {
+
+// Unit quaternion (q0,q1,q2,q3) of a rotation matrix; the sign is chosen
+// such that q is continuous with the previous node q_ref (if any)
+
+void MatToQuat(const Mat3& R, double q[], const double q_ref[])
+{
+  double t = R(0,0)+R(1,1)+R(2,2), s;
+
+  if (t > 0.0) {
+    s = 0.5/sqrt(t+1.0);
+    q[0] = 0.25/s;
+    q[1] = (R(2,1)-R(1,2))*s; q[2] = (R(0,2)-R(2,0))*s; q[3] = (R(1,0)-R(0,1))*s;
+  }
+  else if (R(0,0)>R(1,1) && R(0,0)>R(2,2)) {
+    s = 2.0*sqrt(1.0+R(0,0)-R(1,1)-R(2,2));
+    q[0] = (R(2,1)-R(1,2))/s; q[1] = 0.25*s;
+    q[2] = (R(0,1)+R(1,0))/s; q[3] = (R(0,2)+R(2,0))/s;
+  }
+  else if (R(1,1)>R(2,2)) {
+    s = 2.0*sqrt(1.0+R(1,1)-R(0,0)-R(2,2));
+    q[0] = (R(0,2)-R(2,0))/s; q[1] = (R(0,1)+R(1,0))/s;
+    q[2] = 0.25*s;            q[3] = (R(1,2)+R(2,1))/s;
+  }
+  else {
+    s = 2.0*sqrt(1.0+R(2,2)-R(0,0)-R(1,1));
+    q[0] = (R(1,0)-R(0,1))/s; q[1] = (R(0,2)+R(2,0))/s;
+    q[2] = (R(1,2)+R(2,1))/s; q[3] = 0.25*s;
+  }
+
+  if (q_ref && q[0]*q_ref[0]+q[1]*q_ref[1]+q[2]*q_ref[2]+q[3]*q_ref[3] < 0.0)
+    for (int k=0; k<4; k++) q[k] = -q[k];
+}
+
+// Rotation matrix of a (not necessarily normalized) quaternion
+
+void QuatToMat(const double q_[], Mat3& R)
+{
+  double n = sqrt(q_[0]*q_[0]+q_[1]*q_[1]+q_[2]*q_[2]+q_[3]*q_[3]);
+  double w = q_[0]/n, x = q_[1]/n, y = q_[2]/n, z = q_[3]/n;
+
+  R(0,0) = 1.0-2.0*(y*y+z*z); R(0,1) = 2.0*(x*y-w*z);     R(0,2) = 2.0*(x*z+w*y);
+  R(1,0) = 2.0*(x*y+w*z);     R(1,1) = 1.0-2.0*(x*x+z*z); R(1,2) = 2.0*(y*z-w*x);
+  R(2,0) = 2.0*(x*z-w*y);     R(2,1) = 2.0*(y*z+w*x);     R(2,2) = 1.0-2.0*(x*x+y*y);
+}
+
+}
+
+// Constructor; the nodes extend by one spacing beyond the interval on
+// the left and by two on the right as needed by the 4-point interpolation
+
+FrameCache::FrameCache (double Mjd_TT_0, double Mjd_TT_1, double Step)
+  : Mjd_0(Mjd_TT_0-Step), h(Step)
+{
+  Mat3 P, N, Ecl;
+
+  if (Step<=0.0 || Mjd_TT_1<Mjd_TT_0) {
+    cerr << "ERROR: Invalid interval or node spacing in FrameCache" << endl;
+    exit(1);
+  }
+
+  n = (int)ceil((Mjd_TT_1-Mjd_TT_0)/h) + 4;
+  q_T.resize(4*n); q_EP.resize(4*n); EqE_.resize(n);
+
+  for (int i=0; i<n; i++) {
+    double Mjd_TT = Mjd_0 + i*h;
+    PrecMatrix(MJD_J2000,Mjd_TT,P);
+    NutMatrix(Mjd_TT,N);
+    EclMatrix(Mjd_TT,Ecl);
+    MatToQuat(N*P,   &q_T[4*i],  (i>0)? &q_T[4*(i-1)]  : 0);
+    MatToQuat(Ecl*P, &q_EP[4*i], (i>0)? &q_EP[4*(i-1)] : 0);
+    EqE_[i] = EqnEquinox(Mjd_TT);
+  }
+}
+
+// Check whether an epoch lies inside the covered interval
+
+bool FrameCache::Covers (double Mjd_TT) const
+{
+  double x = (Mjd_TT-Mjd_0)/h;
+  return (x>=1.0 && x<=n-3.0);
+}
+
+// Interpolated values for given epoch
+
+int FrameCache::Weights (double Mjd_TT, double L[4]) const
+{
+  double x = (Mjd_TT-Mjd_0)/h;
+  int    i = (int)floor(x);
+  double u = x-i;
+
+  if (!Covers(Mjd_TT)) {
+    cerr << "ERROR: Epoch outside FrameCache interval" << endl;
+    exit(1);
+  }
+
+  L[0] = -u*(u-1.0)*(u-2.0)/6.0;
+  L[1] = (u+1.0)*(u-1.0)*(u-2.0)/2.0;
+  L[2] = -(u+1.0)*u*(u-2.0)/2.0;
+  L[3] = (u+1.0)*u*(u-1.0)/6.0;
+
+  return i;
+}
+
+void FrameCache::Get (double Mjd_TT, Mat3& T, Mat3& EP, double& EqE) const
+{
+  double L[4], q[4];
+  int    i = Weights(Mjd_TT, L);
+
+  for (int k=0; k<4; k++) {
+    q[k] = 0.0;
+    for (int j=0; j<4; j++) q[k] += L[j]*q_T[4*(i-1+j)+k];
+  }
+  QuatToMat(q,T);
+
+  for (int k=0; k<4; k++) {
+    q[k] = 0.0;
+    for (int j=0; j<4; j++) q[k] += L[j]*q_EP[4*(i-1+j)+k];
+  }
+  QuatToMat(q,EP);
+
+  EqE = 0.0;
+  for (int j=0; j<4; j++) EqE += L[j]*EqE_[i-1+j];
+}
+
+double FrameCache::EqE (double Mjd_TT) const
+{
+  double L[4], EqE = 0.0;
+  int    i = Weights(Mjd_TT, L);
+
+  for (int j=0; j<4; j++) EqE += L[j]*EqE_[i-1+j];
+
+  return EqE;
+}
+
+//------------------------------------------------------------------------------
+//
+// ComputeEarthFrame
+//
+// Purpose:
+//
+//   Reference system matrices for a given epoch
+//
+// Input/Output:
+//
+//   Ctx       Propagation context; updated for the given epoch
+//   Mjd_UTC   Modified Julian Date UTC
+//   F         Reference system matrices
+//
+//------------------------------------------------------------------------------
+void ComputeEarthFrame(PropagationContext& Ctx, double Mjd_UTC, EarthFrame& F)
+{
+  double Omega, EqE;
+  Mat3   P, N, Ecl, Theta, Pi, S;
+
+  Ctx.Update(Mjd_UTC);
+
+  F.Mjd_UT1 = Mjd_UTC + Ctx.UT1_UTC()/86400.0;
+  F.Mjd_TT  = Mjd_UTC + Ctx.TT_UTC()/86400.0;
+
+  if (Ctx.Frames && Ctx.Frames->Covers(F.Mjd_TT)) {
+    Ctx.Frames->Get(F.Mjd_TT, F.T, F.EP, EqE);
+    R_z( Modulo( GMST(F.Mjd_UT1) + EqE, pi2 ), Theta );
+  }
+  else {
+    PrecMatrix(MJD_J2000,F.Mjd_TT,P);  // IAU 1976 Precession
+    NutMatrix(F.Mjd_TT,N);             // IAU 1980 Nutation
+    EclMatrix(F.Mjd_TT,Ecl);
+    F.T  = N*P;
+    F.EP = Ecl*P;
+    GHAMatrix(F.Mjd_UT1,F.Mjd_TT,Theta);
+  }
+  PoleMatrix(Ctx,Pi);                  // Polar motion
+
+  S(0,1) = 1;
+  S(1,0) = -1;
+  Omega = omega_Earth-0.843994809*1e-9*Ctx.lod; // [rad/s] IERS
+  F.E   = Pi * Theta * F.T;
+  F.dE  = Pi * (Omega*S*Theta) * F.T;
+}
+
 //------------------------------------------------------------------------------
 //
 // Geodetic (class implementation)
@@ -581,6 +805,13 @@ Geodetic::Geodetic(double lambda, double phi, double alt)
 Geodetic::Geodetic(Vector r,                         // Position vector [m]
                    double R_equ,                     // Equator radius [m]
                    double f)                         // Flattening
+  : Geodetic(Vec3(r), R_equ, f)
+{
+}
+
+Geodetic::Geodetic(const Vec3& r,                    // Position vector [m]
+                   double R_equ,                     // Equator radius [m]
+                   double f)                         // Flattening
 {
   const double  eps     = 1.0e3*eps_mach;   // Convergence criterion
   const double  epsRequ = eps*R_equ;
@@ -729,6 +960,36 @@ void AzEl(const Vector& s, double& A, double& E, Vector& dAds, Vector& dEds)
   dEds = Vector( -s(0)*s(2)/rho, -s(1)*s(2)/rho , rho ) / Dot(s,s);
 }
 
+//--------------------------------------------------------------------------
+//
+// ICRS2ITRS: ICRS to ITRS transformation matrix and its time derivative
+//            (local function of ECEF2ECI and ECI2ECEF)
+//
+// Inputs:
+//
+//  Ctx         Propagation context; updated for the given epoch
+//  Mjd_UTC     Modified Julian Date(UTC)
+//
+// Outputs:
+//
+//  U           ICRS to ITRS transformation matrix
+//  dU          Derivative of U [1/s]
+//
+//--------------------------------------------------------------------------
+namespace {
+
+void ICRS2ITRS(PropagationContext& Ctx, double Mjd_UTC, Mat3& U, Mat3& dU)
+{
+  EarthFrame F;
+
+  ComputeEarthFrame(Ctx, Mjd_UTC, F);
+
+  U  = F.E;   // ICRS to ITRS transformation
+  dU = F.dE;  // Derivative [1/s]
+}
+
+}
+
 //--------------------------------------------------------------------------
 //
 // ECEF2ECI: Transforms Earth Centered Earth Fixed (ECEF) coordinates to
@@ -747,38 +1008,25 @@ void AzEl(const Vector& s, double& A, double& E, Vector& dAds, Vector& dEds)
 //--------------------------------------------------------------------------
 Vector ECEF2ECI(double Mjd_UTC, const Vector& Y0)
 {
-  double Mjd_UT1, Mjd_TT, jd, mfme, Omega;
-  Matrix P(3,3), N(3,3), Theta(3,3), Pi(3,3), S(3,3), dTheta(3,3), U(3,3), dU(3,3);
-  Vector r(3), v(3);
-  char interp = 'l';
-
-  jd = Mjd_UTC + 2400000.5;
-  mfme = 1440.0*(Mjd_UTC - floor(Mjd_UTC));
-  findeopparam(jd, mfme, interp, eoparr, jdeopstart, dut1, dat, lod, xp, yp,
-               ddpsi, ddeps, dx, dy, x, y, s, deltapsi, deltaeps);
-
-  IERS::Set(dut1, -dat, xp, yp);
+  return Vector( ECEF2ECI(Mjd_UTC, Vec6(Y0)) );
+}
 
-  Mjd_UT1 = Mjd_UTC + IERS::UT1_UTC(Mjd_UTC)/86400.0;
-  Mjd_TT  = Mjd_UTC + IERS::TT_UTC(Mjd_UTC)/86400.0;
+Vec6 ECEF2ECI(double Mjd_UTC, const Vec6& Y0)
+{
+  PropagationContext Ctx;
+  return ECEF2ECI(Ctx, Mjd_UTC, Y0);
+}
 
-  // ICRS to ITRS transformation matrix and its derivative
-  P = PrecMatrix(MJD_J2000,Mjd_TT);  // IAU 1976 Precession
-  N = NutMatrix(Mjd_TT);             // IAU 1980 Nutation
-  Theta = GHAMatrix(Mjd_UT1,Mjd_TT); // Earth rotation
-  Pi = PoleMatrix(Mjd_UTC);          // Polar motion
+Vec6 ECEF2ECI(PropagationContext& Ctx, double Mjd_UTC, const Vec6& Y0)
+{
+  Mat3 U, dU;
+  Vec3 r, v;
 
-  S(0,1) = 1;
-  S(1,0) = -1;
-  //Omega = 7292115.8553e-11+4.3e-15*( (Mjd_UTC-MJD_J2000)/36525.0 ); // [rad/s]
-  Omega  = omega_Earth-0.843994809*1e-9*lod; // [rad/s] IERS
-  dTheta = Omega*S*Theta; // Derivative of Earth rotation matrix [1/s]
-  U      = Pi*Theta*N*P;  // ICRS to ITRS transformation
-  dU     = Pi*dTheta*N*P; // Derivative [1/s]
+  ICRS2ITRS(Ctx, Mjd_UTC, U, dU);
 
   // Transformation from WGS to ICRS
-  r = Transp(U)*Y0.slice(0,2);
-  v = Transp(U)*Y0.slice(3,5) + Transp(dU)*Y0.slice(0,2);
+  r = Transp(U)*Y0.Pos();
+  v = Transp(U)*Y0.Vel() + Transp(dU)*Y0.Pos();
 
   return Stack(r, v);
 }
@@ -801,39 +1049,25 @@ Vector ECEF2ECI(double Mjd_UTC, const Vector& Y0)
 //--------------------------------------------------------------------------
 Vector ECI2ECEF(double Mjd_UTC, const Vector& Y0)
 {
-  double Mjd_UT1, Mjd_TT, jd, mfme, Omega;
-  Matrix P(3,3), N(3,3), Theta(3,3), Pi(3,3), S(3,3), dTheta(3,3), U(3,3), dU(3,3);
-  Vector r(3), v(3);
-  char interp = 'l';
-  
-  jd = Mjd_UTC + 2400000.5;
-  mfme = 1440.0*(Mjd_UTC - floor(Mjd_UTC));
-  findeopparam(jd, mfme, interp, eoparr, jdeopstart, dut1, dat, lod, xp, yp,
-               ddpsi, ddeps, dx, dy, x, y, s, deltapsi, deltaeps);
-
-  IERS::Set(dut1, -dat, xp, yp);
+  return Vector( ECI2ECEF(Mjd_UTC, Vec6(Y0)) );
+}
 
-  Mjd_UT1 = Mjd_UTC + IERS::UT1_UTC(Mjd_UTC)/86400.0;
-  Mjd_TT = Mjd_UTC + IERS::TT_UTC(Mjd_UTC)/86400.0;
+Vec6 ECI2ECEF(double Mjd_UTC, const Vec6& Y0)
+{
+  PropagationContext Ctx;
+  return ECI2ECEF(Ctx, Mjd_UTC, Y0);
+}
 
-  // ICRS to ITRS transformation matrix and its derivative
-  P = PrecMatrix(MJD_J2000,Mjd_TT);  // IAU 1976 Precession
-  N = NutMatrix(Mjd_TT);             // IAU 1980 Nutation
-  Theta = GHAMatrix(Mjd_UT1,Mjd_TT); // Earth rotation
-  Pi = PoleMatrix(Mjd_UTC);          // Polar motion
+Vec6 ECI2ECEF(PropagationContext& Ctx, double Mjd_UTC, const Vec6& Y0)
+{
+  Mat3 U, dU;
+  Vec3 r, v;
 
-  S(0,1) = 1;
-  S(1,0) = -1;
-  //Omega = 7292115.8553e-11+4.3e-15*( (Mjd_UTC-MJD_J2000)/36525.0 ); // [rad/s]
-  Omega  = omega_Earth-0.843994809*1e-9*lod; // [rad/s] IERS
-  dTheta = Omega*S*Theta; // Derivative of Earth rotation matrix [1/s]
-  U      = Pi*Theta*N*P;  // ICRS to ITRS transformation
-  dU     = Pi*dTheta*N*P; // Derivative [1/s]
+  ICRS2ITRS(Ctx, Mjd_UTC, U, dU);
 
-  // Transformation from WGS to ICRS
-  r = U*Y0.slice(0,2);
-  v = U*Y0.slice(3,5) + dU*Y0.slice(0,2);
+  // Transformation from ICRS to WGS
+  r = U*Y0.Pos();
+  v = U*Y0.Vel() + dU*Y0.Pos();
 
   return Stack(r, v);
 }
-
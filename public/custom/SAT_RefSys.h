@@ -18,9 +18,13 @@
 #ifndef INC_SAT_REFSYS_H
 #define INC_SAT_REFSYS_H
 
+#include <vector>
+
 #include "SAT_Const.h"
 #include "SAT_VecMat.h"
 
+class PropagationContext;
+
 //------------------------------------------------------------------------------
 //
 // IERS (Class definition)
@@ -92,9 +96,11 @@ double MeanObliquity (double Mjd_TT);
 //
 //   Mjd_TT    Modified Julian Date (Terrestrial Time)
 //   <return>  Transformation matrix
+//   E         Transformation matrix (fixed-size version)
 //
 //------------------------------------------------------------------------------
 Matrix EclMatrix (double Mjd_TT);
+void   EclMatrix (double Mjd_TT, Mat3& E);
 
 //------------------------------------------------------------------------------
 //
@@ -109,9 +115,11 @@ Matrix EclMatrix (double Mjd_TT);
 //   Mjd_1     Epoch given (Modified Julian Date TT)
 //   MjD_2     Epoch to precess to (Modified Julian Date TT)
 //   <return>  Precession transformation matrix
+//   P         Precession transformation matrix (fixed-size version)
 //
 //------------------------------------------------------------------------------
 Matrix PrecMatrix (double Mjd_1, double Mjd_2);
+void   PrecMatrix (double Mjd_1, double Mjd_2, Mat3& P);
 
 //------------------------------------------------------------------------------
 //
@@ -125,9 +133,11 @@ Matrix PrecMatrix (double Mjd_1, double Mjd_2);
 //
 //   Mjd_TT    Modified Julian Date (Terrestrial Time)
 //   <return>  Nutation matrix
+//   N         Nutation matrix (fixed-size version)
 //
 //------------------------------------------------------------------------------
 Matrix NutMatrix (double Mjd_TT);
+void   NutMatrix (double Mjd_TT, Mat3& N);
 
 //------------------------------------------------------------------------------
 //
@@ -198,9 +208,11 @@ double GAST (double Mjd_UT1, double Mjd_TT);
 //   Mjd_UT1   Modified Julian Date UT1
 //   Mjd_TT    Modified Julian Date (Terrestrial Time)
 //   <return>  Greenwich Hour Angle matrix
+//   G         Greenwich Hour Angle matrix (fixed-size version)
 //
 //------------------------------------------------------------------------------
 Matrix GHAMatrix (double Mjd_UT1, double Mjd_TT);
+void   GHAMatrix (double Mjd_UT1, double Mjd_TT, Mat3& G);
 
 //------------------------------------------------------------------------------
 //
@@ -214,10 +226,111 @@ Matrix GHAMatrix (double Mjd_UT1, double Mjd_TT);
 // Input/Output:
 //
 //   Mjd_UTC   Modified Julian Date UTC
+//   Ctx       Propagation context providing the pole coordinates
 //   <return>  Pole matrix
+//   Pi        Pole matrix (fixed-size version)
 //
 //------------------------------------------------------------------------------
 Matrix PoleMatrix (double Mjd_UTC);
+void   PoleMatrix (double Mjd_UTC, Mat3& Pi);
+void   PoleMatrix (const PropagationContext& Ctx, Mat3& Pi);
+
+//------------------------------------------------------------------------------
+//
+// FrameCache (class definition)
+//
+// Purpose:
+//
+//   Precession-nutation matrix, ecliptic-of-date matrix and equation of the
+//   equinoxes tabulated on a regular grid of epochs (TT) and interpolated
+//   for intermediate times
+//
+// Notes:
+//
+//   The matrices are stored as unit quaternions, which are interpolated by
+//   4-point Lagrange polynomials and normalized. With the default node
+//   spacing of 0.25 d the interpolation error is below 1e-12 rad (about
+//   0.02 mm at GNSS altitudes). Earth rotation (GMST) and polar
+//   motion are cheap and are still evaluated exactly at every epoch.
+//   The cache is filled by the constructor and read-only afterwards, so
+//   that a single instance may be shared by all threads.
+//
+//------------------------------------------------------------------------------
+class FrameCache
+{
+  public:
+
+    // Constructor
+    FrameCache (
+      double Mjd_TT_0,           // Start of the covered interval (TT)
+      double Mjd_TT_1,           // End of the covered interval (TT)
+      double Step = 0.25         // Node spacing [d]
+    );
+
+    // Check whether an epoch lies inside the covered interval
+    bool Covers (double Mjd_TT) const;
+
+    // Interpolated values for given epoch
+    void Get (
+      double  Mjd_TT,            // Modified Julian Date (TT)
+      Mat3&   T,                 // Precession-nutation matrix (N*P)
+      Mat3&   EP,                // ICRS to ecliptic of date (Ecl*P)
+      double& EqE                // Equation of the equinoxes [rad]
+    ) const;
+
+    // Interpolated equation of the equinoxes [rad]
+    double EqE (double Mjd_TT) const;
+
+  private:
+
+    // Node index i and Lagrange weights of the nodes i-1,...,i+2
+    int Weights (double Mjd_TT, double L[4]) const;
+
+    double              Mjd_0;   // Epoch of node 0 (TT)
+    double              h;       // Node spacing [d]
+    int                 n;       // Number of nodes
+    std::vector<double> q_T;     // Quaternions of N*P (4 per node)
+    std::vector<double> q_EP;    // Quaternions of Ecl*P (4 per node)
+    std::vector<double> EqE_;    // Equation of the equinoxes [rad]
+};
+
+//------------------------------------------------------------------------------
+//
+// EarthFrame
+//
+// Purpose:
+//
+//   Time-dependent reference system quantities shared by all acceleration
+//   and coordinate transformation functions at a given epoch
+//
+//------------------------------------------------------------------------------
+struct EarthFrame
+{
+  double Mjd_UT1, Mjd_TT;        // Modified Julian Dates (UT1, TT)
+  Mat3   T;                      // ICRS to true-of-date (N*P)
+  Mat3   EP;                     // ICRS to ecliptic of date (Ecl*P)
+  Mat3   E;                      // ICRS to ITRS (Pi*Theta*N*P)
+  Mat3   dE;                     // Time derivative of E [1/s]
+};
+
+//------------------------------------------------------------------------------
+//
+// ComputeEarthFrame
+//
+// Purpose:
+//
+//   Reference system matrices for a given epoch
+//
+// Input/Output:
+//
+//   Ctx       Propagation context; updated for the given epoch. If its frame
+//             cache covers the epoch, precession, nutation and equation of
+//             the equinoxes are interpolated from the cache.
+//   Mjd_UTC   Modified Julian Date UTC
+//   F         Reference system matrices
+//
+//------------------------------------------------------------------------------
+void ComputeEarthFrame (PropagationContext& Ctx, double Mjd_UTC, EarthFrame& F);
 
 //------------------------------------------------------------------------------
 //
@@ -243,6 +356,9 @@ class Geodetic
     Geodetic (Vector r,                                // Position vector [m]
               double R_equ=R_Earth,                    // Equator radius [m]
               double f    =f_Earth);                   // Flattening
+    Geodetic (const Vec3& r,                           // Position vector [m]
+              double R_equ=R_Earth,                    // Equator radius [m]
+              double f    =f_Earth);                   // Flattening
   
     // Position vector [m] from geodetic coordinates
     Vector Position (double R_equ=R_Earth,             // Equator radius [m]
@@ -313,6 +429,7 @@ void AzEl( const Vector& s, double& A, double& E, Vector& dAds, Vector& dEds );
 //
 // Inputs:
 //
+//  Ctx         Propagation context (optional); updated for the given epoch
 //  Mjd_UTC     Modified Julian Date(UTC)
 //  Y0          Satellite's state vector in ECEF coodinate system
 //
@@ -323,6 +440,8 @@ void AzEl( const Vector& s, double& A, double& E, Vector& dAds, Vector& dEds );
 //
 //--------------------------------------------------------------------------
 Vector ECEF2ECI(double Mjd_UTC, const Vector& Y0);
+Vec6   ECEF2ECI(double Mjd_UTC, const Vec6& Y0);
+Vec6   ECEF2ECI(PropagationContext& Ctx, double Mjd_UTC, const Vec6& Y0);
 
 //--------------------------------------------------------------------------
 //
@@ -331,6 +450,7 @@ Vector ECEF2ECI(double Mjd_UTC, const Vector& Y0);
 //
 // Inputs:
 //
+//  Ctx         Propagation context (optional); updated for the given epoch
 //  Mjd_UTC     Modified Julian Date(UTC)
 //  Y0          Satellite's state vector in ECI coodinate system
 //
@@ -341,6 +461,8 @@ Vector ECEF2ECI(double Mjd_UTC, const Vector& Y0);
 //
 //--------------------------------------------------------------------------
 Vector ECI2ECEF(double Mjd_UTC, const Vector& Y0);
+Vec6   ECI2ECEF(double Mjd_UTC, const Vec6& Y0);
+Vec6   ECI2ECEF(PropagationContext& Ctx, double Mjd_UTC, const Vec6& Y0);
 
 
 #endif  // include-Blocker
\ No newline at end of file
@@ -0,0 +1,166 @@
+//------------------------------------------------------------------------------
+//
+// SAT_SunMoon.cpp
+//
+// Purpose:
+//
+//   Geocentric Sun and Moon positions in the EME2000 system for the force
+//   model (Chebyshev approximation of the analytical series)
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#include <math.h>
+#include <iostream>
+
+#include "SAT_Const.h"
+#include "SAT_Context.h"
+#include "SAT_RefSys.h"
+#include "SAT_SunMoon.h"
+#include "APC_Moon.h"
+#include "APC_Sun.h"
+
+using std::cerr;
+using std::endl;
+
+namespace {
+
+// Rigorous positions (mean ecliptic and equinox of date to EME2000)
+
+Vec3 SunEME2000(double Mjd_TT)
+{
+  Mat3 P, Ecl;
+  PrecMatrix(MJD_J2000,Mjd_TT,P);
+  EclMatrix(Mjd_TT,Ecl);
+  return AU*Transp(Ecl*P)*Vec3(SunPos((Mjd_TT-MJD_J2000)/36525.0));
+}
+
+Vec3 MoonEME2000(double Mjd_TT)
+{
+  Mat3 P, Ecl;
+  PrecMatrix(MJD_J2000,Mjd_TT,P);
+  EclMatrix(Mjd_TT,Ecl);
+  return Transp(Ecl*P)*Vec3(MoonPos((Mjd_TT-MJD_J2000)/36525.0));
+}
+
+}
+
+//------------------------------------------------------------------------------
+//
+// SunMoonCache (class implementation)
+//
+//------------------------------------------------------------------------------
+
+// Constructor
+
+SunMoonCache::SunMoonCache (double Mjd_TT_0, double Mjd_TT_1, double Seg,
+                            int n_coef)
+  : Mjd_0(Mjd_TT_0), h(Seg), N(n_coef)
+{
+  if (Seg<=0.0 || n_coef<2 || Mjd_TT_1<Mjd_TT_0) {
+    cerr << "ERROR: Invalid interval or segment size in SunMoonCache" << endl;
+    exit(1);
+  }
+
+  n_seg = (int)ceil((Mjd_TT_1-Mjd_TT_0)/h);
+  if (n_seg<1) n_seg = 1;
+  seg.reset(new Segment[n_seg]);
+}
+
+// Check whether an epoch lies inside the covered interval
+
+bool SunMoonCache::Covers (double Mjd_TT) const
+{
+  return (Mjd_TT>=Mjd_0 && Mjd_TT<=Mjd_0+n_seg*h);
+}
+
+// Chebyshev coefficients of segment i from the values at the N roots of T_N
+
+void SunMoonCache::Fit (int i, bool moon) const
+{
+  const double t_mid = Mjd_0 + (i+0.5)*h;
+  std::vector<double>& c = (moon ? seg[i].c_moon : seg[i].c_sun);
+  std::vector<Vec3>    f(N);
+
+  for (int j=0; j<N; j++) {
+    double t = t_mid + 0.5*h*cos(pi*(j+0.5)/N);
+    f[j] = (moon ? MoonEME2000(t) : SunEME2000(t));
+  }
+
+  c.assign(3*N,0.0);
+  for (int k=0; k<N; k++) {
+    for (int j=0; j<N; j++) {
+      double w = cos(pi*k*(j+0.5)/N);
+      for (int l=0; l<3; l++) c[3*k+l] += w*f[j](l);
+    }
+    for (int l=0; l<3; l++) c[3*k+l] *= (k==0 ? 1.0 : 2.0)/N;
+  }
+}
+
+// Clenshaw summation for normalized time x in [-1,1]
+
+Vec3 SunMoonCache::Eval (const std::vector<double>& c, double x) const
+{
+  Vec3 r;
+
+  for (int l=0; l<3; l++) {
+    double b_1 = 0.0, b_2 = 0.0, b;
+    for (int k=N-1; k>=1; k--) {
+      b   = 2.0*x*b_1 - b_2 + c[3*k+l];
+      b_2 = b_1;
+      b_1 = b;
+    }
+    r(l) = x*b_1 - b_2 + c[l];
+  }
+  return r;
+}
+
+// Geocentric positions in the EME2000 system [m]
+
+Vec3 SunMoonCache::Sun (double Mjd_TT) const
+{
+  int i = (int)floor((Mjd_TT-Mjd_0)/h);
+  if (i>=n_seg) i = n_seg-1;           // Right end of the interval
+  std::call_once(seg[i].sun_once, &SunMoonCache::Fit, this, i, false);
+  return Eval(seg[i].c_sun, 2.0*(Mjd_TT-Mjd_0-i*h)/h-1.0);
+}
+
+Vec3 SunMoonCache::Moon (double Mjd_TT) const
+{
+  int i = (int)floor((Mjd_TT-Mjd_0)/h);
+  if (i>=n_seg) i = n_seg-1;
+  std::call_once(seg[i].moon_once, &SunMoonCache::Fit, this, i, true);
+  return Eval(seg[i].c_moon, 2.0*(Mjd_TT-Mjd_0-i*h)/h-1.0);
+}
+
+//------------------------------------------------------------------------------
+//
+// SunPosition, MoonPosition
+//
+// Purpose:
+//
+//   Geocentric Sun and Moon positions for the force model
+//
+// Input/Output:
+//
+//   Ctx       Propagation context
+//   F         Reference system matrices of the epoch (ComputeEarthFrame)
+//   <return>  Position in the EME2000 system [m]
+//
+//------------------------------------------------------------------------------
+Vec3 SunPosition(const PropagationContext& Ctx, const EarthFrame& F)
+{
+  if (Ctx.Bodies && Ctx.Bodies->Covers(F.Mjd_TT))
+    return Ctx.Bodies->Sun(F.Mjd_TT);
+
+  return AU*Transp(F.EP)*Vec3(SunPos((F.Mjd_TT-MJD_J2000)/36525.0));
+}
+
+Vec3 MoonPosition(const PropagationContext& Ctx, const EarthFrame& F)
+{
+  if (Ctx.Bodies && Ctx.Bodies->Covers(F.Mjd_TT))
+    return Ctx.Bodies->Moon(F.Mjd_TT);
+
+  return Transp(F.EP)*Vec3(MoonPos((F.Mjd_TT-MJD_J2000)/36525.0));
+}
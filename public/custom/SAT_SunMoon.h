@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+//
+// SAT_SunMoon.h
+//
+// Purpose:
+//
+//   Geocentric Sun and Moon positions in the EME2000 system for the force
+//   model (Chebyshev approximation of the analytical series)
+//
+// Notes:
+//
+//   SunPos and in particular MoonPos evaluate long perturbation series.
+//   SunMoonCache replaces them by piecewise Chebyshev polynomials, which
+//   are fitted segment by segment on first use. Segments are built at most
+//   once (std::call_once), so that one cache may be shared by all
+//   satellites and threads of a propagation. With 2 d segments and 14
+//   coefficients the approximation error (about 0.5 mm for the Moon and
+//   2 cm for the Sun) is at the rounding level of the series themselves.
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#ifndef INC_SAT_SUNMOON_H
+#define INC_SAT_SUNMOON_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "SAT_VecMat.h"
+
+class PropagationContext;
+struct EarthFrame;
+
+//------------------------------------------------------------------------------
+//
+// SunMoonCache (class definition)
+//
+// Purpose:
+//
+//   Piecewise Chebyshev approximation of the geocentric EME2000 positions
+//   of the Sun and Moon over a given time interval
+//
+//------------------------------------------------------------------------------
+class SunMoonCache
+{
+  public:
+
+    // Constructor
+    SunMoonCache (
+      double Mjd_TT_0,           // Start of the covered interval (TT)
+      double Mjd_TT_1,           // End of the covered interval (TT)
+      double Seg   = 2.0,        // Segment length [d]
+      int    n_coef = 14         // Chebyshev coefficients per coordinate
+    );
+
+    // Check whether an epoch lies inside the covered interval
+    bool Covers (double Mjd_TT) const;
+
+    // Geocentric positions in the EME2000 system [m]
+    Vec3 Sun  (double Mjd_TT) const;
+    Vec3 Moon (double Mjd_TT) const;
+
+  private:
+
+    struct Segment {
+      std::once_flag      sun_once, moon_once;
+      std::vector<double> c_sun, c_moon;     // 3*n_coef coefficients
+    };
+
+    void Fit  (int i, bool moon) const;       // Fit of segment i
+    Vec3 Eval (const std::vector<double>& c, double x) const;
+
+    double                     Mjd_0;         // Start epoch (TT)
+    double                     h;             // Segment length [d]
+    int                        n_seg;         // Number of segments
+    int                        N;             // Number of coefficients
+    std::unique_ptr<Segment[]> seg;           // Segments (filled on first use)
+
+    SunMoonCache (const SunMoonCache&);
+    SunMoonCache& operator= (const SunMoonCache&);
+};
+
+//------------------------------------------------------------------------------
+//
+// SunPosition, MoonPosition
+//
+// Purpose:
+//
+//   Geocentric Sun and Moon positions for the force model
+//
+// Input/Output:
+//
+//   Ctx       Propagation context; its SunMoonCache is used if it covers the
+//             epoch, otherwise SunPos/MoonPos are evaluated directly
+//   F         Reference system matrices of the epoch (ComputeEarthFrame)
+//   <return>  Position in the EME2000 system [m]
+//
+//------------------------------------------------------------------------------
+Vec3 SunPosition  (const PropagationContext& Ctx, const EarthFrame& F);
+Vec3 MoonPosition (const PropagationContext& Ctx, const EarthFrame& F);
+
+#endif  // include-Blocker
@@ -18,6 +18,7 @@
 #include <math.h>
 #include <iostream>
 #include <iomanip>
+#include <utility>
 
 #include "SAT_VecMat.h"
 #include "SAT_Const.h"
@@ -59,6 +60,12 @@ Vector::Vector (const Vector& V)               // Vector copy
   for (int i=0; i<V.n; i++) v[i]=V.v[i];
 }
 
+Vector::Vector (Vector&& V)                    // Vector move
+ : n(V.n), v(V.v)
+{
+  V.n = 0; V.v = 0;
+}
+
 Vector::Vector (const double* p, int N)        // Array copy
   : n(N)
 {
@@ -82,6 +89,20 @@ Vector::Vector (double x, double y, double z,   // 6dim-Vector
   v[3]=X; v[4]=Y; v[5]=Z;
 }
 
+Vector::Vector (const Vec3& V)                 // Copy of fixed-size vector
+  : n(3)
+{
+  v = new double [3];
+  for (int i=0; i<3; i++) v[i]=V(i);
+}
+
+Vector::Vector (const Vec6& V)                 // Copy of fixed-size vector
+  : n(6)
+{
+  v = new double [6];
+  for (int i=0; i<6; i++) v[i]=V(i);
+}
+
 Vector::~Vector() 
 { 
   delete [] v; 
@@ -145,6 +166,19 @@ Vector& Vector::operator=(const Vector& V)
   return (*this);
 }
 
+Vector& Vector::operator=(Vector&& V)
+{
+  if (this == &V) return (*this);
+  // Take over the elements of an empty or equally sized vector
+  if (n!=0 && n!=V.n) {
+    cerr << "ERROR: Incompatible sizes in Vector operator=(Vector)" << endl;
+    exit(1);
+  };
+  std::swap(n,V.n);
+  std::swap(v,V.v);
+  return (*this);
+}
+
 // Concatenation
 Vector Stack (const Vector& a, const Vector& b)
 {
@@ -186,25 +220,6 @@ Vector VecPolar (double azim, double elev, double r)
   return Vector(r*cos(azim)*cos(elev),r*sin(azim)*cos(elev),r*sin(elev));
 }
 
-// Vector addition/subtraction with assignment
-void Vector::operator += (const Vector& V)
-{
-  if (n!=V.n) {
-    cerr << "ERROR: Incompatible shape in Vector operator+=(Vector)" << endl;
-    exit(1);
-  };
-  for (int i=0; i<n; i++) v[i]+=V.v[i];
-}
-
-void Vector::operator -= (const Vector& V)
-{
-  if (n!=V.n) {
-    cerr << "ERROR: Incompatible shape in Vector operator-=(Vector)" << endl;
-    exit(1);
-  };
-  for (int i=0; i<n; i++) v[i]-=V.v[i];
-}
-
 // Dot product, norm, cross product
 double Dot (const Vector& left, const Vector& right)
 {
@@ -235,57 +250,6 @@ Vector Cross (const Vector& left, const Vector& right)
   return Result;
 }
 
-// Scalar multiplication and division of a vector
-Vector operator * (double value, const Vector& V)
-{
-  Vector Aux(V.n);
-  for (int i=0; i<V.n; i++) Aux.v[i]=value*V.v[i];
-  return Aux;
-}
-
-Vector operator * (const Vector& V, double value)
-{
-  return value*V;
-}
-
-Vector operator / (const Vector& V, double value)
-{
-  Vector Aux(V.n);
-  for (int i=0; i<V.n; i++) Aux.v[i]=V.v[i]/value;
-  return Aux;
-}
-
-// Negation of a vector (unary minus)
-Vector operator - (const Vector& V)
-{
-  Vector Aux(V.n);
-  for (int i=0; i<V.n; i++) Aux.v[i]=-V.v[i];
-  return Aux;
-}
-
-// Vector addition and subtraction
-Vector operator + (const Vector& left, const Vector& right)
-{
-  if (left.n!=right.n) {
-    cerr << "ERROR: Incompatible shape in +(Vector,Vector)" << endl;
-    exit(1);
-  };
-  Vector Aux(left.n);
-  for (int i=0; i<left.n; i++) Aux.v[i]=left.v[i]+right.v[i];
-  return Aux;
-}
-
-Vector operator - (const Vector& left, const Vector& right)
-{
-  if (left.n!=right.n) {
-    cerr << "ERROR: Incompatible shape in -(Vector,Vector)" << endl;
-    exit(1);
-  };
-  Vector Aux(left.n);
-  for (int i=0; i<left.n; i++) Aux.v[i]=left.v[i]-right.v[i];
-  return Aux;
-}
-
 // Calculate polar components
 void CalcPolarAngles(double& m_phi, double& m_theta, double& m_r, const Vector& m_Vec)
 {
@@ -339,48 +303,48 @@ Matrix::Matrix ()                          // Matrix without elements
 Matrix::Matrix (int dim1, int dim2)        // Nullmatrix of specified shape 
   : n(dim1), m(dim2)
 {
-  int i,j;
-  // Memory allocation
-  M = new double*[dim1];
-  for (i=0; i<dim1; i++) M[i] = new double[dim2];
+  // Memory allocation (single row-major block)
+  M = new double[dim1*dim2];
   // Initialization
-  for (i=0; i<dim1; i++) {
-    for (j=0; j<dim2; j++) M[i][j]=0.0;
-  }
+  for (int i=0; i<dim1*dim2; i++) M[i]=0.0;
 }
 
 Matrix::Matrix (const Matrix& M_)          // Copy
 {
-  int i,j;
   n = M_.n;
   m = M_.m;
   // Memory allocation
-  M = new double*[n];
-  for (i=0; i<n; i++) M[i] = new double[m];
+  M = new double[n*m];
   // Initialization
-  for (i=0; i<n; i++) {
-    for (j=0; j<m; j++) M[i][j]=M_.M[i][j];
-  }
+  for (int i=0; i<n*m; i++) M[i]=M_.M[i];
+}
+
+Matrix::Matrix (Matrix&& M_)               // Move
+  : n(M_.n), m(M_.m), M(M_.M)
+{
+  M_.n = 0; M_.m = 0; M_.M = 0;
 }
 
 Matrix::Matrix (const double* p, int dim1, int dim2)   // Array copy
 {
-  int i,j;
   n = dim1;
   m = dim2;
   // Memory allocation
-  M = new double*[n];
-  for (i=0; i<n; i++) M[i] = new double[m];
+  M = new double[n*m];
   // Initialization
-  for (i=0; i<n; i++) {
-    for (j=0; j<m; j++) M[i][j]=p[i*dim2+j];
-  }
-  
+  for (int i=0; i<n*m; i++) M[i]=p[i];
+}
+
+Matrix::Matrix (const Mat3& M_)                       // Copy of fixed-size matrix
+  : n(3), m(3)
+{
+  M = new double[9];
+  for (int i=0; i<3; i++) 
+    for (int j=0; j<3; j++) M[3*i+j]=M_(i,j);
 }
 
 Matrix::~Matrix() 
 { 
-  for (int i=0; i<n; i++) delete[] M[i];
   delete [] M; 
 };
 
@@ -389,16 +353,14 @@ Matrix& Matrix::resize(int dim1, int dim2) {
   if (n==dim1 && m==dim2) return (*this);
   int    i,j,i_max,j_max;
   // Alocate new matrix
-  double **M_new = new double*[dim1];
-  for (i=0; i<dim1; i++) M_new[i] = new double[dim2];
+  double *M_new = new double[dim1*dim2];
   // Copy existing elements to new matrix; pad with zeroes
   i_max = ((dim1<n)? dim1 : n);
   j_max = ((dim2<m)? dim2 : m);
-  for (i=0;i<i_max;i++)    for (j=0;j<j_max;j++) M_new[i][j]=M[i][j];
-  for (i=i_max;i<dim1;i++) for (j=0;j<dim2 ;j++) M_new[i][j]=0.0;
-  for (i=0;i<i_max;i++) for (j=j_max;j<dim2;j++) M_new[i][j]=0.0;
+  for (i=0;i<i_max;i++)    for (j=0;j<j_max;j++) M_new[i*dim2+j]=M[i*m+j];
+  for (i=i_max;i<dim1;i++) for (j=0;j<dim2 ;j++) M_new[i*dim2+j]=0.0;
+  for (i=0;i<i_max;i++) for (j=j_max;j<dim2;j++) M_new[i*dim2+j]=0.0;
   // Dispose unused memory
-  for (i=0; i<n; i++) delete[] M[i];
   delete [] M; 
   // Copy vector pointer and set dimensions
   M = M_new;
@@ -410,30 +372,38 @@ Matrix& Matrix::resize(int dim1, int dim2) {
 // Assignment
 Matrix& Matrix::operator=(const double value)
 {
-  for (int i=0; i<n; i++) 
-    for (int j=0; j<m; j++) 
-      M[i][j]=value;
+  for (int i=0; i<n*m; i++) M[i]=value;
   return (*this);
 }
 
 Matrix& Matrix::operator=(const Matrix& M_)
 {
-  int i,j;
   if (this == &M_) return (*this);
   // Allocate matrix if still empty
   if (n==0 && m==0) {
     n = M_.n; 
     m = M_.m;
-    M = new double*[n];
-    for (i=0; i<n; i++) M[i] = new double[m];
+    M = new double[n*m];
   };
   if ( (n!=M_.n) || (m!=M_.m) ) {
     cerr << "ERROR: Incompatible shapes in Matrix operator=(Matrix)" << endl;
     exit(1);
   };
-  for (i=0; i<n; i++) 
-    for (j=0; j<m; j++) 
-      M[i][j]=M_.M[i][j];
+  for (int i=0; i<n*m; i++) M[i]=M_.M[i];
+  return (*this);
+}
+
+Matrix& Matrix::operator=(Matrix&& M_)
+{
+  if (this == &M_) return (*this);
+  // Take over the elements of an empty or equally shaped matrix
+  if ( !(n==0 && m==0) && ( (n!=M_.n) || (m!=M_.m) ) ) {
+    cerr << "ERROR: Incompatible shapes in Matrix operator=(Matrix)" << endl;
+    exit(1);
+  };
+  std::swap(n,M_.n);
+  std::swap(m,M_.m);
+  std::swap(M,M_.M);
   return (*this);
 }
 
@@ -441,14 +411,14 @@ Matrix& Matrix::operator=(const Matrix& M_)
 Vector Matrix::Col(int j) const
 {
   Vector Res(n);
-  for (int i=0; i<n; i++)  Res.v[i]=M[i][j];
+  for (int i=0; i<n; i++)  Res.v[i]=M[i*m+j];
   return Res;
 }
 
 Vector Matrix::Row(int i) const
 {
   Vector Res(m);
-  for (int j=0; j<m; j++)  Res.v[j]=M[i][j];
+  for (int j=0; j<m; j++)  Res.v[j]=M[i*m+j];
   return Res;
 }
 
@@ -459,7 +429,7 @@ Vector Matrix::Diag() const
     exit(1);
   };
   Vector Vec(n);
-  for (int i=0; i<n; i++) Vec.v[i] = M[i][i];
+  for (int i=0; i<n; i++) Vec.v[i] = M[i*m+i];
   return Vec;
 }
 
@@ -477,7 +447,7 @@ double Matrix::Trace(int low, int upp) const {
     cerr << "ERROR: Invalid arguments in Matrix.Trace()" << endl;
     exit(1);
   };
-  for (int i=low; i<=upp; i++) tmp += M[i][i];
+  for (int i=low; i<=upp; i++) tmp += M[i*m+i];
   return tmp;
 };
 
@@ -492,7 +462,7 @@ Matrix Matrix::slice(int first_row, int last_row, int first_col, int last_col)
   Matrix Aux(last_row-first_row+1,last_col-first_col+1);
   for (int i=0;i<=last_row-first_row;i++)
     for (int j=0;j<=last_col-first_col;j++)
-       Aux(i,j) = M[i+first_row][j+first_col];
+       Aux(i,j) = M[(i+first_row)*m+(j+first_col)];
   return Aux;
 }
 
@@ -507,7 +477,7 @@ void Matrix::SetCol(int j, const Vector& Col)
     cerr << "ERROR: Column index out of range in Matrix.SetCol()" << endl;
     exit(1);
   };
-  for (int i=0; i<n; i++) M[i][j]=Col(i);
+  for (int i=0; i<n; i++) M[i*m+j]=Col(i);
 }
 
 void Matrix::SetRow(int i, const Vector& Row)
@@ -520,7 +490,7 @@ void Matrix::SetRow(int i, const Vector& Row)
     cerr << "ERROR: Row index out of range in Matrix.SetRow()" << endl;
     exit(1);
   };
-  for (int j=0; j<m; j++) M[i][j]=Row(j);
+  for (int j=0; j<m; j++) M[i*m+j]=Row(j);
 }
 
 // Concatenation
@@ -533,8 +503,8 @@ Matrix operator &(const Matrix& A, const Vector& Row) {
     exit(1);
   };
   for (int j=0;j<m;j++) {
-    for (int i=0;i<n;i++) tmp.M[i][j]=A.M[i][j];
-    tmp.M[n][j] = Row(j);
+    for (int i=0;i<n;i++) tmp.M[i*tmp.m+j]=A.M[i*A.m+j];
+    tmp.M[n*tmp.m+j] = Row(j);
   };
   return tmp;
 }
@@ -548,8 +518,8 @@ Matrix operator &(const Vector& Row, const Matrix& A) {
     exit(1);
   };
   for (int j=0;j<m;j++) {
-    tmp.M[0][j] = Row(j);
-    for (int i=0;i<n;i++) tmp.M[i+1][j]=A.M[i][j];
+    tmp.M[j] = Row(j);
+    for (int i=0;i<n;i++) tmp.M[(i+1)*tmp.m+j]=A.M[i*A.m+j];
   };
   return tmp;
 }
@@ -562,8 +532,8 @@ Matrix operator &(const Matrix& A, const Matrix& B) {
     exit(1);
   };
   for (int j=0;j<A.m;j++) {
-    for (i=0;i<A.n;i++) tmp.M[i    ][j]=A.M[i][j];
-    for (i=0;i<B.n;i++) tmp.M[i+A.n][j]=B.M[i][j];
+    for (i=0;i<A.n;i++) tmp.M[i*tmp.m+j]=A.M[i*A.m+j];
+    for (i=0;i<B.n;i++) tmp.M[(i+A.n)*tmp.m+j]=B.M[i*B.m+j];
   };
   return tmp;
 };
@@ -578,8 +548,8 @@ Matrix operator |(const Matrix& A, const Vector& Col) {
     exit(1);
   };
   for (int i=0;i<n;i++) {
-    for (int j=0;j<m;j++) tmp.M[i][j]=A.M[i][j];
-    tmp.M[i][m] = Col(i);
+    for (int j=0;j<m;j++) tmp.M[i*tmp.m+j]=A.M[i*A.m+j];
+    tmp.M[i*tmp.m+m] = Col(i);
   };
   return tmp;
 }
@@ -593,8 +563,8 @@ Matrix operator |(const Vector& Col, const Matrix& A) {
     exit(1);
   };
   for (int i=0;i<n;i++) {
-    tmp.M[i][0] = Col(i);
-    for (int j=0;j<m;j++) tmp.M[i][j+1]=A.M[i][j];
+    tmp.M[i*tmp.m] = Col(i);
+    for (int j=0;j<m;j++) tmp.M[i*tmp.m+(j+1)]=A.M[i*A.m+j];
   };
   return tmp;
 };
@@ -608,8 +578,8 @@ Matrix operator |(const Matrix& A, const Matrix& B) {
     exit(1);
   };
   for (int i=0;i<A.n;i++) {
-    for (j=0;j<A.m;j++) tmp.M[i][j    ]=A.M[i][j];
-    for (j=0;j<B.m;j++) tmp.M[i][j+A.m]=B.M[i][j];
+    for (j=0;j<A.m;j++) tmp.M[i*tmp.m+j]=A.M[i*A.m+j];
+    for (j=0;j<B.m;j++) tmp.M[i*tmp.m+(j+A.m)]=B.M[i*B.m+j];
   };
   return tmp;
 
@@ -623,9 +593,7 @@ void Matrix::operator += (const Matrix& M)
     cerr << "ERROR: Incompatible shape in Matrix operator+=(Matrix)" << endl;
     exit(1);
   };
-  for (int i=0; i<n; i++) 
-    for (int j=0; j<m; j++) 
-      this->M[i][j]+=M.M[i][j];
+  for (int i=0; i<n*m; i++) this->M[i]+=M.M[i];
 }
 
 void Matrix::operator -= (const Matrix& M)
@@ -634,16 +602,14 @@ void Matrix::operator -= (const Matrix& M)
     cerr << "ERROR: Incompatible shape in Matrix operator-=(Matrix)" << endl;
     exit(1);
   };
-  for (int i=0; i<n; i++) 
-    for (int j=0; j<m; j++) 
-      this->M[i][j]-=M.M[i][j];
+  for (int i=0; i<n*m; i++) this->M[i]-=M.M[i];
 }
 
 // Unit matrix
 Matrix Id(int Size)
 {
   Matrix Aux(Size,Size);      
-  for (int i=0; i<Size; i++) Aux.M[i][i] = 1.0;
+  for (int i=0; i<Size; i++) Aux.M[i*Aux.m+i] = 1.0;
   return Aux;
 }
 
@@ -651,7 +617,7 @@ Matrix Id(int Size)
 Matrix Diag(const Vector& Vec)
 {
   Matrix Mat(Vec.n,Vec.n);
-  for (int i=0; i<Vec.n; i++) Mat.M[i][i] = Vec.v[i];
+  for (int i=0; i<Vec.n; i++) Mat.M[i*Mat.m+i] = Vec.v[i];
   return Mat;
 }
 
@@ -661,9 +627,9 @@ Matrix R_x(double Angle)
   const double C = cos(Angle);
   const double S = sin(Angle);
   Matrix U(3,3);
-  U.M[0][0] = 1.0;  U.M[0][1] = 0.0;  U.M[0][2] = 0.0;
-  U.M[1][0] = 0.0;  U.M[1][1] =  +C;  U.M[1][2] =  +S;
-  U.M[2][0] = 0.0;  U.M[2][1] =  -S;  U.M[2][2] =  +C;
+  U.M[0] = 1.0;  U.M[1] = 0.0;  U.M[2] = 0.0;
+  U.M[3] = 0.0;  U.M[4] =  +C;  U.M[5] =  +S;
+  U.M[6] = 0.0;  U.M[7] =  -S;  U.M[8] =  +C;
   return U;
 }
 
@@ -672,9 +638,9 @@ Matrix R_y(double Angle)
   const double C = cos(Angle);
   const double S = sin(Angle);
   Matrix U(3,3);
-  U.M[0][0] =  +C;  U.M[0][1] = 0.0;  U.M[0][2] =  -S;
-  U.M[1][0] = 0.0;  U.M[1][1] = 1.0;  U.M[1][2] = 0.0;
-  U.M[2][0] =  +S;  U.M[2][1] = 0.0;  U.M[2][2] =  +C;
+  U.M[0] =  +C;  U.M[1] = 0.0;  U.M[2] =  -S;
+  U.M[3] = 0.0;  U.M[4] = 1.0;  U.M[5] = 0.0;
+  U.M[6] =  +S;  U.M[7] = 0.0;  U.M[8] =  +C;
   return U;
 }
 
@@ -683,9 +649,9 @@ Matrix R_z(double Angle)
   const double C = cos(Angle);
   const double S = sin(Angle);
   Matrix U(3,3);
-  U.M[0][0] =  +C;  U.M[0][1] =  +S;  U.M[0][2] = 0.0;
-  U.M[1][0] =  -S;  U.M[1][1] =  +C;  U.M[1][2] = 0.0;
-  U.M[2][0] = 0.0;  U.M[2][1] = 0.0;  U.M[2][2] = 1.0;
+  U.M[0] =  +C;  U.M[1] =  +S;  U.M[2] = 0.0;
+  U.M[3] =  -S;  U.M[4] =  +C;  U.M[5] = 0.0;
+  U.M[6] = 0.0;  U.M[7] = 0.0;  U.M[8] = 1.0;
   return U;
 }
 
@@ -695,7 +661,7 @@ Matrix Transp(const Matrix& Mat)
   Matrix T(Mat.m,Mat.n);
   for ( int i=0; i<T.n; i++ )
     for ( int j=0; j<T.m; j++ )
-      T.M[i][j] = Mat.M[j][i];
+      T.M[i*T.m+j] = Mat.M[j*Mat.m+i];
   return T;
 }
 
@@ -729,9 +695,7 @@ Matrix Inv(const Matrix& Mat)
 Matrix operator * (double value, const Matrix& Mat)
 {
   Matrix Aux(Mat.n,Mat.m);
-  for (int i=0; i<Mat.n; i++) 
-    for (int j=0; j<Mat.m; j++) 
-      Aux.M[i][j]=value*Mat.M[i][j];
+  for (int i=0; i<Mat.n*Mat.m; i++) Aux.M[i]=value*Mat.M[i];
   return Aux;
 }
 
@@ -743,9 +707,7 @@ Matrix operator * (const Matrix& Mat, double value)
 Matrix operator / (const Matrix& Mat, double value)
 {
   Matrix Aux(Mat.n,Mat.m);
-  for (int i=0; i<Mat.n; i++) 
-    for (int j=0; j<Mat.m; j++) 
-      Aux.M[i][j]=Mat.M[i][j]/value;
+  for (int i=0; i<Mat.n*Mat.m; i++) Aux.M[i]=Mat.M[i]/value;
   return Aux;
 }
 
@@ -753,9 +715,7 @@ Matrix operator / (const Matrix& Mat, double value)
 Matrix operator - (const Matrix& Mat)
 {
   Matrix Aux(Mat.n,Mat.m);
-  for (int i=0; i<Mat.n; i++) 
-    for (int j=0; j<Mat.m; j++) 
-      Aux.M[i][j]=-Mat.M[i][j];
+  for (int i=0; i<Mat.n*Mat.m; i++) Aux.M[i]=-Mat.M[i];
   return Aux;
 }
 
@@ -767,9 +727,7 @@ Matrix operator + (const Matrix& left, const Matrix& right)
     exit(1);
   };
   Matrix Aux(left.n,left.m);
-  for (int i=0; i<left.n; i++) 
-    for (int j=0; j<left.m; j++) 
-      Aux.M[i][j] = left.M[i][j] + right.M[i][j];
+  for (int i=0; i<left.n*left.m; i++) Aux.M[i] = left.M[i] + right.M[i];
   return Aux;
 }
 
@@ -780,9 +738,7 @@ Matrix operator - (const Matrix& left, const Matrix& right)
     exit(1);
   };
   Matrix Aux(left.n,left.m);
-  for (int i=0; i<left.n; i++) 
-    for (int j=0; j<left.m; j++) 
-      Aux.M[i][j] = left.M[i][j] - right.M[i][j];
+  for (int i=0; i<left.n*left.m; i++) Aux.M[i] = left.M[i] - right.M[i];
   return Aux;
 }
 
@@ -799,8 +755,8 @@ Matrix operator * (const Matrix& left, const Matrix& right)
     for (int j=0; j<right.m; j++) {
       Sum = 0.0;
       for (int k=0; k<left.m; k++) 
-        Sum += left.M[i][k] * right.M[k][j];
-      Aux.M[i][j] = Sum;
+        Sum += left.M[i*left.m+k] * right.M[k*right.m+j];
+      Aux.M[i*Aux.m+j] = Sum;
     }
   return Aux;
 }
@@ -817,7 +773,7 @@ Vector operator * (const Matrix& Mat, const Vector& Vec)
   for (int i=0; i<Mat.n; i++) {
     Sum = 0.0;
     for (int j=0; j<Mat.m; j++) 
-      Sum += Mat.M[i][j] * Vec.v[j];
+      Sum += Mat.M[i*Mat.m+j] * Vec.v[j];
     Aux.v[i] = Sum;
   }
   return Aux;
@@ -834,7 +790,7 @@ Vector operator * (const Vector& Vec, const Matrix& Mat)
   for (int j=0; j<Mat.m; j++) {
     Sum = 0.0;
     for (int i=0; i<Mat.n; i++) 
-      Sum += Vec.v[i] * Mat.M[i][j];
+      Sum += Vec.v[i] * Mat.M[i*Mat.m+j];
     Aux.v[j] = Sum;
   }
   return Aux;
@@ -846,7 +802,7 @@ Matrix Dyadic (const Vector& left, const Vector& right)
   Matrix Mat(left.n,right.n);
   for (int i=0;i<left.n;i++)
     for (int j=0;j<right.n;j++)
-      Mat.M[i][j] = left.v[i]*right.v[j];
+      Mat.M[i*Mat.m+j] = left.v[i]*right.v[j];
   return Mat;
 }
 
@@ -862,6 +818,67 @@ ostream& operator << (ostream& os, const Matrix& Mat)
   return os;
 }
 
+//------------------------------------------------------------------------------
+//
+// Vec3, Vec6, Mat3 (class implementation)
+//
+// Purpose:
+//
+//   Conversions from the dynamically sized types and output; all other 
+//   operations are implemented inline in SAT_VecMat.h
+//
+//------------------------------------------------------------------------------
+
+Vec3::Vec3 (const Vector& V)                   // Copy of 3dim-Vector
+{
+  if (V.size()!=3) {
+    cerr << "ERROR: Incompatible size in Vec3(Vector)" << endl;
+    exit(1);
+  };
+  v[0]=V(0); v[1]=V(1); v[2]=V(2);
+}
+
+Vec6::Vec6 (const Vector& V)                   // Copy of 6dim-Vector
+{
+  if (V.size()!=6) {
+    cerr << "ERROR: Incompatible size in Vec6(Vector)" << endl;
+    exit(1);
+  };
+  for (int i=0; i<6; i++) v[i]=V(i);
+}
+
+Mat3::Mat3 (const Matrix& M_)                  // Copy of 3x3 Matrix
+{
+  if ( (M_.size1()!=3) || (M_.size2()!=3) ) {
+    cerr << "ERROR: Incompatible shape in Mat3(Matrix)" << endl;
+    exit(1);
+  };
+  for (int i=0; i<3; i++)
+    for (int j=0; j<3; j++)
+      M[3*i+j]=M_(i,j);
+}
+
+// Vector output
+ostream& operator << (ostream& os, const Vec3& Vec)
+{
+  int w = os.width();
+  for (int i=0; i<3; i++)
+    os << setw(w) << Vec(i);
+  return os;
+}
+
+// Matrix output
+ostream& operator << (ostream& os, const Mat3& Mat)
+{
+  int w = os.width();
+  for (int i=0; i<3; i++) {
+    for (int j=0; j<3; j++)
+      os << setw(w) << Mat(i,j);
+    os << endl;
+  }
+  return os;
+}
+
 //------------------------------------------------------------------------------
 //
 // Basic Linear Algebra
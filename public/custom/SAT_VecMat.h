@@ -29,6 +29,8 @@
 #ifndef INC_SAT_VECMAT_H
 #define INC_SAT_VECMAT_H
 
+#include <math.h>
+#include <stdlib.h>
 #include <iostream>
 #include <stdexcept>
 
@@ -46,6 +48,9 @@
 // 前向声明 Vector 和 Matrix 类
 class Vector;
 // class Matrix;
+class Vec3;
+class Vec6;
+class Mat3;
 
 class Matrix
 {
@@ -56,7 +61,9 @@ class Matrix
     Matrix ();                                      // Matrix without elements
     Matrix (int dim1, int dim2);                    // Nullmatrix 
     Matrix (const Matrix& M_);                      // Matrix copy
+    Matrix (Matrix&& M_);                           // Matrix move
     Matrix (const double* p, int dim1, int dim2);   // Array copy
+    explicit Matrix (const Mat3& M_);               // Copy of fixed-size matrix
 
     // Destructor
     ~Matrix();
@@ -64,6 +71,7 @@ class Matrix
     // Assignment
     Matrix& operator=(const double value);
     Matrix& operator=(const Matrix& M_);
+    Matrix& operator=(Matrix&& M_);
 
     // Size
     int size1() const { return n; };
@@ -71,8 +79,14 @@ class Matrix
     Matrix& resize(int dim1, int dim2);
     
     // Component access (Fortran notation)
-    double  operator () (int i, int j) const { return M[i][j]; };   
-    double& operator () (int i, int j)       { return M[i][j]; };   
+    double  operator () (int i, int j) const { return M[i*m+j]; };   
+    double& operator () (int i, int j)       { return M[i*m+j]; };   
+
+    // Contiguous row-major element storage, e.g. for use with
+    // Eigen::Map<Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,
+    // Eigen::RowMajor> >(data(),size1(),size2())
+    const double* data() const { return M; };
+    double*       data()       { return M; };
     Vector Col(int j) const;      
     Vector Row(int i) const;      
     Vector Diag() const;
@@ -139,11 +153,28 @@ class Matrix
     // Elements
     int      n;                       // First dimension (number of rows)
     int      m;                       // Second dimension (number of columns)
-    double **M;                       // Matrix M(n,m)
+    double  *M;                       // Matrix M(n,m), row-major
 
 };
 
-class Vector
+// Base class of all vector expressions (curiously recurring template
+// pattern). Arithmetic on vectors yields lightweight expression objects,
+// which are evaluated element by element in a single loop upon assignment
+// to a Vector; no temporary vectors are allocated.
+
+template <class E> class VecExpr
+{
+  public:
+    const E& self() const { return static_cast<const E&>(*this); };
+    int    size() const          { return self().size(); };
+    double operator () (int i) const { return self()(i); };
+};
+
+// Vectors are referenced by expressions, inner expressions are copied
+template <class E> struct VecExprRef         { typedef const E       type; };
+template <>        struct VecExprRef<Vector> { typedef const Vector& type; };
+
+class Vector : public VecExpr<Vector>
 {
 
   public:
@@ -154,10 +185,15 @@ class Vector
     Vector ();                              // Vector without elements
     Vector (int Size);                      // Nullvector of specified size 
     Vector (const Vector& V);               // Vector copy
+    Vector (Vector&& V);                    // Vector move
     Vector (const double* p, int N);        // Array copy
     Vector (double x, double y, double z);  // 3dim-Vector
     Vector (double x, double y, double z,   // 6dim-Vector
             double X, double Y, double Z);  
+    explicit Vector (const Vec3& V);        // Copy of fixed-size vectors
+    explicit Vector (const Vec6& V);
+    template <class E>
+    Vector (const VecExpr<E>& V);           // Evaluation of an expression
 
     // Destructor
     ~Vector();
@@ -169,10 +205,17 @@ class Vector
     // Assignment
     Vector& operator=(const double value);
     Vector& operator=(const Vector& V);
+    Vector& operator=(Vector&& V);
+    template <class E>
+    Vector& operator=(const VecExpr<E>& V);
 
     // Component access (Fortran notation)
     double  operator () (int i) const { return v[i]; };
     double& operator () (int i)       { return v[i]; };
+
+    // Contiguous element storage (e.g. for Eigen::Map<Eigen::VectorXd>)
+    const double* data() const { return v; };
+    double*       data()       { return v; };
     Vector slice (int first, int last) const;
 
     // Square root of vector elements
@@ -189,25 +232,16 @@ class Vector
     friend Vector VecPolar (double azim, double elev, double r);
 
     // Vector addition/subtraction with assignment
-    void operator += (const Vector& V);
-    void operator -= (const Vector& V);
+    template <class E> void operator += (const VecExpr<E>& V);
+    template <class E> void operator -= (const VecExpr<E>& V);
     
     // Dot product, norm, cross product
     friend double Dot (const Vector& left, const Vector& right);
     friend double Norm (const Vector& V);
     friend Vector Cross (const Vector& left, const Vector& right);
 
-    // Scalar multiplication and division of a vector
-    friend Vector operator * (double value, const Vector& V);
-    friend Vector operator * (const Vector& V, double value);
-    friend Vector operator / (const Vector& V, double value);
-
-    // Negation of a vector (unary minus)
-    friend Vector operator - (const Vector& V);
-
-    // Vector addition and subtraction
-    friend Vector operator + (const Vector& left, const Vector& right);    
-    friend Vector operator - (const Vector& left, const Vector& right);    
+    // Scalar multiplication/division, negation, addition and subtraction
+    // of vectors are provided by the expression templates below
     
     // Diagonal matrix
     friend Matrix Diag(const Vector& Vec);
@@ -232,6 +266,182 @@ class Vector
 
 Vector VecPolar (double azim, double elev, double r);
 
+
+//------------------------------------------------------------------------------
+//
+// Vector expressions (template definitions)
+//
+// Purpose:
+//
+//   Lazy evaluation of element-wise vector arithmetic. An expression like
+//   y+(h/6.0)*(k_1+2.0*k_2+2.0*k_3+k_4) is represented by a tree of small
+//   expression objects and evaluated in a single loop without intermediate
+//   storage when it is assigned to a Vector.
+//
+//------------------------------------------------------------------------------
+
+// Incompatible operands
+
+inline void VecExprShapeError(const char* Op)
+{
+  std::cerr << "ERROR: Incompatible shape in " << Op << "(Vector,Vector)" 
+            << std::endl;
+  exit(1);
+}
+
+// Vector addition
+
+template <class L, class R>
+class VecSum : public VecExpr< VecSum<L,R> >
+{
+  public:
+    VecSum(const L& l_, const R& r_) : l(l_), r(r_)
+    { if (l.size()!=r.size()) VecExprShapeError("+"); };
+    int    size() const { return l.size(); };
+    double operator () (int i) const { return l(i)+r(i); };
+  private:
+    typename VecExprRef<L>::type l;
+    typename VecExprRef<R>::type r;
+};
+
+// Vector subtraction
+
+template <class L, class R>
+class VecDiff : public VecExpr< VecDiff<L,R> >
+{
+  public:
+    VecDiff(const L& l_, const R& r_) : l(l_), r(r_)
+    { if (l.size()!=r.size()) VecExprShapeError("-"); };
+    int    size() const { return l.size(); };
+    double operator () (int i) const { return l(i)-r(i); };
+  private:
+    typename VecExprRef<L>::type l;
+    typename VecExprRef<R>::type r;
+};
+
+// Scalar multiplication
+
+template <class E>
+class VecScale : public VecExpr< VecScale<E> >
+{
+  public:
+    VecScale(double a_, const E& e_) : a(a_), e(e_) {};
+    int    size() const { return e.size(); };
+    double operator () (int i) const { return a*e(i); };
+  private:
+    double                       a;
+    typename VecExprRef<E>::type e;
+};
+
+// Scalar division
+
+template <class E>
+class VecQuot : public VecExpr< VecQuot<E> >
+{
+  public:
+    VecQuot(const E& e_, double a_) : e(e_), a(a_) {};
+    int    size() const { return e.size(); };
+    double operator () (int i) const { return e(i)/a; };
+  private:
+    typename VecExprRef<E>::type e;
+    double                       a;
+};
+
+// Negation (unary minus)
+
+template <class E>
+class VecNeg : public VecExpr< VecNeg<E> >
+{
+  public:
+    VecNeg(const E& e_) : e(e_) {};
+    int    size() const { return e.size(); };
+    double operator () (int i) const { return -e(i); };
+  private:
+    typename VecExprRef<E>::type e;
+};
+
+// Operators
+
+template <class L, class R>
+inline VecSum<L,R> operator + (const VecExpr<L>& left, const VecExpr<R>& right)
+{ return VecSum<L,R>(left.self(),right.self()); }
+
+template <class L, class R>
+inline VecDiff<L,R> operator - (const VecExpr<L>& left, const VecExpr<R>& right)
+{ return VecDiff<L,R>(left.self(),right.self()); }
+
+template <class E>
+inline VecScale<E> operator * (double value, const VecExpr<E>& V)
+{ return VecScale<E>(value,V.self()); }
+
+template <class E>
+inline VecScale<E> operator * (const VecExpr<E>& V, double value)
+{ return VecScale<E>(value,V.self()); }
+
+template <class E>
+inline VecQuot<E> operator / (const VecExpr<E>& V, double value)
+{ return VecQuot<E>(V.self(),value); }
+
+template <class E>
+inline VecNeg<E> operator - (const VecExpr<E>& V)
+{ return VecNeg<E>(V.self()); }
+
+// Evaluation of expressions
+
+template <class E>
+Vector::Vector (const VecExpr<E>& V)
+ : n(V.size())
+{
+  const E& X = V.self();
+  v = new double [n];
+  for (int i=0; i<n; i++) v[i]=X(i);
+}
+
+template <class E>
+Vector& Vector::operator=(const VecExpr<E>& V)
+{
+  const E& X = V.self();
+  // Allocate vector if still empty
+  if (n==0) {
+    n = X.size(); 
+    v = new double [n];
+  };
+  // Check dimension
+  if (n!=X.size()) {
+    std::cerr << "ERROR: Incompatible sizes in Vector operator=(Vector)" 
+              << std::endl;
+    exit(1);
+  };
+  // Element-wise evaluation; expressions only access element i when 
+  // computing element i, so the target may appear on the right-hand side
+  for (int i=0; i<n; i++) v[i]=X(i);
+  return (*this);
+}
+
+template <class E>
+void Vector::operator += (const VecExpr<E>& V)
+{
+  const E& X = V.self();
+  if (n!=X.size()) {
+    std::cerr << "ERROR: Incompatible shape in Vector operator+=(Vector)" 
+              << std::endl;
+    exit(1);
+  };
+  for (int i=0; i<n; i++) v[i]+=X(i);
+}
+
+template <class E>
+void Vector::operator -= (const VecExpr<E>& V)
+{
+  const E& X = V.self();
+  if (n!=X.size()) {
+    std::cerr << "ERROR: Incompatible shape in Vector operator-=(Vector)" 
+              << std::endl;
+    exit(1);
+  };
+  for (int i=0; i<n; i++) v[i]-=X(i);
+}
+
 // Calculate polar components
 void CalcPolarAngles(double& m_phi, double& m_theta, double& m_r, const Vector& m_Vec);
 
@@ -248,6 +458,287 @@ void CalcPolarAngles(double& m_phi, double& m_theta, double& m_r, const Vector&
 
 
 
+//------------------------------------------------------------------------------
+//
+// Vec3, Vec6, Mat3 (class definitions)
+//
+// Purpose:
+//
+//   Fixed-size vector and matrix types for positions, states and rotation
+//   matrices. Elements are held in plain arrays, so that objects live on
+//   the stack and no heap allocation takes place in the force model and 
+//   reference system computations. All operations are inline.
+//
+//------------------------------------------------------------------------------
+
+class Vec3
+{
+
+  public:
+
+    // Constructors
+    Vec3 ()                               { v[0]=v[1]=v[2]=0.0; };
+    Vec3 (double x, double y, double z)   { v[0]=x; v[1]=y; v[2]=z; };
+    explicit Vec3 (const Vector& V);      // Copy of 3dim-Vector
+
+    // Size
+    int size() const { return 3; };
+
+    // Component access (Fortran notation)
+    double  operator () (int i) const { return v[i]; };
+    double& operator () (int i)       { return v[i]; };
+
+    // Vector addition/subtraction with assignment
+    void operator += (const Vec3& V) { v[0]+=V.v[0]; v[1]+=V.v[1]; v[2]+=V.v[2]; };
+    void operator -= (const Vec3& V) { v[0]-=V.v[0]; v[1]-=V.v[1]; v[2]-=V.v[2]; };
+
+    // Dot product, norm, cross product
+    friend double Dot (const Vec3& left, const Vec3& right);
+    friend double Norm (const Vec3& V);
+    friend Vec3   Cross (const Vec3& left, const Vec3& right);
+
+    // Scalar multiplication and division of a vector
+    friend Vec3 operator * (double value, const Vec3& V);
+    friend Vec3 operator * (const Vec3& V, double value);
+    friend Vec3 operator / (const Vec3& V, double value);
+
+    // Negation of a vector (unary minus)
+    friend Vec3 operator - (const Vec3& V);
+
+    // Vector addition and subtraction
+    friend Vec3 operator + (const Vec3& left, const Vec3& right);
+    friend Vec3 operator - (const Vec3& left, const Vec3& right);
+
+    // Vector/matrix product
+    friend Vec3 operator * (const Mat3& Mat, const Vec3& Vec);
+
+  private:
+
+    // Elements
+    double v[3];
+
+};
+
+class Vec6
+{
+
+  public:
+
+    // Constructors
+    Vec6 ()                               { for (int i=0; i<6; i++) v[i]=0.0; };
+    Vec6 (double x, double y, double z,   
+          double X, double Y, double Z)   { v[0]=x; v[1]=y; v[2]=z;
+                                            v[3]=X; v[4]=Y; v[5]=Z; };
+    explicit Vec6 (const Vector& V);      // Copy of 6dim-Vector
+
+    // Size
+    int size() const { return 6; };
+
+    // Component access (Fortran notation)
+    double  operator () (int i) const { return v[i]; };
+    double& operator () (int i)       { return v[i]; };
+
+    // Position and velocity part of a state vector
+    Vec3 Pos() const { return Vec3(v[0],v[1],v[2]); };
+    Vec3 Vel() const { return Vec3(v[3],v[4],v[5]); };
+
+    // Concatenation
+    friend Vec6 Stack (const Vec3& a, const Vec3& b);
+
+  private:
+
+    // Elements
+    double v[6];
+
+};
+
+class Mat3
+{
+
+  public:
+
+    // Constructors
+    Mat3 ()                               { for (int i=0; i<9; i++) M[i]=0.0; };
+    explicit Mat3 (const Matrix& M_);     // Copy of 3x3 Matrix
+
+    // Size
+    int size1() const { return 3; };
+    int size2() const { return 3; };
+
+    // Component access (Fortran notation)
+    double  operator () (int i, int j) const { return M[3*i+j]; };
+    double& operator () (int i, int j)       { return M[3*i+j]; };
+
+    // Unit matrix
+    friend Mat3 Id3 ();
+
+    // Elementary rotations
+    friend void R_x (double Angle, Mat3& U);
+    friend void R_y (double Angle, Mat3& U);
+    friend void R_z (double Angle, Mat3& U);
+
+    // Transposition
+    friend Mat3 Transp (const Mat3& Mat);
+
+    // Scalar multiplication of a matrix
+    friend Mat3 operator * (double value, const Mat3& Mat);
+
+    // Matrix product
+    friend Mat3 operator * (const Mat3& left, const Mat3& right);
+
+    // Vector/matrix product
+    friend Vec3 operator * (const Mat3& Mat, const Vec3& Vec);
+
+  private:
+
+    // Elements
+    double M[9];                      // Matrix M(3,3), row-major
+
+};
+
+//------------------------------------------------------------------------------
+//
+// Vec3, Vec6, Mat3 (inline implementation)
+//
+//------------------------------------------------------------------------------
+
+// Dot product, norm, cross product
+inline double Dot (const Vec3& left, const Vec3& right)
+{
+  return left.v[0]*right.v[0]+left.v[1]*right.v[1]+left.v[2]*right.v[2];
+}
+
+inline double Norm (const Vec3& V)
+{
+  return sqrt(Dot(V,V));
+}
+
+inline Vec3 Cross (const Vec3& left, const Vec3& right)
+{
+  return Vec3 ( left.v[1]*right.v[2] - left.v[2]*right.v[1],
+                left.v[2]*right.v[0] - left.v[0]*right.v[2],
+                left.v[0]*right.v[1] - left.v[1]*right.v[0] );
+}
+
+// Scalar multiplication and division of a vector
+inline Vec3 operator * (double value, const Vec3& V)
+{
+  return Vec3 ( value*V.v[0], value*V.v[1], value*V.v[2] );
+}
+
+inline Vec3 operator * (const Vec3& V, double value)
+{
+  return value*V;
+}
+
+inline Vec3 operator / (const Vec3& V, double value)
+{
+  return Vec3 ( V.v[0]/value, V.v[1]/value, V.v[2]/value );
+}
+
+// Negation of a vector (unary minus)
+inline Vec3 operator - (const Vec3& V)
+{
+  return Vec3 ( -V.v[0], -V.v[1], -V.v[2] );
+}
+
+// Vector addition and subtraction
+inline Vec3 operator + (const Vec3& left, const Vec3& right)
+{
+  return Vec3 ( left.v[0]+right.v[0], left.v[1]+right.v[1], left.v[2]+right.v[2] );
+}
+
+inline Vec3 operator - (const Vec3& left, const Vec3& right)
+{
+  return Vec3 ( left.v[0]-right.v[0], left.v[1]-right.v[1], left.v[2]-right.v[2] );
+}
+
+// Concatenation
+inline Vec6 Stack (const Vec3& a, const Vec3& b)
+{
+  return Vec6 ( a(0), a(1), a(2), b(0), b(1), b(2) );
+}
+
+// Unit matrix
+inline Mat3 Id3 ()
+{
+  Mat3 U;
+  U.M[0] = U.M[4] = U.M[8] = 1.0;
+  return U;
+}
+
+// Elementary rotations
+inline void R_x (double Angle, Mat3& U)
+{
+  const double C = cos(Angle);
+  const double S = sin(Angle);
+  U.M[0] = 1.0;  U.M[1] = 0.0;  U.M[2] = 0.0;
+  U.M[3] = 0.0;  U.M[4] =  +C;  U.M[5] =  +S;
+  U.M[6] = 0.0;  U.M[7] =  -S;  U.M[8] =  +C;
+}
+
+inline void R_y (double Angle, Mat3& U)
+{
+  const double C = cos(Angle);
+  const double S = sin(Angle);
+  U.M[0] =  +C;  U.M[1] = 0.0;  U.M[2] =  -S;
+  U.M[3] = 0.0;  U.M[4] = 1.0;  U.M[5] = 0.0;
+  U.M[6] =  +S;  U.M[7] = 0.0;  U.M[8] =  +C;
+}
+
+inline void R_z (double Angle, Mat3& U)
+{
+  const double C = cos(Angle);
+  const double S = sin(Angle);
+  U.M[0] =  +C;  U.M[1] =  +S;  U.M[2] = 0.0;
+  U.M[3] =  -S;  U.M[4] =  +C;  U.M[5] = 0.0;
+  U.M[6] = 0.0;  U.M[7] = 0.0;  U.M[8] = 1.0;
+}
+
+// Transposition
+inline Mat3 Transp (const Mat3& Mat)
+{
+  Mat3 T;
+  for (int i=0; i<3; i++)
+    for (int j=0; j<3; j++)
+      T.M[3*i+j] = Mat.M[3*j+i];
+  return T;
+}
+
+// Scalar multiplication of a matrix
+inline Mat3 operator * (double value, const Mat3& Mat)
+{
+  Mat3 Aux;
+  for (int i=0; i<9; i++) Aux.M[i] = value*Mat.M[i];
+  return Aux;
+}
+
+// Matrix product
+inline Mat3 operator * (const Mat3& left, const Mat3& right)
+{
+  Mat3 Aux;
+  for (int i=0; i<3; i++)
+    for (int j=0; j<3; j++)
+      Aux.M[3*i+j] = left.M[3*i  ]*right.M[  j] 
+                   + left.M[3*i+1]*right.M[3+j] 
+                   + left.M[3*i+2]*right.M[6+j];
+  return Aux;
+}
+
+// Vector/matrix product
+inline Vec3 operator * (const Mat3& Mat, const Vec3& Vec)
+{
+  const double* M = Mat.M;
+  return Vec3 ( M[0]*Vec.v[0] + M[1]*Vec.v[1] + M[2]*Vec.v[2],
+                M[3]*Vec.v[0] + M[4]*Vec.v[1] + M[5]*Vec.v[2],
+                M[6]*Vec.v[0] + M[7]*Vec.v[1] + M[8]*Vec.v[2] );
+}
+
+// Output
+std::ostream& operator << (std::ostream& os, const Vec3& Vec);
+std::ostream& operator << (std::ostream& os, const Mat3& Mat);
+
+
 //------------------------------------------------------------------------------
 //
 // Basic Linear Algebra
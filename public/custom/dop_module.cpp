@@ -1,4 +1,6 @@
 #include "dop_module.h"
+#include "SAT_Parallel.h"
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <fstream>
@@ -79,38 +81,91 @@ Vector3d LatLonAltToECEF(double lat_deg, double lon_deg, double alt_km) {
     return Vector3d(x, y, z);
 }
 
-double CalcElevation(const Vector3d& sat_pos, const Vector3d& gs_pos) {
-    Vector3d los = sat_pos - gs_pos;
-    double range = los.norm();
-    Vector3d los_unit = los / range;
-    Vector3d up = gs_pos.normalized();
-    double cos_elev = los_unit.dot(up);
-    return asin(cos_elev) * RAD2DEG;
-}
+// 一个网格点的各项 DOP 值
+struct DOPValues {
+    double gdop, pdop, hdop, vdop, tdop;
+};
+
+// 由法方程矩阵 N = Σ [u 1]^T [u 1]（u 为测站到卫星的单位向量）闭式求 DOP。
+// N 只用到上三角；对 4x4 对称矩阵做 LDL^T 分解，Q = N^-1 = L^-T D^-1 L^-1。
+// VDOP 取位置协方差在天顶方向 up 上的分量，HDOP 由迹的不变性得到。
+// 几何退化（主元不为正）时返回 false
+static bool SolveDOP(const double N[4][4], const Vector3d& up, DOPValues& dop) {
+    double L[4][4] = {}, d[4], W[4][4] = {}, Q[4][4];
+
+    // N = L D L^T，L 为单位下三角阵
+    for (int j = 0; j < 4; ++j) {
+        double dj = N[j][j];
+        for (int k = 0; k < j; ++k) dj -= L[j][k] * L[j][k] * d[k];
+        if (!(dj > 1.0e-12 * N[j][j])) return false;
+        d[j] = dj;
+        L[j][j] = 1.0;
+        for (int i = j + 1; i < 4; ++i) {
+            double lij = N[j][i];
+            for (int k = 0; k < j; ++k) lij -= L[i][k] * L[j][k] * d[k];
+            L[i][j] = lij / dj;
+        }
+    }
 
-vector<vector<Vector3d>> LoadAllSatellites(int num_sats, int num_steps, const string& folder) {
-    vector<vector<Vector3d>> all_positions(num_sats);
-    for (int i = 0; i < num_sats; ++i) {
-        char filename[128];
-        sprintf(filename, "%s%s_%d_ECEF.txt", folder.c_str(), "Satellite", i + 1);
-        ifstream infile(filename);
-        if (!infile.is_open()) {
-            cerr << "Failed to open " << filename << endl;
-            exit(1);
+    // W = L^-1
+    for (int j = 0; j < 4; ++j) {
+        W[j][j] = 1.0;
+        for (int i = j + 1; i < 4; ++i) {
+            double wij = 0.0;
+            for (int k = j; k < i; ++k) wij -= L[i][k] * W[k][j];
+            W[i][j] = wij;
         }
-        
-        string date, time;
-        double x, y, z, vx, vy, vz;
-        for (int step = 0; step < num_steps; ++step) {
-            infile >> date >> time >> x >> y >> z >> vx >> vy >> vz;
-            all_positions[i].emplace_back(Vector3d(x, y, z));
+    }
+
+    // Q = W^T D^-1 W（对称，只算上三角）
+    for (int i = 0; i < 4; ++i) {
+        for (int j = i; j < 4; ++j) {
+            double qij = 0.0;
+            for (int k = j; k < 4; ++k) qij += W[k][i] * W[k][j] / d[k];
+            Q[i][j] = Q[j][i] = qij;
         }
-        infile.close();
     }
-    return all_positions;
+
+    double pos = Q[0][0] + Q[1][1] + Q[2][2];
+    double ver = 0.0;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) ver += up[i] * Q[i][j] * up[j];
+
+    dop.gdop = sqrt(pos + Q[3][3]);
+    dop.pdop = sqrt(pos);
+    dop.hdop = sqrt(std::max(pos - ver, 0.0));
+    dop.vdop = sqrt(std::max(ver, 0.0));
+    dop.tdop = sqrt(Q[3][3]);
+    return true;
 }
 
-void ComputeGridPDOP(const vector<vector<Vector3d>>& sat_positions,
+// 观测网格（结构数组）：各网格点的 ECEF 坐标和天顶单位向量，按 纬度 x 经度 行优先存放
+struct ObserverGrid {
+    vector<double> x, y, z;
+    vector<double> up_x, up_y, up_z;
+};
+
+// 网格点坐标与时间无关，只计算一次
+static void BuildObserverGrid(WorkStealingPool& pool, const vector<double>& lats,
+    const vector<double>& lons, double alt_km, ObserverGrid& grid) {
+    const int num_lon = lons.size();
+    const size_t n = lats.size() * (size_t)num_lon;
+    grid.x.resize(n); grid.y.resize(n); grid.z.resize(n);
+    grid.up_x.resize(n); grid.up_y.resize(n); grid.up_z.resize(n);
+
+    ParallelFor(pool, (int)lats.size(), [&](int i_lat) {
+        for (int i_lon = 0; i_lon < num_lon; ++i_lon) {
+            size_t k = (size_t)i_lat * num_lon + i_lon;
+            Vector3d obs = LatLonAltToECEF(lats[i_lat], lons[i_lon], alt_km);
+            Vector3d up  = obs.normalized();     // 仰角判断用的天顶方向（地心方向）
+            grid.x[k] = obs[0]; grid.y[k] = obs[1]; grid.z[k] = obs[2];
+            grid.up_x[k] = up[0]; grid.up_y[k] = up[1]; grid.up_z[k] = up[2];
+        }
+    });
+}
+
+void ComputeGridPDOP(WorkStealingPool& pool,
+    const vector<vector<Vector3d>>& sat_positions,
     int num_steps, double time_step,
     double lat_start, double lat_end, double lat_step,
     double lon_start, double lon_end, double lon_step,
@@ -120,50 +175,120 @@ void ComputeGridPDOP(const vector<vector<Vector3d>>& sat_positions,
     int num_sats = sat_positions.size();
     vector<vector<int>> visible_times(num_sats); // 每颗卫星可见时间步记录
     
+    // 网格经纬度（与逐点累加的循环取值一致）
+    vector<double> lats, lons;
+    for (double lat = lat_start; lat <= lat_end; lat += lat_step) lats.push_back(lat);
+    for (double lon = lon_start; lon <= lon_end; lon += lon_step) lons.push_back(lon);
+    const int num_lat = lats.size();
+    const int num_lon = lons.size();
+
+    // 按时间步 x 纬度带分块并行计算，结果写入预分配的缓冲区
+    const int band_rows = 8;                         // 每个纬度带的行数
+    const int num_bands = (num_lat + band_rows - 1) / band_rows;
+    const size_t cells_per_step = (size_t)num_lat * num_lon;
+
+    // 按时间步分批计算并写出，缓冲区大小与时间步数无关（1 s 步长的长时段也不会占满内存）
+    const int block_steps = 16;                      // 每批的时间步数
+    vector<DOPValues> dops(block_steps * cells_per_step);
+    vector<char>      valid(block_steps * cells_per_step);
+    vector<char>      first_visible(num_steps * (size_t)num_sats, 0); // 首个网格点的可见性
+    const double sin_mask = sin(MIN_ELEVATION * DEG2RAD);
+
+    ObserverGrid grid;
+    BuildObserverGrid(pool, lats, lons, alt_km, grid);
+
+    // 每个时间步的卫星位置连续存放（结构数组），下标 t * num_sats + s
+    vector<double> sat_x(num_steps * (size_t)num_sats);
+    vector<double> sat_y(num_steps * (size_t)num_sats);
+    vector<double> sat_z(num_steps * (size_t)num_sats);
+    for (int t = 0; t < num_steps; ++t) {
+        for (int s = 0; s < num_sats; ++s) {
+            const Vector3d& r = sat_positions[s][t];
+            size_t k = t * (size_t)num_sats + s;
+            sat_x[k] = r[0]; sat_y[k] = r[1]; sat_z[k] = r[2];
+        }
+    }
+
     // Create output files in executable directory
     ofstream fout(type + "_pdop_grid_all.csv");
     if (!fout.is_open()) {
         cerr << "Failed to open " << type + "_pdop_grid_all.csv for writing." << endl;
         return;
     }
-    fout << "time_step,lat,lon,pdop\n";
+    fout << "time_step,lat,lon,pdop,gdop,hdop,vdop,tdop\n";
+
+    for (int t_0 = 0; t_0 < num_steps; t_0 += block_steps) {
+        const int n_block = std::min(block_steps, num_steps - t_0);
+
+        ParallelFor(pool, n_block * num_bands, [&](int tile) {
+            int t      = t_0 + tile / num_bands;
+            int i_lat0 = (tile % num_bands) * band_rows;
+            int i_lat1 = std::min(i_lat0 + band_rows, num_lat);
+            const double* sx = &sat_x[t * (size_t)num_sats];
+            const double* sy = &sat_y[t * (size_t)num_sats];
+            const double* sz = &sat_z[t * (size_t)num_sats];
+            vector<double> range(num_sats), elev(num_sats);   // 每块分配一次
+
+            for (int i_lat = i_lat0; i_lat < i_lat1; ++i_lat) {
+                for (int i_lon = 0; i_lon < num_lon; ++i_lon) {
+                    size_t k = (size_t)i_lat * num_lon + i_lon;
+                    size_t cell = (t - t_0) * cells_per_step + k;
+                    const double ox = grid.x[k], oy = grid.y[k], oz = grid.z[k];
+                    const double ex = grid.up_x[k], ey = grid.up_y[k], ez = grid.up_z[k];
+
+                    // 可见性：对全部卫星无分支地计算距离和仰角判据（可向量化）
+                    for (int s = 0; s < num_sats; ++s) {
+                        double dx = sx[s] - ox, dy = sy[s] - oy, dz = sz[s] - oz;
+                        range[s] = sqrt(dx * dx + dy * dy + dz * dz);
+                        elev[s]  = (dx * ex + dy * ey + dz * ez) - sin_mask * range[s];
+                    }
 
-    for (int t = 0; t < num_steps; ++t) {
-        for (double lat = lat_start; lat <= lat_end; lat += lat_step) {
-            for (double lon = lon_start; lon <= lon_end; lon += lon_step) {
-                Vector3d obs = LatLonAltToECEF(lat, lon, alt_km);
-                vector<Vector3d> visible_dirs;
-
-                for (int s = 0; s < num_sats; ++s) {
-                    Vector3d sat = sat_positions[s][t];
-                    double elev = CalcElevation(sat, obs);
-                    if (elev >= MIN_ELEVATION) {
-                        visible_dirs.push_back((sat - obs).normalized());
-                        if (lat == lat_start && lon == lon_start) {
-                            visible_times[s].push_back(t);
+                    // 遍历可见卫星，直接累加法方程矩阵的上三角
+                    double N[4][4] = {};
+                    int n_vis = 0;
+                    for (int s = 0; s < num_sats; ++s) {
+                        if (elev[s] < 0.0) continue;
+                        if (k == 0) {
+                            first_visible[t * (size_t)num_sats + s] = 1;
                         }
+                        double ux = (sx[s] - ox) / range[s];
+                        double uy = (sy[s] - oy) / range[s];
+                        double uz = (sz[s] - oz) / range[s];
+                        N[0][0] += ux * ux; N[0][1] += ux * uy; N[0][2] += ux * uz; N[0][3] += ux;
+                        N[1][1] += uy * uy; N[1][2] += uy * uz; N[1][3] += uy;
+                        N[2][2] += uz * uz; N[2][3] += uz;
+                        ++n_vis;
                     }
-                }
+                    N[3][3] = n_vis;
 
-                if (visible_dirs.size() >= 4) {
-                    MatrixXd A(visible_dirs.size(), 4);
-                    for (size_t i = 0; i < visible_dirs.size(); ++i) {
-                        A(i, 0) = visible_dirs[i][0];
-                        A(i, 1) = visible_dirs[i][1];
-                        A(i, 2) = visible_dirs[i][2];
-                        A(i, 3) = 1.0;
+                    valid[cell] = (n_vis >= 4) &&
+                        SolveDOP(N, Vector3d(ex, ey, ez), dops[cell]);
+                }
+            }
+        });
+
+        // 按时间步、纬度、经度顺序写出本批结果
+        for (int t = t_0; t < t_0 + n_block; ++t) {
+            for (int i_lat = 0; i_lat < num_lat; ++i_lat) {
+                for (int i_lon = 0; i_lon < num_lon; ++i_lon) {
+                    size_t cell = (t - t_0) * cells_per_step + (size_t)i_lat * num_lon + i_lon;
+                    fout << t << "," << lats[i_lat] << "," << lons[i_lon] << ",";
+                    if (valid[cell]) {
+                        const DOPValues& dop = dops[cell];
+                        fout << dop.pdop << "," << dop.gdop << "," << dop.hdop << ","
+                             << dop.vdop << "," << dop.tdop << "\n";
                     }
-                    Matrix4d Q = (A.transpose() * A).inverse();
-                    double PDOP = sqrt(Q(0,0) + Q(1,1) + Q(2,2));
-                    fout << t << "," << lat << "," << lon << "," << PDOP << "\n";
-                } else {
-                    fout << t << "," << lat << "," << lon << ",NaN\n";
+                    else fout << "NaN,NaN,NaN,NaN,NaN\n";
                 }
             }
         }
     }
     fout.close();
 
+    for (int t = 0; t < num_steps; ++t)
+        for (int s = 0; s < num_sats; ++s)
+            if (first_visible[t * (size_t)num_sats + s]) visible_times[s].push_back(t);
+
     // === 输出 STK-style 可见时间区间 ===
     ofstream stk_out(type + "_sat_visibility.txt");
     if (!stk_out.is_open()) {
@@ -196,8 +321,8 @@ void ComputeGridPDOP(const vector<vector<Vector3d>>& sat_positions,
 
         for (size_t i = 1; i <= times.size(); ++i) {
             if (i == times.size() || times[i] != prev_idx + 1) {
-                std::tm t_start = AddSecondsToTime(year, month, day, hour, min, static_cast<int>(sec), start_idx * step_seconds);
-                std::tm t_stop = AddSecondsToTime(year, month, day, hour, min, static_cast<int>(sec), prev_idx * step_seconds);
+                std::tm t_start = AddSecondsToTime(year, month, day, hour, min, static_cast<int>(sec), static_cast<int>(lround(start_idx * step_seconds)));
+                std::tm t_stop = AddSecondsToTime(year, month, day, hour, min, static_cast<int>(sec), static_cast<int>(lround(prev_idx * step_seconds)));
                 // time_t t_start = base_time + start_idx * step_seconds;
                 // time_t t_stop  = base_time + (prev_idx + 1) * step_seconds;
 
@@ -17,13 +17,17 @@
 *            21 mar 08  david vallado
 *                           misc fixes
 *  changes :
+*            column tables (eoptable, spwtable) with binary file format
 *            14 dec 05  david vallado
 *                           misc fixes
 *            21 oct 05  david vallado
 *                           original version
 *       ----------------------------------------------------------------      */
 
+#include <stdint.h>
+
 #include "SAT_Const.h"
+#include "SAT_MappedFile.h"
 #include "eopspw.h"
 
 using namespace std;
@@ -41,6 +45,212 @@ double  sgn(double x)
 
    }  // end sgn
 
+/* -----------------------------------------------------------------------------
+*
+*                           class datatable
+*
+*  column table of daily records. binary table files start with a 64-byte
+*  header
+*
+*    char[8]  magic ("HPOP_EOP" or "HPOP_SPW")
+*    uint32   format version (1)
+*    uint32   0x01020304 in the byte order of the writer
+*    int32    number of records, number of columns
+*    double   julian date of record 0
+*    uint64   offset of the column data (64)
+*    uint64   (reserved, 3 words)
+*
+*  followed by the columns of numrecs doubles each.
+*
+*  -------------------------------------------------------------------------- */
+
+namespace {
+
+  const uint32_t tableversion = 1;
+  const uint32_t tableendian  = 0x01020304;
+
+  struct tableheader
+    {
+       char     magic[8];
+       uint32_t version;
+       uint32_t endian;
+       int32_t  numrecs;
+       int32_t  numcols;
+       double   jdstart;
+       uint64_t dataoffset;
+       uint64_t reserved[3];
+    };
+
+  static_assert(sizeof(tableheader) == 64, "unexpected table header size");
+
+  const char eopmagic[8] = { 'H','P','O','P','_','E','O','P' };
+  const char spwmagic[8] = { 'H','P','O','P','_','S','P','W' };
+
+}
+
+datatable::datatable()
+  : numrecs(0), numcols(0), jdstart(0.0), data(0)
+   {
+   }
+
+double* datatable::allocate(int nrecs, int ncols, double jd)
+   {
+     map.reset();
+     store.assign((size_t)nrecs*ncols + 1, 0.0);
+     numrecs = nrecs;
+     numcols = ncols;
+     jdstart = jd;
+     data    = &store[0];
+     return &store[0];
+   }
+
+bool datatable::write(const char* filename, const char magic[8]) const
+   {
+     FILE *outfile;
+     tableheader hdr;
+     size_t n = (size_t)numrecs*numcols;
+
+     outfile = fopen(filename, "wb");
+     if (outfile == NULL)
+         return false;
+
+     memset(&hdr, 0, sizeof(hdr));
+     memcpy(hdr.magic, magic, 8);
+     hdr.version    = tableversion;
+     hdr.endian     = tableendian;
+     hdr.numrecs    = numrecs;
+     hdr.numcols    = numcols;
+     hdr.jdstart    = jdstart;
+     hdr.dataoffset = sizeof(hdr);
+
+     bool ok = (fwrite(&hdr, sizeof(hdr), 1, outfile) == 1) &&
+               (fwrite(data, sizeof(double), n, outfile) == n);
+     return (fclose(outfile) == 0) && ok;
+   }
+
+bool datatable::read(const char* filename, const char magic[8], int ncols)
+   {
+     std::shared_ptr<MappedFile> m(new MappedFile);
+     tableheader hdr;
+
+     if (!m->Open(filename) || m->size() < sizeof(hdr))
+         return false;
+
+     memcpy(&hdr, m->data(), sizeof(hdr));
+     if ((memcmp(hdr.magic, magic, 8) != 0) || (hdr.version != tableversion) ||
+         (hdr.endian != tableendian) || (hdr.numcols != ncols) ||
+         (hdr.numrecs < 1) || (hdr.dataoffset != sizeof(hdr)) ||
+         (m->size() < sizeof(hdr) + (size_t)hdr.numrecs*ncols*sizeof(double)))
+       {
+         printf("unknown format or truncated table file %s \n", filename);
+         return false;
+       }
+
+     store.clear();
+     map     = m;
+     numrecs = hdr.numrecs;
+     numcols = hdr.numcols;
+     jdstart = hdr.jdstart;
+     data    = (const double*)(m->data() + hdr.dataoffset);
+     return true;
+   }
+
+eoptable::eoptable()
+   {
+     setcolumns();
+   }
+
+void eoptable::setcolumns()
+   {
+     xp    = column(cxp);    yp    = column(cyp);
+     dut1  = column(cdut1);  lod   = column(clod);
+     ddpsi = column(cddpsi); ddeps = column(cddeps);
+     dx    = column(cdx);    dy    = column(cdy);
+     dat   = column(cdat);   mjd   = column(cmjd);
+   }
+
+double* eoptable::allocate(int nrecs, double jd)
+   {
+     double* p = datatable::allocate(nrecs, ncols, jd);
+     setcolumns();
+     return p;
+   }
+
+bool eoptable::write(const char* filename) const
+   {
+     return datatable::write(filename, eopmagic);
+   }
+
+bool eoptable::read(const char* filename)
+   {
+     bool ok = datatable::read(filename, eopmagic, ncols);
+     setcolumns();
+     return ok;
+   }
+
+spwtable::spwtable()
+   {
+     setcolumns();
+   }
+
+void spwtable::setcolumns()
+   {
+     adjf10    = column(cadjf10);    adjctrf81 = column(cadjctrf81);
+     adjlstf81 = column(cadjlstf81); obsf10    = column(cobsf10);
+     obsctrf81 = column(cobsctrf81); obslstf81 = column(cobslstf81);
+     avgap     = column(cavgap);     sumkp     = column(csumkp);
+     for (int j = 0; j < 8; j++)
+       {
+         aparr[j] = column(caparr+j);
+         kparr[j] = column(ckparr+j);
+       }
+   }
+
+double* spwtable::allocate(int nrecs, double jd)
+   {
+     double* p = datatable::allocate(nrecs, ncols, jd);
+     setcolumns();
+     return p;
+   }
+
+bool spwtable::write(const char* filename) const
+   {
+     return datatable::write(filename, spwmagic);
+   }
+
+bool spwtable::read(const char* filename)
+   {
+     bool ok = datatable::read(filename, spwmagic, ncols);
+     setcolumns();
+     return ok;
+   }
+
+/* -----------------------------------------------------------------------------
+*
+*                           function readspwbin, readeopbin
+*
+*  these functions map binary space weather and eop tables (written by
+*  spwtable::write and eoptable::write, see hpop_convert) into memory.
+*
+*  inputs          description                    range / units
+*    filename    - name of the binary table file
+*
+*  outputs       :
+*    spwtab      - space weather table
+*    eoptab      - eop table
+*    <return>    - false if the file cannot be opened or has a wrong format
+*
+*  -------------------------------------------------------------------------- */
+bool readspwbin(const char* filename, spwtable& spwtab)
+   {
+     return spwtab.read(filename);
+   }
+
+bool readeopbin(const char* filename, eoptable& eoptab)
+   {
+     return eoptab.read(filename);
+   }
+
 /* -----------------------------------------------------------------------------
 *
 *                           function initspw
@@ -50,12 +260,14 @@ double  sgn(double x)
 *  author        : david vallado                  719-573-2600   2 nov 2005
 *
 *  revisions
+*                - file name argument, column table
 *
 *  inputs          description                    range / units
+*    filename    - name of the cssi space weather file
 *
 *  outputs       :
-*    spwarr      - array of spw data records
-*    jdspwstart  - julian date of the start of the spwarr data
+*    spwtab      - table of spw data (jdstart: julian date of the first record)
+*    <return>    - false if the file cannot be opened
 *
 *  locals        :
 *                -
@@ -65,17 +277,19 @@ double  sgn(double x)
 *  references    :
 *
 *  -------------------------------------------------------------------------- */
-void initspw(spwdata spwarr[spwsize], double& jdspwstart)
+bool initspw(const char* filename, spwtable& spwtab)
 	 {
        FILE *infile;
        char longstr[140];
        char str[9], blk[30];
-       int numrecsobs, numrecspred, i, year, mon, day, tmp;
+       int numrecsobs = 0, numrecspred = 0, numrecs, i, j, year, mon, day, tmp;
+       double jdspwstart;
+       std::vector<spwdata> spwarr;
 
        // ---- open files
-      //  infile = fopen("SW-All.txt", "r");
-      //  infile = fopen("sw_2025.txt", "r");
-       infile = fopen("D:\\HPOP_code\\HPOP_RK4\\sw_2025.txt", "r");
+       infile = fopen(filename, "r");
+       if (infile == NULL)
+           return false;
 
        // ---- read number of data points
        char tline[256];  // Array to store each line read from the file
@@ -90,8 +304,14 @@ void initspw(spwdata spwarr[spwsize], double& jdspwstart)
            }
        }
 	   fgets( longstr,140,infile);
+       if (numrecsobs < 1)
+         {
+           fclose( infile );
+           return false;
+         }
 
        // ---- process observed records
+       spwarr.resize(numrecsobs);
        for (i = 0; i < numrecsobs; i++)
          {
            // use d format for integers with leading 0's
@@ -107,14 +327,16 @@ void initspw(spwdata spwarr[spwsize], double& jdspwstart)
 	   
 	   // ---- find epoch date
        jday( spwarr[0].year,spwarr[0].mon,spwarr[0].day, 0,0,0.0, jdspwstart);
-       jdspwstart = jdspwstart;
 
        fgets( longstr,140,infile);
        fgets( longstr,140,infile);
 	   fscanf(infile,"%27c %5i ", blk,&numrecspred);
        fgets( longstr,140,infile);
+       if (numrecspred < 0)
+           numrecspred = 0;
 
        // ---- process predicted records
+       spwarr.resize(numrecsobs + numrecspred);
        for (i = numrecsobs; i < numrecsobs + numrecspred; i++)
          {
            // use d format for integers with leading 0's
@@ -129,6 +351,27 @@ void initspw(spwdata spwarr[spwsize], double& jdspwstart)
 					 spwarr[i].q = 0;
          }
       fclose( infile );
+
+      // ---- store the records column by column
+      numrecs = numrecsobs + numrecspred;
+      double* tab = spwtab.allocate(numrecs, jdspwstart);
+      for (i = 0; i < numrecs; i++)
+        {
+          tab[spwtable::cadjf10   *numrecs + i] = spwarr[i].adjf10;
+          tab[spwtable::cadjctrf81*numrecs + i] = spwarr[i].adjctrf81;
+          tab[spwtable::cadjlstf81*numrecs + i] = spwarr[i].adjlstf81;
+          tab[spwtable::cobsf10   *numrecs + i] = spwarr[i].obsf10;
+          tab[spwtable::cobsctrf81*numrecs + i] = spwarr[i].obsctrf81;
+          tab[spwtable::cobslstf81*numrecs + i] = spwarr[i].obslstf81;
+          tab[spwtable::cavgap    *numrecs + i] = spwarr[i].avgap;
+          tab[spwtable::csumkp    *numrecs + i] = spwarr[i].sumkp;
+          for (j = 0; j < 8; j++)
+            {
+              tab[(spwtable::caparr+j)*numrecs + i] = spwarr[i].aparr[j];
+              tab[(spwtable::ckparr+j)*numrecs + i] = spwarr[i].kparr[j];
+            }
+        }
+      return true;
    }
 
 /* -----------------------------------------------------------------------------
@@ -147,12 +390,14 @@ void initspw(spwdata spwarr[spwsize], double& jdspwstart)
 *  author        : david vallado                  719-573-2600   2 nov 2005
 *
 *  revisions
+*                - file name argument, column table
 *
 *  inputs          description                    range / units
+*    filename    - name of the cssi eop file
 *
 *  outputs       :
-*    eoparr      - array of eop data records
-*    jdeopstart  - julian date of the start of the eoparr data
+*    eoptab      - table of eop data (jdstart: julian date of the first record)
+*    <return>    - false if the file cannot be opened
 *
 *  locals        :
 *                -
@@ -162,23 +407,24 @@ void initspw(spwdata spwarr[spwsize], double& jdspwstart)
 *  references    :
 *
 *  -------------------------------------------------------------------------- */
-void initeop
+bool initeop
 	 (
-	   eopdata eoparr[eopsize],
-	   double& jdeopstart
+	   const char* filename,
+	   eoptable&   eoptab
 	 )
 	 {
-	   FILE *infile, *infile1;
+	   FILE *infile;
 	   char longstr[140];
-	   char str[9], blk[19];
-	   double mjd;
-	   int numrecsobs, numrecspred, year, mon, day;
+	   char str[9], blk[21];
+	   int numrecsobs = 0, numrecspred = 0, numrecs;
 	   long i;
+	   double jdeopstart;
+	   std::vector<eopdata> eoparr;
 
 	   // ---- open files select compatible files!!
-      //  infile  = fopen("EOP-All.txt", "r");
-      //  infile  = fopen("EOP-All_2025.txt", "r");
-       infile  = fopen("D:\\HPOP_code\\HPOP_RK4\\EOP-All_2025.txt", "r");
+       infile  = fopen(filename, "r");
+       if (infile == NULL)
+           return false;
 
        // ---- read number of data points
        char tline[256];  // Array to store each line read from the file
@@ -193,8 +439,14 @@ void initeop
            }
        }
        fgets( longstr,140,infile);
+       if (numrecsobs < 1)
+         {
+           fclose( infile );
+           return false;
+         }
 
 	   // ---- process observed records
+       eoparr.resize(numrecsobs);
        for (i = 0; i < numrecsobs; i++)
 		 {
            // use d format for integers with leading 0's
@@ -207,14 +459,16 @@ void initeop
 	   
 	   // ---- find epoch date
        jday( eoparr[0].year, eoparr[0].mon, eoparr[0].day, 0,0,0.0, jdeopstart);
-       jdeopstart = jdeopstart;
 
        fgets( longstr,140,infile);
        fgets( longstr,140,infile);
 	   fscanf(infile,"%20c %5i ", blk,&numrecspred );
        fgets( longstr,140,infile);
+       if (numrecspred < 0)
+           numrecspred = 0;
 
 	   // ---- process predicted records
+       eoparr.resize(numrecsobs + numrecspred);
        for (i = numrecsobs; i < numrecsobs + numrecspred; i++)
          {
            // use d format for integers with leading 0's
@@ -226,6 +480,24 @@ void initeop
 		 }
 
 	   fclose( infile );
+
+	   // ---- store the records column by column
+	   numrecs = numrecsobs + numrecspred;
+	   double* tab = eoptab.allocate(numrecs, jdeopstart);
+	   for (i = 0; i < numrecs; i++)
+		 {
+		   tab[eoptable::cxp   *numrecs + i] = eoparr[i].xp;
+		   tab[eoptable::cyp   *numrecs + i] = eoparr[i].yp;
+		   tab[eoptable::cdut1 *numrecs + i] = eoparr[i].dut1;
+		   tab[eoptable::clod  *numrecs + i] = eoparr[i].lod;
+		   tab[eoptable::cddpsi*numrecs + i] = eoparr[i].ddpsi;
+		   tab[eoptable::cddeps*numrecs + i] = eoparr[i].ddeps;
+		   tab[eoptable::cdx   *numrecs + i] = eoparr[i].dx;
+		   tab[eoptable::cdy   *numrecs + i] = eoparr[i].dy;
+		   tab[eoptable::cdat  *numrecs + i] = eoparr[i].dat;
+		   tab[eoptable::cmjd  *numrecs + i] = eoparr[i].mjd;
+		 }
+	   return true;
 	 }   // procedure initeop
 
 
@@ -243,8 +515,7 @@ void initeop
 *    jde         - julian date of epoch (0 hrs utc)
 *    mfme        - minutes from midnight epoch
 *    interp      - interpolation                        n-none, l-linear, s-spline
-*    eoparr      - array of eop data records
-*    jdeopstart  - julian date of the start of the eoparr data (set in initeop)
+*    eoptab      - table of eop data (initeop or readeopbin)
 *
 *  outputs       :
 *    dut1        - delta ut1 (ut1-utc)                  sec
@@ -274,7 +545,7 @@ void initeop
 void findeopparam
 	 (
 	   double  jd,       double mfme,     char interp,
-	   eopdata eoparr[eopsize],           double jdeopstart,
+	   const eoptable& eoptab,
 	   double& dut1,     int& dat,
 	   double& lod,      double& xp,      double& yp,
 	   double& ddpsi,    double& ddeps,   double& dx,   double& dy,
@@ -282,107 +553,79 @@ void findeopparam
 	   double& deltapsi, double& deltaeps
 	 )
 	 {
-	   long i, recnum;
-	   int  year, mon, day, idx, off1, off2;
-	   eopdata eoprec, lasteoprec, nexteoprec,  tempeoprec;
-	   double  fixf,   fixa, mjdt, recnumstart, jdeopstarto;
+	   long recnum, next;
+	   int  off1, off2;
+	   double  fixf, jdeopstarto;
 
 	   // ---- read data for day of interest
-	   jdeopstarto = floor(jd - jdeopstart);
-	   recnum      = int(jdeopstarto);
+	   jdeopstarto = floor(jd - eoptab.jdstart);
+	   recnum      = long(jdeopstarto);
 
 	   // check for out of bound values
-	   if ((recnum >= 1) && (recnum <= eopsize))
+	   if ((recnum >= 1) && (recnum < eoptab.numrecs))
 		 {
-		   eoprec   = eoparr[recnum];
-
 		   // ---- set non-interpolated values
-		   dut1     = eoprec.dut1;
-		   dat      = eoprec.dat;
-		   lod      = eoprec.lod;
-		   xp       = eoprec.xp;
-		   yp       = eoprec.yp;
-		   ddpsi    = eoprec.ddpsi;
-		   ddeps    = eoprec.ddeps;
-		   dx       = eoprec.dx;
-		   dy       = eoprec.dy;
-
-           // ---- find nutation parameters for use in optimizing speed
-           x        = eoprec.x;
-           y        = eoprec.y;
-           s        = eoprec.s;
-           deltapsi = eoprec.deltapsi;
-           deltaeps = eoprec.deltaeps;
+		   dut1     = eoptab.dut1[recnum];
+		   dat      = int(eoptab.dat[recnum]);
+		   lod      = eoptab.lod[recnum];
+		   xp       = eoptab.xp[recnum];
+		   yp       = eoptab.yp[recnum];
+		   ddpsi    = eoptab.ddpsi[recnum];
+		   ddeps    = eoptab.ddeps[recnum];
+		   dx       = eoptab.dx[recnum];
+		   dy       = eoptab.dy[recnum];
+
+           // ---- nutation parameters for use in optimizing speed (not
+           //      contained in the cssi files)
+           x        = 0.0;
+           y        = 0.0;
+           s        = 0.0;
+           deltapsi = 0.0;
+           deltaeps = 0.0;
 
            // ---- do linear interpolation
            if (interp == 'l')
              {
-               nexteoprec = eoparr[recnum+1];
+               next = (recnum+1 < eoptab.numrecs) ? recnum+1 : recnum;
                fixf = mfme / 1440.0;
 
-               dut1     = eoprec.dut1     + (nexteoprec.dut1     - eoprec.dut1    ) * fixf;
-               dat      = eoprec.dat      + (nexteoprec.dat      - eoprec.dat     ) * fixf;
-               lod      = eoprec.lod      + (nexteoprec.lod      - eoprec.lod     ) * fixf;
-               xp       = eoprec.xp       + (nexteoprec.xp       - eoprec.xp      ) * fixf;
-               yp       = eoprec.yp       + (nexteoprec.yp       - eoprec.yp      ) * fixf;
-               ddpsi    = eoprec.ddpsi    + (nexteoprec.ddpsi    - eoprec.ddpsi   ) * fixf;
-			   ddeps    = eoprec.ddeps    + (nexteoprec.ddeps    - eoprec.ddeps   ) * fixf;
-               dx       = eoprec.dx       + (nexteoprec.dx       - eoprec.dx      ) * fixf;
-               dy       = eoprec.dy       + (nexteoprec.dy       - eoprec.dy      ) * fixf;
-               x        = eoprec.x        + (nexteoprec.x        - eoprec.x       ) * fixf;
-               y        = eoprec.y        + (nexteoprec.y        - eoprec.y       ) * fixf;
-               s        = eoprec.s        + (nexteoprec.s        - eoprec.s       ) * fixf;
-               deltapsi = eoprec.deltapsi + (nexteoprec.deltapsi - eoprec.deltapsi) * fixf;
-               deltaeps = eoprec.deltaeps + (nexteoprec.deltaeps - eoprec.deltaeps) * fixf;
+               dut1     = eoptab.dut1[recnum]  + (eoptab.dut1[next]  - eoptab.dut1[recnum] ) * fixf;
+               dat      = int(eoptab.dat[recnum] + (eoptab.dat[next] - eoptab.dat[recnum]) * fixf);
+               lod      = eoptab.lod[recnum]   + (eoptab.lod[next]   - eoptab.lod[recnum]  ) * fixf;
+               xp       = eoptab.xp[recnum]    + (eoptab.xp[next]    - eoptab.xp[recnum]   ) * fixf;
+               yp       = eoptab.yp[recnum]    + (eoptab.yp[next]    - eoptab.yp[recnum]   ) * fixf;
+               ddpsi    = eoptab.ddpsi[recnum] + (eoptab.ddpsi[next] - eoptab.ddpsi[recnum]) * fixf;
+               ddeps    = eoptab.ddeps[recnum] + (eoptab.ddeps[next] - eoptab.ddeps[recnum]) * fixf;
+               dx       = eoptab.dx[recnum]    + (eoptab.dx[next]    - eoptab.dx[recnum]   ) * fixf;
+               dy       = eoptab.dy[recnum]    + (eoptab.dy[next]    - eoptab.dy[recnum]   ) * fixf;
              }
 
            // ---- do spline interpolations
-           if (interp == 's')
+           off1 = 10;   // every 5 days data...
+           off2 = 5;
+           if ((interp == 's') && (recnum >= off1) && (recnum+off2 < eoptab.numrecs))
              {
-               off1 = 10;   // every 5 days data...
-               off2 = 5;
-               dut1 = cubicinterp ( eoparr[recnum-off1].dut1, eoparr[recnum-off2].dut1, eoparr[recnum].dut1, eoparr[recnum+off2].dut1,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               dat = cubicinterp ( eoparr[recnum-off1].dat, eoparr[recnum-off2].dat, eoparr[recnum].dat, eoparr[recnum+off2].dat,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               lod = cubicinterp ( eoparr[recnum-off1].lod, eoparr[recnum-off2].lod, eoparr[recnum].lod, eoparr[recnum+off2].lod,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               xp = cubicinterp ( eoparr[recnum-off1].xp, eoparr[recnum-off2].xp, eoparr[recnum].xp, eoparr[recnum+off2].xp,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               yp = cubicinterp ( eoparr[recnum-off1].yp, eoparr[recnum-off2].yp, eoparr[recnum].yp, eoparr[recnum+off2].yp,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-									mfme );
-               ddpsi = cubicinterp ( eoparr[recnum-off1].ddpsi, eoparr[recnum-off2].ddpsi, eoparr[recnum].ddpsi, eoparr[recnum+off2].ddpsi,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               ddeps = cubicinterp ( eoparr[recnum-off1].ddeps, eoparr[recnum-off2].ddeps, eoparr[recnum].ddeps, eoparr[recnum+off2].ddeps,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               dx = cubicinterp ( eoparr[recnum-off1].dx, eoparr[recnum-off2].dx, eoparr[recnum].dx, eoparr[recnum+off2].dx,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               dy = cubicinterp ( eoparr[recnum-off1].dy, eoparr[recnum-off2].dy, eoparr[recnum].dy, eoparr[recnum+off2].dy,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               x = cubicinterp ( eoparr[recnum-off1].x, eoparr[recnum-off2].x, eoparr[recnum].x, eoparr[recnum+off2].x,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               y = cubicinterp ( eoparr[recnum-off1].y, eoparr[recnum-off2].y, eoparr[recnum].y, eoparr[recnum+off2].y,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               s = cubicinterp ( eoparr[recnum-off1].s, eoparr[recnum-off2].s, eoparr[recnum].s, eoparr[recnum+off2].s,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               deltapsi = cubicinterp ( eoparr[recnum-off1].deltapsi, eoparr[recnum-off2].deltapsi, eoparr[recnum].deltapsi, eoparr[recnum+off2].deltapsi,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
-               deltaeps = cubicinterp ( eoparr[recnum-off1].deltaeps, eoparr[recnum-off2].deltaeps, eoparr[recnum].deltaeps, eoparr[recnum+off2].deltaeps,
-                                    eoparr[recnum-off1].mjd, eoparr[recnum-off2].mjd, eoparr[recnum].mjd, eoparr[recnum+off2].mjd,
-                                    mfme );
+               const double* mjd = eoptab.mjd;
+               long i0 = recnum-off1, i1 = recnum-off2, i2 = recnum, i3 = recnum+off2;
+
+               dut1  = cubicinterp ( eoptab.dut1[i0], eoptab.dut1[i1], eoptab.dut1[i2], eoptab.dut1[i3],
+                                     mjd[i0], mjd[i1], mjd[i2], mjd[i3], mfme );
+               dat   = cubicinterp ( eoptab.dat[i0], eoptab.dat[i1], eoptab.dat[i2], eoptab.dat[i3],
+                                     mjd[i0], mjd[i1], mjd[i2], mjd[i3], mfme );
+               lod   = cubicinterp ( eoptab.lod[i0], eoptab.lod[i1], eoptab.lod[i2], eoptab.lod[i3],
+                                     mjd[i0], mjd[i1], mjd[i2], mjd[i3], mfme );
+               xp    = cubicinterp ( eoptab.xp[i0], eoptab.xp[i1], eoptab.xp[i2], eoptab.xp[i3],
+                                     mjd[i0], mjd[i1], mjd[i2], mjd[i3], mfme );
+               yp    = cubicinterp ( eoptab.yp[i0], eoptab.yp[i1], eoptab.yp[i2], eoptab.yp[i3],
+                                     mjd[i0], mjd[i1], mjd[i2], mjd[i3], mfme );
+               ddpsi = cubicinterp ( eoptab.ddpsi[i0], eoptab.ddpsi[i1], eoptab.ddpsi[i2], eoptab.ddpsi[i3],
+                                     mjd[i0], mjd[i1], mjd[i2], mjd[i3], mfme );
+               ddeps = cubicinterp ( eoptab.ddeps[i0], eoptab.ddeps[i1], eoptab.ddeps[i2], eoptab.ddeps[i3],
+                                     mjd[i0], mjd[i1], mjd[i2], mjd[i3], mfme );
+               dx    = cubicinterp ( eoptab.dx[i0], eoptab.dx[i1], eoptab.dx[i2], eoptab.dx[i3],
+                                     mjd[i0], mjd[i1], mjd[i2], mjd[i3], mfme );
+               dy    = cubicinterp ( eoptab.dy[i0], eoptab.dy[i1], eoptab.dy[i2], eoptab.dy[i3],
+                                     mjd[i0], mjd[i1], mjd[i2], mjd[i3], mfme );
              }
 		 }
          // set default values
@@ -400,11 +643,6 @@ void findeopparam
 
            // ---- find nutation parameters for use in optimizing speed
 // these could be set here, or in the program calling this...
-//           x        = eoprec.x;
-//           y        = eoprec.y;
-//           s        = eoprec.s;
-//           deltapsi = eoprec.deltapsi;
-//           deltaeps = eoprec.deltaeps;
          }
    }  // procedure findeopparam
 
@@ -427,8 +665,7 @@ void findeopparam
 *    fluxtype    - flux type               a-adjusted, o-observed
 *    f81type     - flux 81-day avg type    l-last, c-centered
 *    inputtype   - input type              a-actual, u - user   c - constant
-*    spwarr      - array of space weather data
-*    jdspwstart  - julian date of the start of the spwarr data (set in initspw)
+*    spwtab      - table of space weather data (initspw or readspwbin)
 *
 *  outputs       :
 *    f107        - f10.7 value (current day)
@@ -453,16 +690,15 @@ void findeopparam
 void findatmosparam
      (
        double jd, double mfme, char interp, char fluxtype, char f81type, char inputtype,
-       spwdata spwarr[spwsize], double jdspwstart,
+       const spwtable& spwtab,
        double& f107, double& f107bar,
        double& ap, double& avgap, double aparr[8],
        double& kp, double& sumkp, double kparr[8]
      )
      {
-       int     i, recnum, year, mon, day, idx, j;
+       int     i, recnum, last, next, temp, year, mon, day, idx, j;
        double  tf107,  tf107bar, tavgap;
        char    ftype,  fctrtype;
-       spwdata spwrec, lastspwrec, nextspwrec, tempspwrec;
        double  fixf,   fixa, mjdt, recnumstart, fluxtime, jdspwstarto;
 
        // --------------------  implementation   ----------------------
@@ -477,37 +713,39 @@ void findatmosparam
        if (inputtype == 'a')
          {
            // ---- read data for day of interest
-           jdspwstarto = floor(jd - jdspwstart);
+           jdspwstarto = floor(jd - spwtab.jdstart);
            recnum      = int(jdspwstarto);
 
            if (recnum < 1)
              {
-               printf("%14.5lf before %14.5lf date in file, hit ctrl-c \n", jd, jdspwstart);
+               printf("%14.5lf before %14.5lf date in file, hit ctrl-c \n", jd, spwtab.jdstart);
                scanf( "%lf", &jd );
              }
-           // ---- set non-interpolated values
-           spwrec     = spwarr[recnum];
-           lastspwrec = spwarr[recnum-1];
-           nextspwrec = spwarr[recnum+1];
+           // ---- records of the day and its neighbours (kept inside the table)
+           if (recnum < 0) recnum = 0;
+           if (recnum > spwtab.numrecs-1) recnum = spwtab.numrecs-1;
+           last = (recnum > 0) ? recnum-1 : recnum;
+           next = (recnum < spwtab.numrecs-1) ? recnum+1 : recnum;
 
+           // ---- set non-interpolated values
            if (fluxtype == 'a')
              {
-               f107 = spwrec.adjf10;
+               f107 = spwtab.adjf10[recnum];
                if (f81type == 'l')
-                   f107bar = spwrec.adjlstf81;
+                   f107bar = spwtab.adjlstf81[recnum];
                  else
-                   f107bar = spwrec.adjctrf81;
+                   f107bar = spwtab.adjctrf81[recnum];
              }
              else
              {
-               f107 = spwrec.obsf10;
+               f107 = spwtab.obsf10[recnum];
                if (f81type == 'l')
-                   f107bar = spwrec.obslstf81;
+                   f107bar = spwtab.obslstf81[recnum];
                  else
-                   f107bar = spwrec.obsctrf81;
+                   f107bar = spwtab.obsctrf81[recnum];
              }
-           avgap = spwrec.avgap;
-           sumkp = spwrec.sumkp;
+           avgap = spwtab.avgap[recnum];
+           sumkp = spwtab.sumkp[recnum];
 
            // ---- get last ap/kp array value from the current time value
            idx = floor(mfme/180.0); // values change at 0, 3, 6, ... hrs
@@ -520,18 +758,18 @@ void findatmosparam
              {
                if (j >= 0)
                  {
-                   aparr[8-i] = spwrec.aparr[j];
-                   kparr[8-i] = spwrec.kparr[j];
+                   aparr[8-i] = spwtab.aparr[j][recnum];
+                   kparr[8-i] = spwtab.kparr[j][recnum];
                  }
                  else
                  {
-                   aparr[8-i] = lastspwrec.aparr[8+j];
-                   kparr[8-i] = lastspwrec.kparr[8+j];
+                   aparr[8-i] = spwtab.aparr[8+j][last];
+                   kparr[8-i] = spwtab.kparr[8+j][last];
                  }
                j = j - 1;
              }
-           ap = spwrec.aparr[ idx ];
-           kp = spwrec.kparr[ idx ]*0.1;
+           ap = spwtab.aparr[ idx ][recnum];
+           kp = spwtab.kparr[ idx ][recnum]*0.1;
 
            // ------------------------ do interpolation ------------------------
            if (interp != 'n')
@@ -541,31 +779,31 @@ void findatmosparam
                    if (mfme > fluxtime-720.0) // go 12 hrs before...
                      {
                        if (mfme > fluxtime)
-                           tempspwrec = nextspwrec;
+                           temp = next;
                          else
-                           tempspwrec = lastspwrec;
+                           temp = last;
                        fixf = (fluxtime - mfme) / 1440.0;
                      }
                      else
                      {
-                       tempspwrec = lastspwrec;
+                       temp = last;
                        fixf = (mfme + (1440 - fluxtime)) / 1440.0;
                      }
                    if (fluxtype == 'a') // adjusted or observed values
                      {
-                       tf107 = tempspwrec.adjf10;
+                       tf107 = spwtab.adjf10[temp];
                        if (f81type == 'l')
-                           tf107bar = tempspwrec.adjlstf81;
+                           tf107bar = spwtab.adjlstf81[temp];
                          else
-                           tf107bar = tempspwrec.adjctrf81;
+                           tf107bar = spwtab.adjctrf81[temp];
                      }
                      else
                      {
-                       tf107 = tempspwrec.obsf10;
+                       tf107 = spwtab.obsf10[temp];
                        if (f81type == 'l')
-                           tf107bar = tempspwrec.obslstf81;
+                           tf107bar = spwtab.obslstf81[temp];
                          else
-                           tf107bar = tempspwrec.obsctrf81;
+                           tf107bar = spwtab.obsctrf81[temp];
                      }
                    // ---- perform simple linear interpolation
                    if (mfme <= fluxtime)
@@ -606,26 +844,26 @@ void findatmosparam
                    fixa = (720 - mfme) / 1440.0;
                    if (mfme > 720)
                      {
-                       avgap = avgap - (nextspwrec.avgap - avgap) * fixa;
-                       sumkp = nextspwrec.sumkp - (nextspwrec.sumkp - sumkp) * (mfme/1440.0);
+                       avgap = avgap - (spwtab.avgap[next] - avgap) * fixa;
+                       sumkp = spwtab.sumkp[next] - (spwtab.sumkp[next] - sumkp) * (mfme/1440.0);
                      }
                      else
                      {
-                       avgap = avgap - (avgap - lastspwrec.avgap) * fixa;
-                       sumkp = sumkp - (sumkp - lastspwrec.sumkp) * (1440.0-mfme)/1440.0;
+                       avgap = avgap - (avgap - spwtab.avgap[last]) * fixa;
+                       sumkp = sumkp - (sumkp - spwtab.sumkp[last]) * (1440.0-mfme)/1440.0;
                      }
 
                    // this fraction is the same for the remainder of calculations
                    fixa = (fmod(mfme,180)) / 180.0;
                    if (idx+1 < 8 )
                      {
-                       ap = spwrec.aparr[idx] + (spwrec.aparr[idx+1]-spwrec.aparr[idx]) * fixa;
-                       kp = (spwrec.kparr[idx] + (spwrec.aparr[idx+1]-spwrec.aparr[idx]) * fixa)*0.1;
+                       ap = spwtab.aparr[idx][recnum] + (spwtab.aparr[idx+1][recnum]-spwtab.aparr[idx][recnum]) * fixa;
+                       kp = (spwtab.kparr[idx][recnum] + (spwtab.aparr[idx+1][recnum]-spwtab.aparr[idx][recnum]) * fixa)*0.1;
                      }
                      else
                      {
-                       ap = spwrec.aparr[idx] + (nextspwrec.aparr[0]-spwrec.aparr[idx]) * fixa;
-                       kp = (spwrec.kparr[idx] + (nextspwrec.aparr[0]-spwrec.aparr[idx]) * fixa)*0.1;
+                       ap = spwtab.aparr[idx][recnum] + (spwtab.aparr[0][next]-spwtab.aparr[idx][recnum]) * fixa;
+                       kp = (spwtab.kparr[idx][recnum] + (spwtab.aparr[0][next]-spwtab.aparr[idx][recnum]) * fixa)*0.1;
                      }
 
                    // step down from idx through the 8 points
@@ -637,26 +875,26 @@ void findatmosparam
                          {
                            if (j+1 < 8)
                              {
-                               aparr[8-i] = spwrec.aparr[j] + (spwrec.aparr[j+1] - spwrec.aparr[j]) * fixa;
-                               kparr[8-i] = spwrec.kparr[j] + (spwrec.kparr[j+1] - spwrec.kparr[j]) * fixa;
+                               aparr[8-i] = spwtab.aparr[j][recnum] + (spwtab.aparr[j+1][recnum] - spwtab.aparr[j][recnum]) * fixa;
+                               kparr[8-i] = spwtab.kparr[j][recnum] + (spwtab.kparr[j+1][recnum] - spwtab.kparr[j][recnum]) * fixa;
                              }
                              else // j = 0
                              {
-                               aparr[8-i] = spwrec.aparr[j] + (nextspwrec.aparr[0] - spwrec.aparr[j]) * fixa;
-                               kparr[8-i] = spwrec.kparr[j] + (nextspwrec.kparr[0] - spwrec.kparr[j]) * fixa;
+                               aparr[8-i] = spwtab.aparr[j][recnum] + (spwtab.aparr[0][next] - spwtab.aparr[j][recnum]) * fixa;
+                               kparr[8-i] = spwtab.kparr[j][recnum] + (spwtab.kparr[0][next] - spwtab.kparr[j][recnum]) * fixa;
                              }
                          }
                          else
                          {    // j = -2 .. -7
                            if (j < -1)
                              {
-                               aparr[8-i] = lastspwrec.aparr[8+j] + (lastspwrec.aparr[9+j] - lastspwrec.aparr[8+j]) * fixa;
-                               kparr[8-i] = lastspwrec.kparr[8+j] + (lastspwrec.kparr[9+j] - lastspwrec.kparr[8+j]) * fixa;
+                               aparr[8-i] = spwtab.aparr[8+j][last] + (spwtab.aparr[9+j][last] - spwtab.aparr[8+j][last]) * fixa;
+                               kparr[8-i] = spwtab.kparr[8+j][last] + (spwtab.kparr[9+j][last] - spwtab.kparr[8+j][last]) * fixa;
                              }
                              else // j = -1
                              {
-                               aparr[8-i] = lastspwrec.aparr[7] + (spwrec.aparr[0] - lastspwrec.aparr[7]) * fixa;
-                               kparr[8-i] = lastspwrec.kparr[7] + (spwrec.kparr[0] - lastspwrec.kparr[7]) * fixa;
+                               aparr[8-i] = spwtab.aparr[7][last] + (spwtab.aparr[0][recnum] - spwtab.aparr[7][last]) * fixa;
+                               kparr[8-i] = spwtab.kparr[7][last] + (spwtab.kparr[0][recnum] - spwtab.kparr[7][last]) * fixa;
                              }
                          }
 
@@ -20,6 +20,7 @@
 *            21 mar 08  david vallado
 *                           misc fixes
 *  changes :
+*            column tables (eoptable, spwtable) with binary file format
 *            14 dec 05  david vallado
 *                           misc fixes
 *            21 oct 05  david vallado
@@ -32,6 +33,11 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include <memory>
+#include <vector>
+
+class MappedFile;
+
 
 /*    *****************************************************************
 *     type definitions
@@ -54,29 +60,107 @@ typedef struct spwdata
               isn,     q,         aparr[8],  kparr[8], sumkp;
   } spwdata;
 
-const int eopsize = 40000;
-const int spwsize = 41500;
+// eop and space weather data are held in structure-of-arrays form: every
+// quantity is a column of numrecs doubles, indexed by the day number from
+// jdstart. the columns either point into a block filled by initeop/initspw
+// or into a binary file mapped by readeopbin/readspwbin, which has a 64-byte
+// header followed by the columns in the same order.
+
+class datatable
+  {
+    public:
+       datatable();
+
+       int     numrecs;          // number of daily records
+       int     numcols;          // number of columns
+       double  jdstart;          // julian date of record 0
+
+       // column c (numrecs values)
+       const double* column(int c) const { return data + (size_t)c*numrecs; }
+
+    protected:
+       double* allocate(int nrecs, int ncols, double jd);
+       bool    write(const char* filename, const char magic[8]) const;
+       bool    read (const char* filename, const char magic[8], int ncols);
+
+       const double*               data;
+       std::vector<double>         store;     // tables read from text files
+       std::shared_ptr<MappedFile> map;       // tables mapped from binary files
+
+    private:
+       datatable(const datatable&);
+       datatable& operator= (const datatable&);
+  };
+
+class eoptable : public datatable
+  {
+    public:
+       eoptable();
+
+       // columns
+       enum { cxp, cyp, cdut1, clod, cddpsi, cddeps, cdx, cdy, cdat, cmjd, ncols };
+       const double *xp, *yp, *dut1, *lod, *ddpsi, *ddeps, *dx, *dy, *dat, *mjd;
+
+       double* allocate(int nrecs, double jd);
+       bool    write(const char* filename) const;
+       bool    read (const char* filename);
+
+    private:
+       void setcolumns();
+  };
+
+class spwtable : public datatable
+  {
+    public:
+       spwtable();
+
+       // columns (ap and kp of the eight 3-hour intervals are stored as eight
+       // columns each, kp in tenths as in the cssi files)
+       enum { cadjf10, cadjctrf81, cadjlstf81, cobsf10, cobsctrf81, cobslstf81,
+              cavgap, csumkp, caparr, ckparr = caparr+8, ncols = ckparr+8 };
+       const double *adjf10, *adjctrf81, *adjlstf81, *obsf10, *obsctrf81,
+                    *obslstf81, *avgap, *sumkp, *aparr[8], *kparr[8];
+
+       double* allocate(int nrecs, double jd);
+       bool    write(const char* filename) const;
+       bool    read (const char* filename);
+
+    private:
+       void setcolumns();
+  };
 
 /*    *****************************************************************
 *     routines
 *     *****************************************************************    */
 
-void initspw
+bool initspw
+     (
+       const char* filename,
+       spwtable&   spwtab
+     );
+
+bool initeop
+     (
+       const char* filename,
+       eoptable&   eoptab
+     );
+
+bool readspwbin
      (
-       spwdata spwarr[spwsize],
-       double& jdspwstart
+       const char* filename,
+       spwtable&   spwtab
      );
 
-void initeop
+bool readeopbin
      (
-       eopdata eoparr[eopsize],
-       double& jdeopstart
+       const char* filename,
+       eoptable&   eoptab
      );
 
 void findeopparam
      (
        double  jd,       double mfme,     char interp,
-       eopdata eoparr[eopsize],           double jdeopstart,
+       const eoptable& eoptab,
        double& dut1,     int& dat,
        double& lod,      double& xp,      double& yp,
        double& ddpsi,    double& ddeps,   double& dx,   double& dy,
@@ -87,7 +171,7 @@ void findeopparam
 void findatmosparam
      (
        double jd, double mfme, char interp, char fluxtype, char f81type, char inputtype,
-       spwdata spwarr[spwsize], double jdspwstart,
+       const spwtable& spwtab,
        double& f107, double& f107bar,
        double& ap, double& avgap, double aparr[8],
        double& kp, double& sumkp, double kparr[8]
@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------------
+//
+// hpop_convert
+//
+// Purpose:
+//
+//   Converts the text data files of the orbit propagator into the binary
+//   files that are mapped into memory at start-up
+//
+// Usage:
+//
+//   hpop_convert ggm <in.txt> <out.bin> [n_max [GM R_ref]]
+//
+//     GGM-style gravity model (lines "n m C S sigma_C sigma_S"); the
+//     defaults are the degree and constants of GGM03C
+//
+//   hpop_convert eop <EOP-All.txt> <out.bin>
+//   hpop_convert spw <SW-All.txt> <out.bin>
+//
+//     CSSI Earth orientation and space weather files (Celestrak)
+//
+// (c) 1999-2024  O. Montenbruck, E. Gill, Meysam Mahooti, and David A. Vallado
+//
+//------------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "SAT_Gravity.h"
+#include "eopspw.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+//
+// ConvertGravity
+//
+//------------------------------------------------------------------------------
+static int ConvertGravity(int argc, char* argv[])
+{
+    int    n_max = 360;                // GGM03C
+    double GM    = 398600.4415e9;      // [m^3/s^2]
+    double R_ref = 6378.1363e3;        // [m]
+
+    if (argc != 4 && argc != 5 && argc != 7) {
+        cerr << "Usage: " << argv[0] << " ggm <in.txt> <out.bin> [n_max [GM R_ref]]"
+             << endl;
+        return 1;
+    }
+    if (argc >= 5) n_max = atoi(argv[4]);
+    if (argc == 7) {
+        GM    = atof(argv[5]);
+        R_ref = atof(argv[6]);
+    }
+
+    GravityField Field(0, GM, R_ref);
+
+    if (!ReadGravityText(argv[2], n_max, GM, R_ref, Field)) {
+        cerr << "Error: Could not read degree " << n_max << " from " << argv[2]
+             << endl;
+        return 1;
+    }
+    if (!WriteGravityBinary(argv[3], Field)) {
+        cerr << "Error: Could not write " << argv[3] << endl;
+        return 1;
+    }
+
+    cout << "Gravity model of degree " << n_max << " written to " << argv[3]
+         << endl;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+//
+// ConvertTable
+//
+//------------------------------------------------------------------------------
+template <class Table>
+static int ConvertTable(int argc, char* argv[],
+                        bool (*init)(const char*, Table&))
+{
+    Table tab;
+
+    if (argc != 4) {
+        cerr << "Usage: " << argv[0] << " " << argv[1] << " <in.txt> <out.bin>"
+             << endl;
+        return 1;
+    }
+    if (!init(argv[2], tab)) {
+        cerr << "Error: Could not read " << argv[2] << endl;
+        return 1;
+    }
+    if (!tab.write(argv[3])) {
+        cerr << "Error: Could not write " << argv[3] << endl;
+        return 1;
+    }
+
+    cout << tab.numrecs << " daily records written to " << argv[3] << endl;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+//
+// Main program
+//
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " ggm|eop|spw <in.txt> <out.bin> ..."
+             << endl;
+        return 1;
+    }
+
+    string kind = argv[1];
+    if (kind == "ggm")
+        return ConvertGravity(argc, argv);
+    if (kind == "eop")
+        return ConvertTable<eoptable>(argc, argv, initeop);
+    if (kind == "spw")
+        return ConvertTable<spwtable>(argc, argv, initspw);
+
+    cerr << "Error: Unknown file type " << kind << endl;
+    return 1;
+}
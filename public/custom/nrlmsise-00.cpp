@@ -33,23 +33,8 @@
 /* ------------------------- SHARED VARIABLES ------------------------ */
 /* ------------------------------------------------------------------- */
 
-/* PARMB */
-static double gsurf;
-static double re;
-
-/* GTS3C */
-static double dd;
-
-/* DMIX */
-static double dm04, dm16, dm28, dm32, dm40, dm01, dm14;
-
-/* MESO7 */
-static double meso_tn1[5];
-static double meso_tn2[4];
-static double meso_tn3[5];
-static double meso_tgn1[2];
-static double meso_tgn2[2];
-static double meso_tgn3[2];
+/* The intermediate results shared between the routines (PARMB, GTS3C,
+ * DMIX, MESO7, LPOLY) are kept in struct nrlmsise_workspace. */
 
 /* POWER7 */
 extern double pt[150];
@@ -64,17 +49,6 @@ extern double sam[100];
 extern double ptm[10];
 extern double pdm[8][10];
 extern double pavgm[10];
-
-/* LPOLY */
-static double dfa;
-static double plg[4][9];
-static double ctloc, stloc;
-static double c2tloc, s2tloc;
-static double s3tloc, c3tloc;
-static double apdf, apt[4];
-
-
-
 /* ------------------------------------------------------------------- */
 /* ------------------------------ TSELEC ----------------------------- */
 /* ------------------------------------------------------------------- */
@@ -172,10 +146,10 @@ double ccor2(double alt, double r, double h1, double zh, double h2) {
 /* ------------------------------- SCALH ----------------------------- */
 /* ------------------------------------------------------------------- */
 
-double scalh(double alt, double xm, double temp) {
+double scalh(struct nrlmsise_workspace *ws, double alt, double xm, double temp) {
 	double g;
 	double rgas=831.4;
-	g = gsurf / (pow((1.0 + alt/re),2.0));
+	g = ws->gsurf / (pow((1.0 + alt/ws->re),2.0));
 	g = rgas * temp / (g * xm);
 	return g;
 }
@@ -347,11 +321,11 @@ void spline (double *x, double *y, int n, double yp1, double ypn, double *y2) {
 /* ------------------------------- DENSM ----------------------------- */
 /* ------------------------------------------------------------------- */
 
-__inline_double zeta(double zz, double zl) {
-	return ((zz-zl)*(re+zl)/(re+zz));
+__inline_double zeta(struct nrlmsise_workspace *ws, double zz, double zl) {
+	return ((zz-zl)*(ws->re+zl)/(ws->re+zz));
 }
 
-double densm (double alt, double d0, double xm, double *tz, int mn3, double *zn3, double *tn3, double *tgn3, int mn2, double *zn2, double *tn2, double *tgn2) {
+double densm (struct nrlmsise_workspace *ws, double alt, double d0, double xm, double *tz, int mn3, double *zn3, double *tn3, double *tgn3, int mn2, double *zn2, double *tn2, double *tgn2) {
 /*      Calculate Temperature and Density Profiles for lower atmos.  */
 	double xs[10], ys[10], y2out[10];
 	double rgas = 831.4;
@@ -380,16 +354,16 @@ double densm (double alt, double d0, double xm, double *tz, int mn3, double *zn3
 	z2=zn2[mn-1];
 	t1=tn2[0];
 	t2=tn2[mn-1];
-	zg = zeta(z, z1);
-	zgdif = zeta(z2, z1);
+	zg = zeta(ws, z, z1);
+	zgdif = zeta(ws, z2, z1);
 
 	/* set up spline nodes */
 	for (k=0;k<mn;k++) {
-		xs[k]=zeta(zn2[k],z1)/zgdif;
+		xs[k]=zeta(ws, zn2[k],z1)/zgdif;
 		ys[k]=1.0 / tn2[k];
 	}
 	yd1=-tgn2[0] / (t1*t1) * zgdif;
-	yd2=-tgn2[1] / (t2*t2) * zgdif * (pow(((re+z2)/(re+z1)),2.0));
+	yd2=-tgn2[1] / (t2*t2) * zgdif * (pow(((ws->re+z2)/(ws->re+z1)),2.0));
 
 	/* calculate spline coefficients */
 	spline (xs, ys, mn, yd1, yd2, y2out);
@@ -400,7 +374,7 @@ double densm (double alt, double d0, double xm, double *tz, int mn3, double *zn3
 	*tz = 1.0 / y;
 	if (xm!=0.0) {
 		/* calaculate stratosphere / mesospehere density */
-		glb = gsurf / (pow((1.0 + z1/re),2.0));
+		glb = ws->gsurf / (pow((1.0 + z1/ws->re),2.0));
 		gamm = xm * glb * zgdif / rgas;
 
 		/* Integrate temperature profile */
@@ -427,16 +401,16 @@ double densm (double alt, double d0, double xm, double *tz, int mn3, double *zn3
 	z2=zn3[mn-1];
 	t1=tn3[0];
 	t2=tn3[mn-1];
-	zg=zeta(z,z1);
-	zgdif=zeta(z2,z1);
+	zg=zeta(ws, z,z1);
+	zgdif=zeta(ws, z2,z1);
 
 	/* set up spline nodes */
 	for (k=0;k<mn;k++) {
-		xs[k] = zeta(zn3[k],z1) / zgdif;
+		xs[k] = zeta(ws, zn3[k],z1) / zgdif;
 		ys[k] = 1.0 / tn3[k];
 	}
 	yd1=-tgn3[0] / (t1*t1) * zgdif;
-	yd2=-tgn3[1] / (t2*t2) * zgdif * (pow(((re+z2)/(re+z1)),2.0));
+	yd2=-tgn3[1] / (t2*t2) * zgdif * (pow(((ws->re+z2)/(ws->re+z1)),2.0));
 
 	/* calculate spline coefficients */
 	spline (xs, ys, mn, yd1, yd2, y2out);
@@ -447,7 +421,7 @@ double densm (double alt, double d0, double xm, double *tz, int mn3, double *zn3
 	*tz = 1.0 / y;
 	if (xm!=0.0) {
 		/* calaculate tropospheric / stratosphere density */
-		glb = gsurf / (pow((1.0 + z1/re),2.0));
+		glb = ws->gsurf / (pow((1.0 + z1/ws->re),2.0));
 		gamm = xm * glb * zgdif / rgas;
 
 		/* Integrate temperature profile */
@@ -471,7 +445,7 @@ double densm (double alt, double d0, double xm, double *tz, int mn3, double *zn3
 /* ------------------------------- DENSU ----------------------------- */
 /* ------------------------------------------------------------------- */
 
-double densu (double alt, double dlb, double tinf, double tlb, double xm, double alpha, double *tz, double zlb, double s2, int mn1, double *zn1, double *tn1, double *tgn1) {
+double densu (struct nrlmsise_workspace *ws, double alt, double dlb, double tinf, double tlb, double xm, double alpha, double *tz, double zlb, double s2, int mn1, double *zn1, double *tn1, double *tgn1) {
 /*      Calculate Temperature and Density Profiles for MSIS models
  *      New lower thermo polynomial
  */
@@ -496,7 +470,7 @@ double densu (double alt, double dlb, double tinf, double tlb, double xm, double
 		z=za;
 
 	/* geopotential altitude difference from ZLB */
-	zg2 = zeta(z, zlb);
+	zg2 = zeta(ws, z, zlb);
 
 	/* Bates temperature */
 	tt = tinf - (tinf - tlb) * exp(-s2*zg2);
@@ -507,7 +481,7 @@ double densu (double alt, double dlb, double tinf, double tlb, double xm, double
 	if (alt<za) {
 		/* calculate temperature below ZA
 		 * temperature gradient at ZA from Bates profile */
-		dta = (tinf - ta) * s2 * pow(((re+zlb)/(re+za)),2.0);
+		dta = (tinf - ta) * s2 * pow(((ws->re+zlb)/(ws->re+za)),2.0);
 		tgn1[0]=dta;
 		tn1[0]=ta;
 		if (alt>zn1[mn1-1])
@@ -520,16 +494,16 @@ double densu (double alt, double dlb, double tinf, double tlb, double xm, double
 		t1=tn1[0];
 		t2=tn1[mn-1];
 		/* geopotental difference from z1 */
-		zg = zeta (z, z1);
-		zgdif = zeta(z2, z1);
+		zg = zeta (ws, z, z1);
+		zgdif = zeta(ws, z2, z1);
 		/* set up spline nodes */
 		for (k=0;k<mn;k++) {
-			xs[k] = zeta(zn1[k], z1) / zgdif;
+			xs[k] = zeta(ws, zn1[k], z1) / zgdif;
 			ys[k] = 1.0 / tn1[k];
 		}
 		/* end node derivatives */
 		yd1 = -tgn1[0] / (t1*t1) * zgdif;
-		yd2 = -tgn1[1] / (t2*t2) * zgdif * pow(((re+z2)/(re+z1)),2.0);
+		yd2 = -tgn1[1] / (t2*t2) * zgdif * pow(((ws->re+z2)/(ws->re+z1)),2.0);
 		/* calculate spline coefficients */
 		spline (xs, ys, mn, yd1, yd2, y2out);
 		x = zg / zgdif;
@@ -542,7 +516,7 @@ double densu (double alt, double dlb, double tinf, double tlb, double xm, double
 		return densu_temp;
 
 	/* calculate density above za */
-	glb = gsurf / pow((1.0 + zlb/re),2.0);
+	glb = ws->gsurf / pow((1.0 + zlb/ws->re),2.0);
 	gamma = xm * glb / (s2 * rgas * tinf);
 	expl = exp(-s2 * gamma * zg2);
 	if (expl>50.0)
@@ -557,7 +531,7 @@ double densu (double alt, double dlb, double tinf, double tlb, double xm, double
 		return densu_temp;
 
 	/* calculate density below za */
-	glb = gsurf / pow((1.0 + z1/re),2.0);
+	glb = ws->gsurf / pow((1.0 + z1/ws->re),2.0);
 	gamm = xm * glb * zgdif / rgas;
 
 	/* integrate spline temperatures */
@@ -597,7 +571,7 @@ __inline_double sg0(double ex, double *p, double *ap) {
                 g0(ap[6],p)*pow(ex,12.0))*(1.0-pow(ex,8.0))/(1.0-ex)))/sumex(ex);
 }
 
-double globe7(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *flags) {
+double globe7(struct nrlmsise_workspace *ws, double *p, struct nrlmsise_input *input, struct nrlmsise_flags *flags) {
 /*       CALCULATE G(L) FUNCTION 
  *       Upper Thermosphere Parameters */
 	double t[15];
@@ -626,39 +600,39 @@ double globe7(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *fl
 	c4 = c2*c2;
 	s2 = s*s;
 
-	plg[0][1] = c;
-	plg[0][2] = 0.5*(3.0*c2 -1.0);
-	plg[0][3] = 0.5*(5.0*c*c2-3.0*c);
-	plg[0][4] = (35.0*c4 - 30.0*c2 + 3.0)/8.0;
-	plg[0][5] = (63.0*c2*c2*c - 70.0*c2*c + 15.0*c)/8.0;
-	plg[0][6] = (11.0*c*plg[0][5] - 5.0*plg[0][4])/6.0;
+	ws->plg[0][1] = c;
+	ws->plg[0][2] = 0.5*(3.0*c2 -1.0);
+	ws->plg[0][3] = 0.5*(5.0*c*c2-3.0*c);
+	ws->plg[0][4] = (35.0*c4 - 30.0*c2 + 3.0)/8.0;
+	ws->plg[0][5] = (63.0*c2*c2*c - 70.0*c2*c + 15.0*c)/8.0;
+	ws->plg[0][6] = (11.0*c*ws->plg[0][5] - 5.0*ws->plg[0][4])/6.0;
 /*      plg[0][7] = (13.0*c*plg[0][6] - 6.0*plg[0][5])/7.0; */
-	plg[1][1] = s;
-	plg[1][2] = 3.0*c*s;
-	plg[1][3] = 1.5*(5.0*c2-1.0)*s;
-	plg[1][4] = 2.5*(7.0*c2*c-3.0*c)*s;
-	plg[1][5] = 1.875*(21.0*c4 - 14.0*c2 +1.0)*s;
-	plg[1][6] = (11.0*c*plg[1][5]-6.0*plg[1][4])/5.0;
+	ws->plg[1][1] = s;
+	ws->plg[1][2] = 3.0*c*s;
+	ws->plg[1][3] = 1.5*(5.0*c2-1.0)*s;
+	ws->plg[1][4] = 2.5*(7.0*c2*c-3.0*c)*s;
+	ws->plg[1][5] = 1.875*(21.0*c4 - 14.0*c2 +1.0)*s;
+	ws->plg[1][6] = (11.0*c*ws->plg[1][5]-6.0*ws->plg[1][4])/5.0;
 /*      plg[1][7] = (13.0*c*plg[1][6]-7.0*plg[1][5])/6.0; */
 /*      plg[1][8] = (15.0*c*plg[1][7]-8.0*plg[1][6])/7.0; */
-	plg[2][2] = 3.0*s2;
-	plg[2][3] = 15.0*s2*c;
-	plg[2][4] = 7.5*(7.0*c2 -1.0)*s2;
-	plg[2][5] = 3.0*c*plg[2][4]-2.0*plg[2][3];
-	plg[2][6] =(11.0*c*plg[2][5]-7.0*plg[2][4])/4.0;
-	plg[2][7] =(13.0*c*plg[2][6]-8.0*plg[2][5])/5.0;
-	plg[3][3] = 15.0*s2*s;
-	plg[3][4] = 105.0*s2*s*c; 
-	plg[3][5] =(9.0*c*plg[3][4]-7.*plg[3][3])/2.0;
-	plg[3][6] =(11.0*c*plg[3][5]-8.*plg[3][4])/3.0;
+	ws->plg[2][2] = 3.0*s2;
+	ws->plg[2][3] = 15.0*s2*c;
+	ws->plg[2][4] = 7.5*(7.0*c2 -1.0)*s2;
+	ws->plg[2][5] = 3.0*c*ws->plg[2][4]-2.0*ws->plg[2][3];
+	ws->plg[2][6] =(11.0*c*ws->plg[2][5]-7.0*ws->plg[2][4])/4.0;
+	ws->plg[2][7] =(13.0*c*ws->plg[2][6]-8.0*ws->plg[2][5])/5.0;
+	ws->plg[3][3] = 15.0*s2*s;
+	ws->plg[3][4] = 105.0*s2*s*c; 
+	ws->plg[3][5] =(9.0*c*ws->plg[3][4]-7.*ws->plg[3][3])/2.0;
+	ws->plg[3][6] =(11.0*c*ws->plg[3][5]-8.*ws->plg[3][4])/3.0;
 
 	if (!(((flags->sw[7]==0)&&(flags->sw[8]==0))&&(flags->sw[14]==0))) {
-		stloc = sin(hr*tloc);
-		ctloc = cos(hr*tloc);
-		s2tloc = sin(2.0*hr*tloc);
-		c2tloc = cos(2.0*hr*tloc);
-		s3tloc = sin(3.0*hr*tloc);
-		c3tloc = cos(3.0*hr*tloc);
+		ws->stloc = sin(hr*tloc);
+		ws->ctloc = cos(hr*tloc);
+		ws->s2tloc = sin(2.0*hr*tloc);
+		ws->c2tloc = cos(2.0*hr*tloc);
+		ws->s3tloc = sin(3.0*hr*tloc);
+		ws->c3tloc = cos(3.0*hr*tloc);
 	}
 
 	cd32 = cos(dr*(input->doy-p[31]));
@@ -668,48 +642,48 @@ double globe7(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *fl
 
 	/* F10.7 EFFECT */
 	df = input->f107 - input->f107A;
-	dfa = input->f107A - 150.0;
-	t[0] =  p[19]*df*(1.0+p[59]*dfa) + p[20]*df*df + p[21]*dfa + p[29]*pow(dfa,2.0);
-	f1 = 1.0 + (p[47]*dfa +p[19]*df+p[20]*df*df)*flags->swc[1];
-	f2 = 1.0 + (p[49]*dfa+p[19]*df+p[20]*df*df)*flags->swc[1];
+	ws->dfa = input->f107A - 150.0;
+	t[0] =  p[19]*df*(1.0+p[59]*ws->dfa) + p[20]*df*df + p[21]*ws->dfa + p[29]*pow(ws->dfa,2.0);
+	f1 = 1.0 + (p[47]*ws->dfa +p[19]*df+p[20]*df*df)*flags->swc[1];
+	f2 = 1.0 + (p[49]*ws->dfa+p[19]*df+p[20]*df*df)*flags->swc[1];
 
 	/*  TIME INDEPENDENT */
-	t[1] = (p[1]*plg[0][2]+ p[2]*plg[0][4]+p[22]*plg[0][6]) + \
-	      (p[14]*plg[0][2])*dfa*flags->swc[1] +p[26]*plg[0][1];
+	t[1] = (p[1]*ws->plg[0][2]+ p[2]*ws->plg[0][4]+p[22]*ws->plg[0][6]) + \
+	      (p[14]*ws->plg[0][2])*ws->dfa*flags->swc[1] +p[26]*ws->plg[0][1];
 
 	/*  SYMMETRICAL ANNUAL */
 	t[2] = p[18]*cd32;
 
 	/*  SYMMETRICAL SEMIANNUAL */
-	t[3] = (p[15]+p[16]*plg[0][2])*cd18;
+	t[3] = (p[15]+p[16]*ws->plg[0][2])*cd18;
 
 	/*  ASYMMETRICAL ANNUAL */
-	t[4] =  f1*(p[9]*plg[0][1]+p[10]*plg[0][3])*cd14;
+	t[4] =  f1*(p[9]*ws->plg[0][1]+p[10]*ws->plg[0][3])*cd14;
 
 	/*  ASYMMETRICAL SEMIANNUAL */
-	t[5] =    p[37]*plg[0][1]*cd39;
+	t[5] =    p[37]*ws->plg[0][1]*cd39;
 
         /* DIURNAL */
 	if (flags->sw[7]) {
 		double t71, t72;
-		t71 = (p[11]*plg[1][2])*cd14*flags->swc[5];
-		t72 = (p[12]*plg[1][2])*cd14*flags->swc[5];
-		t[6] = f2*((p[3]*plg[1][1] + p[4]*plg[1][3] + p[27]*plg[1][5] + t71) * \
-			   ctloc + (p[6]*plg[1][1] + p[7]*plg[1][3] + p[28]*plg[1][5] \
-				    + t72)*stloc);
+		t71 = (p[11]*ws->plg[1][2])*cd14*flags->swc[5];
+		t72 = (p[12]*ws->plg[1][2])*cd14*flags->swc[5];
+		t[6] = f2*((p[3]*ws->plg[1][1] + p[4]*ws->plg[1][3] + p[27]*ws->plg[1][5] + t71) * \
+			   ws->ctloc + (p[6]*ws->plg[1][1] + p[7]*ws->plg[1][3] + p[28]*ws->plg[1][5] \
+				    + t72)*ws->stloc);
 }
 
 	/* SEMIDIURNAL */
 	if (flags->sw[8]) {
 		double t81, t82;
-		t81 = (p[23]*plg[2][3]+p[35]*plg[2][5])*cd14*flags->swc[5];
-		t82 = (p[33]*plg[2][3]+p[36]*plg[2][5])*cd14*flags->swc[5];
-		t[7] = f2*((p[5]*plg[2][2]+ p[41]*plg[2][4] + t81)*c2tloc +(p[8]*plg[2][2] + p[42]*plg[2][4] + t82)*s2tloc);
+		t81 = (p[23]*ws->plg[2][3]+p[35]*ws->plg[2][5])*cd14*flags->swc[5];
+		t82 = (p[33]*ws->plg[2][3]+p[36]*ws->plg[2][5])*cd14*flags->swc[5];
+		t[7] = f2*((p[5]*ws->plg[2][2]+ p[41]*ws->plg[2][4] + t81)*ws->c2tloc +(p[8]*ws->plg[2][2] + p[42]*ws->plg[2][4] + t82)*ws->s2tloc);
 	}
 
 	/* TERDIURNAL */
 	if (flags->sw[14]) {
-		t[13] = f2 * ((p[39]*plg[3][3]+(p[93]*plg[3][4]+p[46]*plg[3][6])*cd14*flags->swc[5])* s3tloc +(p[40]*plg[3][3]+(p[94]*plg[3][4]+p[48]*plg[3][6])*cd14*flags->swc[5])* c3tloc);
+		t[13] = f2 * ((p[39]*ws->plg[3][3]+(p[93]*ws->plg[3][4]+p[46]*ws->plg[3][6])*cd14*flags->swc[5])* ws->s3tloc +(p[40]*ws->plg[3][3]+(p[94]*ws->plg[3][4]+p[48]*ws->plg[3][6])*cd14*flags->swc[5])* ws->c3tloc);
 }
 
 	/* magnetic activity based on daily ap */
@@ -722,15 +696,15 @@ double globe7(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *fl
 				exp1=0.99999;
 			if (p[24]<1.0E-4)
 				p[24]=1.0E-4;
-			apt[0]=sg0(exp1,p,ap->a);
+			ws->apt[0]=sg0(exp1,p,ap->a);
 			/* apt[1]=sg2(exp1,p,ap->a);
-			   apt[2]=sg0(exp2,p,ap->a);
-			   apt[3]=sg2(exp2,p,ap->a);
+			   ws->apt[2]=sg0(exp2,p,ap->a);
+			   ws->apt[3]=sg2(exp2,p,ap->a);
 			*/
 			if (flags->sw[9]) {
-				t[8] = apt[0]*(p[50]+p[96]*plg[0][2]+p[54]*plg[0][4]+ \
-     (p[125]*plg[0][1]+p[126]*plg[0][3]+p[127]*plg[0][5])*cd14*flags->swc[5]+ \
-     (p[128]*plg[1][1]+p[129]*plg[1][3]+p[130]*plg[1][5])*flags->swc[7]* \
+				t[8] = ws->apt[0]*(p[50]+p[96]*ws->plg[0][2]+p[54]*ws->plg[0][4]+ \
+     (p[125]*ws->plg[0][1]+p[126]*ws->plg[0][3]+p[127]*ws->plg[0][5])*cd14*flags->swc[5]+ \
+     (p[128]*ws->plg[1][1]+p[129]*ws->plg[1][3]+p[130]*ws->plg[1][5])*flags->swc[7]* \
 					       cos(hr*(tloc-p[131])));
 			}
 		}
@@ -741,11 +715,11 @@ double globe7(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *fl
 		p45=p[44];
 		if (p44<0)
 			p44 = 1.0E-5;
-		apdf = apd + (p45-1.0)*(apd + (exp(-p44 * apd) - 1.0)/p44);
+		ws->apdf = apd + (p45-1.0)*(apd + (exp(-p44 * apd) - 1.0)/p44);
 		if (flags->sw[9]) {
-			t[8]=apdf*(p[32]+p[45]*plg[0][2]+p[34]*plg[0][4]+ \
-     (p[100]*plg[0][1]+p[101]*plg[0][3]+p[102]*plg[0][5])*cd14*flags->swc[5]+
-     (p[121]*plg[1][1]+p[122]*plg[1][3]+p[123]*plg[1][5])*flags->swc[7]*
+			t[8]=ws->apdf*(p[32]+p[45]*ws->plg[0][2]+p[34]*ws->plg[0][4]+ \
+     (p[100]*ws->plg[0][1]+p[101]*ws->plg[0][3]+p[102]*ws->plg[0][5])*cd14*flags->swc[5]+
+     (p[121]*ws->plg[1][1]+p[122]*ws->plg[1][3]+p[123]*ws->plg[1][5])*flags->swc[7]*
 				    cos(hr*(tloc-p[124])));
 		}
 	}
@@ -754,51 +728,51 @@ double globe7(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *fl
 
 		/* longitudinal */
 		if (flags->sw[11]) {
-			t[10] = (1.0 + p[80]*dfa*flags->swc[1])* \
-     ((p[64]*plg[1][2]+p[65]*plg[1][4]+p[66]*plg[1][6]\
-      +p[103]*plg[1][1]+p[104]*plg[1][3]+p[105]*plg[1][5]\
-      +flags->swc[5]*(p[109]*plg[1][1]+p[110]*plg[1][3]+p[111]*plg[1][5])*cd14)* \
+			t[10] = (1.0 + p[80]*ws->dfa*flags->swc[1])* \
+     ((p[64]*ws->plg[1][2]+p[65]*ws->plg[1][4]+p[66]*ws->plg[1][6]\
+      +p[103]*ws->plg[1][1]+p[104]*ws->plg[1][3]+p[105]*ws->plg[1][5]\
+      +flags->swc[5]*(p[109]*ws->plg[1][1]+p[110]*ws->plg[1][3]+p[111]*ws->plg[1][5])*cd14)* \
           cos(dgtr*input->g_long) \
-      +(p[90]*plg[1][2]+p[91]*plg[1][4]+p[92]*plg[1][6]\
-      +p[106]*plg[1][1]+p[107]*plg[1][3]+p[108]*plg[1][5]\
-      +flags->swc[5]*(p[112]*plg[1][1]+p[113]*plg[1][3]+p[114]*plg[1][5])*cd14)* \
+      +(p[90]*ws->plg[1][2]+p[91]*ws->plg[1][4]+p[92]*ws->plg[1][6]\
+      +p[106]*ws->plg[1][1]+p[107]*ws->plg[1][3]+p[108]*ws->plg[1][5]\
+      +flags->swc[5]*(p[112]*ws->plg[1][1]+p[113]*ws->plg[1][3]+p[114]*ws->plg[1][5])*cd14)* \
       sin(dgtr*input->g_long));
 		}
 
 		/* ut and mixed ut, longitude */
 		if (flags->sw[12]){
-			t[11]=(1.0+p[95]*plg[0][1])*(1.0+p[81]*dfa*flags->swc[1])*\
-				(1.0+p[119]*plg[0][1]*flags->swc[5]*cd14)*\
-				((p[68]*plg[0][1]+p[69]*plg[0][3]+p[70]*plg[0][5])*\
+			t[11]=(1.0+p[95]*ws->plg[0][1])*(1.0+p[81]*ws->dfa*flags->swc[1])*\
+				(1.0+p[119]*ws->plg[0][1]*flags->swc[5]*cd14)*\
+				((p[68]*ws->plg[0][1]+p[69]*ws->plg[0][3]+p[70]*ws->plg[0][5])*\
 				cos(sr*(input->sec-p[71])));
 			t[11]+=flags->swc[11]*\
-				(p[76]*plg[2][3]+p[77]*plg[2][5]+p[78]*plg[2][7])*\
-				cos(sr*(input->sec-p[79])+2.0*dgtr*input->g_long)*(1.0+p[137]*dfa*flags->swc[1]);
+				(p[76]*ws->plg[2][3]+p[77]*ws->plg[2][5]+p[78]*ws->plg[2][7])*\
+				cos(sr*(input->sec-p[79])+2.0*dgtr*input->g_long)*(1.0+p[137]*ws->dfa*flags->swc[1]);
 		}
 
 		/* ut, longitude magnetic activity */
 		if (flags->sw[13]) {
 			if (flags->sw[9]==-1) {
 				if (p[51]) {
-					t[12]=apt[0]*flags->swc[11]*(1.+p[132]*plg[0][1])*\
-						((p[52]*plg[1][2]+p[98]*plg[1][4]+p[67]*plg[1][6])*\
+					t[12]=ws->apt[0]*flags->swc[11]*(1.+p[132]*ws->plg[0][1])*\
+						((p[52]*ws->plg[1][2]+p[98]*ws->plg[1][4]+p[67]*ws->plg[1][6])*\
 						 cos(dgtr*(input->g_long-p[97])))\
-						+apt[0]*flags->swc[11]*flags->swc[5]*\
-						(p[133]*plg[1][1]+p[134]*plg[1][3]+p[135]*plg[1][5])*\
+						+ws->apt[0]*flags->swc[11]*flags->swc[5]*\
+						(p[133]*ws->plg[1][1]+p[134]*ws->plg[1][3]+p[135]*ws->plg[1][5])*\
 						cd14*cos(dgtr*(input->g_long-p[136])) \
-						+apt[0]*flags->swc[12]* \
-						(p[55]*plg[0][1]+p[56]*plg[0][3]+p[57]*plg[0][5])*\
+						+ws->apt[0]*flags->swc[12]* \
+						(p[55]*ws->plg[0][1]+p[56]*ws->plg[0][3]+p[57]*ws->plg[0][5])*\
 						cos(sr*(input->sec-p[58]));
 				}
 			} else {
-				t[12] = apdf*flags->swc[11]*(1.0+p[120]*plg[0][1])*\
-					((p[60]*plg[1][2]+p[61]*plg[1][4]+p[62]*plg[1][6])*\
+				t[12] = ws->apdf*flags->swc[11]*(1.0+p[120]*ws->plg[0][1])*\
+					((p[60]*ws->plg[1][2]+p[61]*ws->plg[1][4]+p[62]*ws->plg[1][6])*\
 					cos(dgtr*(input->g_long-p[63])))\
-					+apdf*flags->swc[11]*flags->swc[5]* \
-					(p[115]*plg[1][1]+p[116]*plg[1][3]+p[117]*plg[1][5])* \
+					+ws->apdf*flags->swc[11]*flags->swc[5]* \
+					(p[115]*ws->plg[1][1]+p[116]*ws->plg[1][3]+p[117]*ws->plg[1][5])* \
 					cd14*cos(dgtr*(input->g_long-p[118])) \
-					+ apdf*flags->swc[12]* \
-					(p[83]*plg[0][1]+p[84]*plg[0][3]+p[85]*plg[0][5])* \
+					+ ws->apdf*flags->swc[12]* \
+					(p[83]*ws->plg[0][1]+p[84]*ws->plg[0][3]+p[85]*ws->plg[0][5])* \
 					cos(sr*(input->sec-p[75]));
 			}			
 		}
@@ -817,7 +791,7 @@ double globe7(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *fl
 /* ------------------------------- GLOB7S ---------------------------- */
 /* ------------------------------------------------------------------- */
 
-double glob7s(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *flags) {
+double glob7s(struct nrlmsise_workspace *ws, double *p, struct nrlmsise_input *input, struct nrlmsise_flags *flags) {
 /*    VERSION OF GLOBE FOR LOWER ATMOSPHERE 10/26/99 
  */
 	double pset=2.0;
@@ -842,63 +816,63 @@ double glob7s(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *fl
 	cd39 = cos(2.0*dr*(input->doy-p[38]));
 
 	/* F10.7 */
-	t[0] = p[21]*dfa;
+	t[0] = p[21]*ws->dfa;
 
 	/* time independent */
-	t[1]=p[1]*plg[0][2] + p[2]*plg[0][4] + p[22]*plg[0][6] + p[26]*plg[0][1] + p[14]*plg[0][3] + p[59]*plg[0][5];
+	t[1]=p[1]*ws->plg[0][2] + p[2]*ws->plg[0][4] + p[22]*ws->plg[0][6] + p[26]*ws->plg[0][1] + p[14]*ws->plg[0][3] + p[59]*ws->plg[0][5];
 
         /* SYMMETRICAL ANNUAL */
-	t[2]=(p[18]+p[47]*plg[0][2]+p[29]*plg[0][4])*cd32;
+	t[2]=(p[18]+p[47]*ws->plg[0][2]+p[29]*ws->plg[0][4])*cd32;
 
         /* SYMMETRICAL SEMIANNUAL */
-	t[3]=(p[15]+p[16]*plg[0][2]+p[30]*plg[0][4])*cd18;
+	t[3]=(p[15]+p[16]*ws->plg[0][2]+p[30]*ws->plg[0][4])*cd18;
 
         /* ASYMMETRICAL ANNUAL */
-	t[4]=(p[9]*plg[0][1]+p[10]*plg[0][3]+p[20]*plg[0][5])*cd14;
+	t[4]=(p[9]*ws->plg[0][1]+p[10]*ws->plg[0][3]+p[20]*ws->plg[0][5])*cd14;
 
 	/* ASYMMETRICAL SEMIANNUAL */
-	t[5]=(p[37]*plg[0][1])*cd39;
+	t[5]=(p[37]*ws->plg[0][1])*cd39;
 
         /* DIURNAL */
 	if (flags->sw[7]) {
 		double t71, t72;
-		t71 = p[11]*plg[1][2]*cd14*flags->swc[5];
-		t72 = p[12]*plg[1][2]*cd14*flags->swc[5];
-		t[6] = ((p[3]*plg[1][1] + p[4]*plg[1][3] + t71) * ctloc + (p[6]*plg[1][1] + p[7]*plg[1][3] + t72) * stloc) ;
+		t71 = p[11]*ws->plg[1][2]*cd14*flags->swc[5];
+		t72 = p[12]*ws->plg[1][2]*cd14*flags->swc[5];
+		t[6] = ((p[3]*ws->plg[1][1] + p[4]*ws->plg[1][3] + t71) * ws->ctloc + (p[6]*ws->plg[1][1] + p[7]*ws->plg[1][3] + t72) * ws->stloc) ;
 	}
 
 	/* SEMIDIURNAL */
 	if (flags->sw[8]) {
 		double t81, t82;
-		t81 = (p[23]*plg[2][3]+p[35]*plg[2][5])*cd14*flags->swc[5];
-		t82 = (p[33]*plg[2][3]+p[36]*plg[2][5])*cd14*flags->swc[5];
-		t[7] = ((p[5]*plg[2][2] + p[41]*plg[2][4] + t81) * c2tloc + (p[8]*plg[2][2] + p[42]*plg[2][4] + t82) * s2tloc);
+		t81 = (p[23]*ws->plg[2][3]+p[35]*ws->plg[2][5])*cd14*flags->swc[5];
+		t82 = (p[33]*ws->plg[2][3]+p[36]*ws->plg[2][5])*cd14*flags->swc[5];
+		t[7] = ((p[5]*ws->plg[2][2] + p[41]*ws->plg[2][4] + t81) * ws->c2tloc + (p[8]*ws->plg[2][2] + p[42]*ws->plg[2][4] + t82) * ws->s2tloc);
 	}
 
 	/* TERDIURNAL */
 	if (flags->sw[14]) {
-		t[13] = p[39] * plg[3][3] * s3tloc + p[40] * plg[3][3] * c3tloc;
+		t[13] = p[39] * ws->plg[3][3] * ws->s3tloc + p[40] * ws->plg[3][3] * ws->c3tloc;
 	}
 
 	/* MAGNETIC ACTIVITY */
 	if (flags->sw[9]) {
 		if (flags->sw[9]==1)
-			t[8] = apdf * (p[32] + p[45] * plg[0][2] * flags->swc[2]);
+			t[8] = ws->apdf * (p[32] + p[45] * ws->plg[0][2] * flags->swc[2]);
 		if (flags->sw[9]==-1)	
-			t[8]=(p[50]*apt[0] + p[96]*plg[0][2] * apt[0]*flags->swc[2]);
+			t[8]=(p[50]*ws->apt[0] + p[96]*ws->plg[0][2] * ws->apt[0]*flags->swc[2]);
 	}
 
 	/* LONGITUDINAL */
 	if (!((flags->sw[10]==0) || (flags->sw[11]==0) || (input->g_long<=-1000.0))) {
-		t[10] = (1.0 + plg[0][1]*(p[80]*flags->swc[5]*cos(dr*(input->doy-p[81]))\
+		t[10] = (1.0 + ws->plg[0][1]*(p[80]*flags->swc[5]*cos(dr*(input->doy-p[81]))\
 		        +p[85]*flags->swc[6]*cos(2.0*dr*(input->doy-p[86])))\
 			+p[83]*flags->swc[3]*cos(dr*(input->doy-p[84]))\
 			+p[87]*flags->swc[4]*cos(2.0*dr*(input->doy-p[88])))\
-			*((p[64]*plg[1][2]+p[65]*plg[1][4]+p[66]*plg[1][6]\
-			+p[74]*plg[1][1]+p[75]*plg[1][3]+p[76]*plg[1][5]\
+			*((p[64]*ws->plg[1][2]+p[65]*ws->plg[1][4]+p[66]*ws->plg[1][6]\
+			+p[74]*ws->plg[1][1]+p[75]*ws->plg[1][3]+p[76]*ws->plg[1][5]\
 			)*cos(dgtr*input->g_long)\
-			+(p[90]*plg[1][2]+p[91]*plg[1][4]+p[92]*plg[1][6]\
-			+p[77]*plg[1][1]+p[78]*plg[1][3]+p[79]*plg[1][5]\
+			+(p[90]*ws->plg[1][2]+p[91]*ws->plg[1][4]+p[92]*ws->plg[1][6]\
+			+p[77]*ws->plg[1][1]+p[78]*ws->plg[1][3]+p[79]*ws->plg[1][5]\
 			)*sin(dgtr*input->g_long));
 	}
 	tt=0;
@@ -913,7 +887,7 @@ double glob7s(double *p, struct nrlmsise_input *input, struct nrlmsise_flags *fl
 /* ------------------------------- GTD7 ------------------------------ */
 /* ------------------------------------------------------------------- */
 
-void gtd7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
+void gtd7_r(struct nrlmsise_workspace *ws, struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
 	double xlat;
 	double xmm;
 	int mn3 = 5;
@@ -937,7 +911,7 @@ void gtd7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 	xlat=input->g_lat;
 	if (flags->sw[2]==0)
 		xlat=45.0;
-	glatf(xlat, &gsurf, &re);
+	glatf(xlat, &ws->gsurf, &ws->re);
 
 	xmm = pdm[2][4];
 
@@ -949,13 +923,13 @@ void gtd7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 
 	tmp=input->alt;
 	input->alt=altt;
-	gts7(input, flags, &soutput);
+	gts7_r(ws, input, flags, &soutput);
 	altt=input->alt;
 	input->alt=tmp;
 	if (flags->sw[0])   /* metric adjustment */
-		dm28m=dm28*1.0E6;
+		dm28m=ws->dm28*1.0E6;
 	else
-		dm28m=dm28;
+		dm28m=ws->dm28;
 	output->t[0]=soutput.t[0];
 	output->t[1]=soutput.t[1];
 	if (input->alt>=zn2[0]) {
@@ -968,25 +942,25 @@ void gtd7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
  *         Temperature at nodes and gradients at end nodes
  *         Inverse temperature a linear function of spherical harmonics
  */
-	meso_tgn2[0]=meso_tgn1[1];
-	meso_tn2[0]=meso_tn1[4];
-        meso_tn2[1]=pma[0][0]*pavgm[0]/(1.0-flags->sw[20]*glob7s(pma[0], input, flags));
-        meso_tn2[2]=pma[1][0]*pavgm[1]/(1.0-flags->sw[20]*glob7s(pma[1], input, flags));
-        meso_tn2[3]=pma[2][0]*pavgm[2]/(1.0-flags->sw[20]*flags->sw[22]*glob7s(pma[2], input, flags));
-	meso_tgn2[1]=pavgm[8]*pma[9][0]*(1.0+flags->sw[20]*flags->sw[22]*glob7s(pma[9], input, flags))*meso_tn2[3]*meso_tn2[3]/(pow((pma[2][0]*pavgm[2]),2.0));
-	meso_tn3[0]=meso_tn2[3];
+	ws->meso_tgn2[0]=ws->meso_tgn1[1];
+	ws->meso_tn2[0]=ws->meso_tn1[4];
+        ws->meso_tn2[1]=pma[0][0]*pavgm[0]/(1.0-flags->sw[20]*glob7s(ws, pma[0], input, flags));
+        ws->meso_tn2[2]=pma[1][0]*pavgm[1]/(1.0-flags->sw[20]*glob7s(ws, pma[1], input, flags));
+        ws->meso_tn2[3]=pma[2][0]*pavgm[2]/(1.0-flags->sw[20]*flags->sw[22]*glob7s(ws, pma[2], input, flags));
+	ws->meso_tgn2[1]=pavgm[8]*pma[9][0]*(1.0+flags->sw[20]*flags->sw[22]*glob7s(ws, pma[9], input, flags))*ws->meso_tn2[3]*ws->meso_tn2[3]/(pow((pma[2][0]*pavgm[2]),2.0));
+	ws->meso_tn3[0]=ws->meso_tn2[3];
 
 	if (input->alt<=zn3[0]) {
 /*       LOWER STRATOSPHERE AND TROPOSPHERE (below zn3[0])
  *         Temperature at nodes and gradients at end nodes
  *         Inverse temperature a linear function of spherical harmonics
  */
-		meso_tgn3[0]=meso_tgn2[1];
-		meso_tn3[1]=pma[3][0]*pavgm[3]/(1.0-flags->sw[22]*glob7s(pma[3], input, flags));
-		meso_tn3[2]=pma[4][0]*pavgm[4]/(1.0-flags->sw[22]*glob7s(pma[4], input, flags));
-		meso_tn3[3]=pma[5][0]*pavgm[5]/(1.0-flags->sw[22]*glob7s(pma[5], input, flags));
-		meso_tn3[4]=pma[6][0]*pavgm[6]/(1.0-flags->sw[22]*glob7s(pma[6], input, flags));
-		meso_tgn3[1]=pma[7][0]*pavgm[7]*(1.0+flags->sw[22]*glob7s(pma[7], input, flags)) *meso_tn3[4]*meso_tn3[4]/(pow((pma[6][0]*pavgm[6]),2.0));
+		ws->meso_tgn3[0]=ws->meso_tgn2[1];
+		ws->meso_tn3[1]=pma[3][0]*pavgm[3]/(1.0-flags->sw[22]*glob7s(ws, pma[3], input, flags));
+		ws->meso_tn3[2]=pma[4][0]*pavgm[4]/(1.0-flags->sw[22]*glob7s(ws, pma[4], input, flags));
+		ws->meso_tn3[3]=pma[5][0]*pavgm[5]/(1.0-flags->sw[22]*glob7s(ws, pma[5], input, flags));
+		ws->meso_tn3[4]=pma[6][0]*pavgm[6]/(1.0-flags->sw[22]*glob7s(ws, pma[6], input, flags));
+		ws->meso_tgn3[1]=pma[7][0]*pavgm[7]*(1.0+flags->sw[22]*glob7s(ws, pma[7], input, flags)) *ws->meso_tn3[4]*ws->meso_tn3[4]/(pow((pma[6][0]*pavgm[6]),2.0));
 	}
 
         /* LINEAR TRANSITION TO FULL MIXING BELOW zn2[0] */
@@ -998,7 +972,7 @@ void gtd7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 	
 	/**** N2 density ****/
 	dmr=soutput.d[2] / dm28m - 1.0;
-	output->d[2]=densm(input->alt,dm28m,xmm, &tz, mn3, zn3, meso_tn3, meso_tgn3, mn2, zn2, meso_tn2, meso_tgn2);
+	output->d[2]=densm(ws, input->alt,dm28m,xmm, &tz, mn3, zn3, ws->meso_tn3, ws->meso_tgn3, mn2, zn2, ws->meso_tn2, ws->meso_tgn2);
 	output->d[2]=output->d[2] * (1.0 + dmr*dmc);
 
 	/**** HE density ****/
@@ -1030,7 +1004,7 @@ void gtd7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 		output->d[5]=output->d[5]/1000;
 
 	/**** temperature at altitude ****/
-	dd = densm(input->alt, 1.0, 0, &tz, mn3, zn3, meso_tn3, meso_tgn3, mn2, zn2, meso_tn2, meso_tgn2);
+	ws->dd = densm(ws, input->alt, 1.0, 0, &tz, mn3, zn3, ws->meso_tn3, ws->meso_tgn3, mn2, zn2, ws->meso_tn2, ws->meso_tgn2);
 	output->t[1]=tz;
 
 }
@@ -1041,12 +1015,24 @@ void gtd7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 /* ------------------------------- GTD7D ----------------------------- */
 /* ------------------------------------------------------------------- */
 
-void gtd7d(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
-	gtd7(input, flags, output);
+void gtd7d_r(struct nrlmsise_workspace *ws, struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
+	gtd7_r(ws, input, flags, output);
 	output->d[5] = 1.66E-24 * (4.0 * output->d[0] + 16.0 * output->d[1] + 28.0 * output->d[2] + 32.0 * output->d[3] + 40.0 * output->d[4] + output->d[6] + 14.0 * output->d[7] + 16.0 * output->d[8]);
 	if (flags->sw[0])
 		output->d[5]=output->d[5]/1000;
 }
+
+
+
+/* ------------------------------------------------------------------- */
+/* ---------------------------- GTD7D_BATCH -------------------------- */
+/* ------------------------------------------------------------------- */
+
+void gtd7d_batch(struct nrlmsise_workspace *ws, int n, struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
+	int i;
+	for (i=0;i<n;i++)
+		gtd7d_r(ws, &input[i], flags, &output[i]);
+}
  
 
 
@@ -1054,7 +1040,7 @@ void gtd7d(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nr
 /* -------------------------------- GHP7 ----------------------------- */
 /* ------------------------------------------------------------------- */
 
-void ghp7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output, double press) {
+void ghp7_r(struct nrlmsise_workspace *ws, struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output, double press) {
 	double bm = 1.3806E-19;
 	double rgas = 831.4;
 	double test = 0.00043;
@@ -1103,7 +1089,7 @@ void ghp7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 	do {
 		l++;
 		input->alt = z;
-		gtd7(input, flags, output);
+		gtd7_r(ws, input, flags, output);
 		z = input->alt;
 		xn = output->d[0] + output->d[1] + output->d[2] + output->d[3] + output->d[4] + output->d[6] + output->d[7];
 		p = bm * xn * output->t[1];
@@ -1119,7 +1105,7 @@ void ghp7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 		xm = output->d[5] / xn / 1.66E-24;
 		if (flags->sw[0])
 			xm = xm * 1.0E3;
-		g = gsurf / (pow((1.0 + z/re),2.0));
+		g = ws->gsurf / (pow((1.0 + z/ws->re),2.0));
 		sh = rgas * output->t[1] / (xm * g);
 
 		/* new altitude estimate using scale height */
@@ -1136,7 +1122,7 @@ void ghp7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 /* ------------------------------- GTS7 ------------------------------ */
 /* ------------------------------------------------------------------- */
 
-void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
+void gts7_r(struct nrlmsise_workspace *ws, struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
 /*     Thermospheric portion of NRLMSISE-00
  *     See GTD7 for more extensive comments
  *     alt > 72.5 km! 
@@ -1179,7 +1165,7 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 	/* TINF VARIATIONS NOT IMPORTANT BELOW ZA OR ZN1(1) */
 	if (input->alt>zn1[0])
 		tinf = ptm[0]*pt[0] * \
-			(1.0+flags->sw[16]*globe7(pt,input,flags));
+			(1.0+flags->sw[16]*globe7(ws, pt,input,flags));
 	else
 		tinf = ptm[0]*pt[0];
 	output->t[0]=tinf;
@@ -1187,30 +1173,30 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 	/*  GRADIENT VARIATIONS NOT IMPORTANT BELOW ZN1(5) */
 	if (input->alt>zn1[4])
 		g0 = ptm[3]*ps[0] * \
-			(1.0+flags->sw[19]*globe7(ps,input,flags));
+			(1.0+flags->sw[19]*globe7(ws, ps,input,flags));
 	else
 		g0 = ptm[3]*ps[0];
-	tlb = ptm[1] * (1.0 + flags->sw[17]*globe7(pd[3],input,flags))*pd[3][0];
+	tlb = ptm[1] * (1.0 + flags->sw[17]*globe7(ws, pd[3],input,flags))*pd[3][0];
 	s = g0 / (tinf - tlb);
 
 /*      Lower thermosphere temp variations not significant for
  *       density above 300 km */
 	if (input->alt<300.0) {
-		meso_tn1[1]=ptm[6]*ptl[0][0]/(1.0-flags->sw[18]*glob7s(ptl[0], input, flags));
-		meso_tn1[2]=ptm[2]*ptl[1][0]/(1.0-flags->sw[18]*glob7s(ptl[1], input, flags));
-		meso_tn1[3]=ptm[7]*ptl[2][0]/(1.0-flags->sw[18]*glob7s(ptl[2], input, flags));
-		meso_tn1[4]=ptm[4]*ptl[3][0]/(1.0-flags->sw[18]*flags->sw[20]*glob7s(ptl[3], input, flags));
-		meso_tgn1[1]=ptm[8]*pma[8][0]*(1.0+flags->sw[18]*flags->sw[20]*glob7s(pma[8], input, flags))*meso_tn1[4]*meso_tn1[4]/(pow((ptm[4]*ptl[3][0]),2.0));
+		ws->meso_tn1[1]=ptm[6]*ptl[0][0]/(1.0-flags->sw[18]*glob7s(ws, ptl[0], input, flags));
+		ws->meso_tn1[2]=ptm[2]*ptl[1][0]/(1.0-flags->sw[18]*glob7s(ws, ptl[1], input, flags));
+		ws->meso_tn1[3]=ptm[7]*ptl[2][0]/(1.0-flags->sw[18]*glob7s(ws, ptl[2], input, flags));
+		ws->meso_tn1[4]=ptm[4]*ptl[3][0]/(1.0-flags->sw[18]*flags->sw[20]*glob7s(ws, ptl[3], input, flags));
+		ws->meso_tgn1[1]=ptm[8]*pma[8][0]*(1.0+flags->sw[18]*flags->sw[20]*glob7s(ws, pma[8], input, flags))*ws->meso_tn1[4]*ws->meso_tn1[4]/(pow((ptm[4]*ptl[3][0]),2.0));
 	} else {
-		meso_tn1[1]=ptm[6]*ptl[0][0];
-		meso_tn1[2]=ptm[2]*ptl[1][0];
-		meso_tn1[3]=ptm[7]*ptl[2][0];
-		meso_tn1[4]=ptm[4]*ptl[3][0];
-		meso_tgn1[1]=ptm[8]*pma[8][0]*meso_tn1[4]*meso_tn1[4]/(pow((ptm[4]*ptl[3][0]),2.0));
+		ws->meso_tn1[1]=ptm[6]*ptl[0][0];
+		ws->meso_tn1[2]=ptm[2]*ptl[1][0];
+		ws->meso_tn1[3]=ptm[7]*ptl[2][0];
+		ws->meso_tn1[4]=ptm[4]*ptl[3][0];
+		ws->meso_tgn1[1]=ptm[8]*pma[8][0]*ws->meso_tn1[4]*ws->meso_tn1[4]/(pow((ptm[4]*ptl[3][0]),2.0));
 	}
 
 	/* N2 variation factor at Zlb */
-	g28=flags->sw[21]*globe7(pd[2], input, flags);
+	g28=flags->sw[21]*globe7(ws, pd[2], input, flags);
 
 	/* VARIATION OF TURBOPAUSE HEIGHT */
 	zhf=pdl[1][24]*(1.0+flags->sw[5]*pdl[0][24]*sin(dgtr*input->g_lat)*cos(dr*(input->doy-pt[13])));
@@ -1224,41 +1210,41 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 	/* Diffusive density at Zlb */
 	db28 = pdm[2][0]*exp(g28)*pd[2][0];
 	/* Diffusive density at Alt */
-	output->d[2]=densu(z,db28,tinf,tlb,28.0,alpha[2],&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+	output->d[2]=densu(ws, z,db28,tinf,tlb,28.0,alpha[2],&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 	dd=output->d[2];
 	/* Turbopause */
 	zh28=pdm[2][2]*zhf;
 	zhm28=pdm[2][3]*pdl[1][5]; 
 	xmd=28.0-xmm;
 	/* Mixed density at Zlb */
-	b28=densu(zh28,db28,tinf,tlb,xmd,(alpha[2]-1.0),&tz,ptm[5],s,mn1, zn1,meso_tn1,meso_tgn1);
+	b28=densu(ws, zh28,db28,tinf,tlb,xmd,(alpha[2]-1.0),&tz,ptm[5],s,mn1, zn1,ws->meso_tn1,ws->meso_tgn1);
 	if ((flags->sw[15])&&(z<=altl[2])) {
 		/*  Mixed density at Alt */
-		dm28=densu(z,b28,tinf,tlb,xmm,alpha[2],&tz,ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		ws->dm28=densu(ws, z,b28,tinf,tlb,xmm,alpha[2],&tz,ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		/*  Net density at Alt */
-		output->d[2]=dnet(output->d[2],dm28,zhm28,xmm,28.0);
+		output->d[2]=dnet(output->d[2],ws->dm28,zhm28,xmm,28.0);
 	}
 
 
         /**** HE DENSITY ****/
 
 	/*   Density variation factor at Zlb */
-	g4 = flags->sw[21]*globe7(pd[0], input, flags);
+	g4 = flags->sw[21]*globe7(ws, pd[0], input, flags);
 	/*  Diffusive density at Zlb */
 	db04 = pdm[0][0]*exp(g4)*pd[0][0];
         /*  Diffusive density at Alt */
-	output->d[0]=densu(z,db04,tinf,tlb, 4.,alpha[0],&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+	output->d[0]=densu(ws, z,db04,tinf,tlb, 4.,alpha[0],&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 	dd=output->d[0];
 	if ((flags->sw[15]) && (z<altl[0])) {
 		/*  Turbopause */
 		zh04=pdm[0][2];
 		/*  Mixed density at Zlb */
-		b04=densu(zh04,db04,tinf,tlb,4.-xmm,alpha[0]-1.,&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		b04=densu(ws, zh04,db04,tinf,tlb,4.-xmm,alpha[0]-1.,&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		/*  Mixed density at Alt */
-		dm04=densu(z,b04,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		ws->dm04=densu(ws, z,b04,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		zhm04=zhm28;
 		/*  Net density at Alt */
-		output->d[0]=dnet(output->d[0],dm04,zhm04,xmm,4.);
+		output->d[0]=dnet(output->d[0],ws->dm04,zhm04,xmm,4.);
 		/*  Correction to specified mixing ratio at ground */
 		rl=log(b28*pdm[0][1]/b04);
 		zc04=pdm[0][4]*pdl[1][0];
@@ -1271,22 +1257,22 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
         /**** O DENSITY ****/
 
 	/*  Density variation factor at Zlb */
-	g16= flags->sw[21]*globe7(pd[1],input,flags);
+	g16= flags->sw[21]*globe7(ws, pd[1],input,flags);
 	/*  Diffusive density at Zlb */
 	db16 =  pdm[1][0]*exp(g16)*pd[1][0];
         /*   Diffusive density at Alt */
-	output->d[1]=densu(z,db16,tinf,tlb, 16.,alpha[1],&output->t[1],ptm[5],s,mn1, zn1,meso_tn1,meso_tgn1);
+	output->d[1]=densu(ws, z,db16,tinf,tlb, 16.,alpha[1],&output->t[1],ptm[5],s,mn1, zn1,ws->meso_tn1,ws->meso_tgn1);
 	dd=output->d[1];
 	if ((flags->sw[15]) && (z<=altl[1])) {
 		/*   Turbopause */
 		zh16=pdm[1][2];
 		/*  Mixed density at Zlb */
-		b16=densu(zh16,db16,tinf,tlb,16.0-xmm,(alpha[1]-1.0), &output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		b16=densu(ws, zh16,db16,tinf,tlb,16.0-xmm,(alpha[1]-1.0), &output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		/*  Mixed density at Alt */
-		dm16=densu(z,b16,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		ws->dm16=densu(ws, z,b16,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		zhm16=zhm28;
 		/*  Net density at Alt */
-		output->d[1]=dnet(output->d[1],dm16,zhm16,xmm,16.);
+		output->d[1]=dnet(output->d[1],ws->dm16,zhm16,xmm,16.);
 		rl=pdm[1][1]*pdl[1][16]*(1.0+flags->sw[1]*pdl[0][23]*(input->f107A-150.0));
 		hc16=pdm[1][5]*pdl[1][3];
 		zc16=pdm[1][4]*pdl[1][2];
@@ -1304,23 +1290,23 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
         /**** O2 DENSITY ****/
 
         /*   Density variation factor at Zlb */
-	g32= flags->sw[21]*globe7(pd[4], input, flags);
+	g32= flags->sw[21]*globe7(ws, pd[4], input, flags);
         /*  Diffusive density at Zlb */
 	db32 = pdm[3][0]*exp(g32)*pd[4][0];
         /*   Diffusive density at Alt */
-	output->d[3]=densu(z,db32,tinf,tlb, 32.,alpha[3],&output->t[1],ptm[5],s,mn1, zn1,meso_tn1,meso_tgn1);
+	output->d[3]=densu(ws, z,db32,tinf,tlb, 32.,alpha[3],&output->t[1],ptm[5],s,mn1, zn1,ws->meso_tn1,ws->meso_tgn1);
 	dd=output->d[3];
 	if (flags->sw[15]) {
 		if (z<=altl[3]) {
 			/*   Turbopause */
 			zh32=pdm[3][2];
 			/*  Mixed density at Zlb */
-			b32=densu(zh32,db32,tinf,tlb,32.-xmm,alpha[3]-1., &output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+			b32=densu(ws, zh32,db32,tinf,tlb,32.-xmm,alpha[3]-1., &output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 			/*  Mixed density at Alt */
-			dm32=densu(z,b32,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+			ws->dm32=densu(ws, z,b32,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 			zhm32=zhm28;
 			/*  Net density at Alt */
-			output->d[3]=dnet(output->d[3],dm32,zhm32,xmm,32.);
+			output->d[3]=dnet(output->d[3],ws->dm32,zhm32,xmm,32.);
 			/*   Correction to specified mixing ratio at ground */
 			rl=log(b28*pdm[3][1]/b32);
 			hc32=pdm[3][5]*pdl[1][7];
@@ -1340,22 +1326,22 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
         /**** AR DENSITY ****/
 
         /*   Density variation factor at Zlb */
-	g40= flags->sw[21]*globe7(pd[5],input,flags);
+	g40= flags->sw[21]*globe7(ws, pd[5],input,flags);
         /*  Diffusive density at Zlb */
 	db40 = pdm[4][0]*exp(g40)*pd[5][0];
 	/*   Diffusive density at Alt */
-	output->d[4]=densu(z,db40,tinf,tlb, 40.,alpha[4],&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+	output->d[4]=densu(ws, z,db40,tinf,tlb, 40.,alpha[4],&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 	dd=output->d[4];
 	if ((flags->sw[15]) && (z<=altl[4])) {
 		/*   Turbopause */
 		zh40=pdm[4][2];
 		/*  Mixed density at Zlb */
-		b40=densu(zh40,db40,tinf,tlb,40.-xmm,alpha[4]-1.,&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		b40=densu(ws, zh40,db40,tinf,tlb,40.-xmm,alpha[4]-1.,&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		/*  Mixed density at Alt */
-		dm40=densu(z,b40,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		ws->dm40=densu(ws, z,b40,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		zhm40=zhm28;
 		/*  Net density at Alt */
-		output->d[4]=dnet(output->d[4],dm40,zhm40,xmm,40.);
+		output->d[4]=dnet(output->d[4],ws->dm40,zhm40,xmm,40.);
 		/*   Correction to specified mixing ratio at ground */
 		rl=log(b28*pdm[4][1]/b40);
 		hc40=pdm[4][5]*pdl[1][9];
@@ -1368,22 +1354,22 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
         /**** HYDROGEN DENSITY ****/
 
         /*   Density variation factor at Zlb */
-	g1 = flags->sw[21]*globe7(pd[6], input, flags);
+	g1 = flags->sw[21]*globe7(ws, pd[6], input, flags);
         /*  Diffusive density at Zlb */
 	db01 = pdm[5][0]*exp(g1)*pd[6][0];
         /*   Diffusive density at Alt */
-	output->d[6]=densu(z,db01,tinf,tlb,1.,alpha[6],&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+	output->d[6]=densu(ws, z,db01,tinf,tlb,1.,alpha[6],&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 	dd=output->d[6];
 	if ((flags->sw[15]) && (z<=altl[6])) {
 		/*   Turbopause */
 		zh01=pdm[5][2];
 		/*  Mixed density at Zlb */
-		b01=densu(zh01,db01,tinf,tlb,1.-xmm,alpha[6]-1., &output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		b01=densu(ws, zh01,db01,tinf,tlb,1.-xmm,alpha[6]-1., &output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		/*  Mixed density at Alt */
-		dm01=densu(z,b01,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		ws->dm01=densu(ws, z,b01,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		zhm01=zhm28;
 		/*  Net density at Alt */
-		output->d[6]=dnet(output->d[6],dm01,zhm01,xmm,1.);
+		output->d[6]=dnet(output->d[6],ws->dm01,zhm01,xmm,1.);
 		/*   Correction to specified mixing ratio at ground */
 		rl=log(b28*pdm[5][1]*sqrt(pdl[1][17]*pdl[1][17])/b01);
 		hc01=pdm[5][5]*pdl[1][11];
@@ -1401,22 +1387,22 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
         /**** ATOMIC NITROGEN DENSITY ****/
 
 	/*   Density variation factor at Zlb */
-	g14 = flags->sw[21]*globe7(pd[7],input,flags);
+	g14 = flags->sw[21]*globe7(ws, pd[7],input,flags);
         /*  Diffusive density at Zlb */
 	db14 = pdm[6][0]*exp(g14)*pd[7][0];
         /*   Diffusive density at Alt */
-	output->d[7]=densu(z,db14,tinf,tlb,14.,alpha[7],&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+	output->d[7]=densu(ws, z,db14,tinf,tlb,14.,alpha[7],&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 	dd=output->d[7];
 	if ((flags->sw[15]) && (z<=altl[7])) {
 		/*   Turbopause */
 		zh14=pdm[6][2];
 		/*  Mixed density at Zlb */
-		b14=densu(zh14,db14,tinf,tlb,14.-xmm,alpha[7]-1., &output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		b14=densu(ws, zh14,db14,tinf,tlb,14.-xmm,alpha[7]-1., &output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		/*  Mixed density at Alt */
-		dm14=densu(z,b14,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,meso_tn1,meso_tgn1);
+		ws->dm14=densu(ws, z,b14,tinf,tlb,xmm,0.,&output->t[1],ptm[5],s,mn1,zn1,ws->meso_tn1,ws->meso_tgn1);
 		zhm14=zhm28;
 		/*  Net density at Alt */
-		output->d[7]=dnet(output->d[7],dm14,zhm14,xmm,14.);
+		output->d[7]=dnet(output->d[7],ws->dm14,zhm14,xmm,14.);
 		/*   Correction to specified mixing ratio at ground */
 		rl=log(b28*pdm[6][1]*sqrt(pdl[0][2]*pdl[0][2])/b14);
 		hc14=pdm[6][5]*pdl[0][1];
@@ -1433,13 +1419,13 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 
         /**** Anomalous OXYGEN DENSITY ****/
 
-	g16h = flags->sw[21]*globe7(pd[8],input,flags);
+	g16h = flags->sw[21]*globe7(ws, pd[8],input,flags);
 	db16h = pdm[7][0]*exp(g16h)*pd[8][0];
 	tho = pdm[7][9]*pdl[0][6];
-	dd=densu(z,db16h,tho,tho,16.,alpha[8],&output->t[1],ptm[5],s,mn1, zn1,meso_tn1,meso_tgn1);
+	dd=densu(ws, z,db16h,tho,tho,16.,alpha[8],&output->t[1],ptm[5],s,mn1, zn1,ws->meso_tn1,ws->meso_tgn1);
 	zsht=pdm[7][5];
 	zmho=pdm[7][4];
-	zsho=scalh(zmho,16.0,tho);
+	zsho=scalh(ws, zmho,16.0,tho);
 	output->d[8]=dd*exp(-zsht/zsho*(exp(-(z-zmho)/zsht)-1.));
 
 
@@ -1449,7 +1435,7 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 
 	/* temperature */
 	z = sqrt(input->alt*input->alt);
-	ddum = densu(z,1.0, tinf, tlb, 0.0, 0.0, &output->t[1], ptm[5], s, mn1, zn1, meso_tn1, meso_tgn1);
+	ddum = densu(ws, z,1.0, tinf, tlb, 0.0, 0.0, &output->t[1], ptm[5], s, mn1, zn1, ws->meso_tn1, ws->meso_tgn1);
 	(void) ddum; /* silence gcc */
 	if (flags->sw[0]) {
 		for(i=0;i<9;i++)
@@ -1457,3 +1443,28 @@ void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrl
 		output->d[5]=output->d[5]/1000;
 	}
 }
+
+
+
+/* ------------------------------------------------------------------- */
+/* ------------------------- LEGACY INTERFACE ------------------------ */
+/* ------------------------------------------------------------------- */
+
+/* one workspace per thread for the routines without explicit workspace */
+static thread_local struct nrlmsise_workspace nrlmsise_tls;
+
+void gtd7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
+	gtd7_r(&nrlmsise_tls, input, flags, output);
+}
+
+void gtd7d(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
+	gtd7d_r(&nrlmsise_tls, input, flags, output);
+}
+
+void gts7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output) {
+	gts7_r(&nrlmsise_tls, input, flags, output);
+}
+
+void ghp7(struct nrlmsise_input *input, struct nrlmsise_flags *flags, struct nrlmsise_output *output, double press) {
+	ghp7_r(&nrlmsise_tls, input, flags, output, press);
+}
@@ -18,6 +18,11 @@
 
 
 
+#ifndef NRLMSISE_00_H
+#define NRLMSISE_00_H
+
+
+
 /* ------------------------------------------------------------------- */
 /* ------------------------------- INPUT ----------------------------- */
 /* ------------------------------------------------------------------- */
@@ -162,6 +167,48 @@ struct nrlmsise_output {
 
 
 
+/* ------------------------------------------------------------------- */
+/* ---------------------------- WORKSPACE ---------------------------- */
+/* ------------------------------------------------------------------- */
+
+struct nrlmsise_workspace {
+	/* PARMB */
+	double gsurf;
+	double re;
+
+	/* GTS3C */
+	double dd;
+
+	/* DMIX */
+	double dm04, dm16, dm28, dm32, dm40, dm01, dm14;
+
+	/* MESO7 */
+	double meso_tn1[5];
+	double meso_tn2[4];
+	double meso_tn3[5];
+	double meso_tgn1[2];
+	double meso_tgn2[2];
+	double meso_tgn3[2];
+
+	/* LPOLY */
+	double dfa;
+	double plg[4][9];
+	double ctloc, stloc;
+	double c2tloc, s2tloc;
+	double s3tloc, c3tloc;
+	double apdf, apt[4];
+};
+/*
+ *   Intermediate results that the FORTRAN code keeps in COMMON blocks
+ *   (PARMB, GTS3C, DMIX, MESO7, LPOLY). The reentrant routines (suffix
+ *   _r) take the workspace as first argument, so independent calls may
+ *   run concurrently as long as each thread uses its own workspace. A
+ *   workspace needs no initialisation and must not be shared by
+ *   concurrent calls.
+ */
+
+
+
 /* ------------------------------------------------------------------- */
 /* --------------------------- PROTOTYPES ---------------------------- */
 /* ------------------------------------------------------------------- */
@@ -204,6 +251,45 @@ void ghp7 (struct nrlmsise_input *input, \
            double press);
 
 
+/* Reentrant versions */
+/*   Same as above with an explicit workspace. The routines without the
+ *   suffix _r use a workspace private to the calling thread.
+ */
+void gtd7_r (struct nrlmsise_workspace *ws, \
+             struct nrlmsise_input *input, \
+             struct nrlmsise_flags *flags, \
+             struct nrlmsise_output *output);
+
+void gtd7d_r(struct nrlmsise_workspace *ws, \
+             struct nrlmsise_input *input, \
+             struct nrlmsise_flags *flags, \
+             struct nrlmsise_output *output);
+
+void gts7_r (struct nrlmsise_workspace *ws, \
+             struct nrlmsise_input *input, \
+             struct nrlmsise_flags *flags, \
+             struct nrlmsise_output *output);
+
+void ghp7_r (struct nrlmsise_workspace *ws, \
+             struct nrlmsise_input *input, \
+             struct nrlmsise_flags *flags, \
+             struct nrlmsise_output *output, \
+             double press);
+
+
+/* GTD7D_BATCH */
+/*   Evaluates gtd7d for n points input[0..n-1] with common flags,
+ *   writing output[0..n-1]. The points are processed in sequence with
+ *   the same workspace, so a batch of nearby points (e.g. the members
+ *   of a formation at one epoch) touches the coefficient tables only
+ *   once per point while they stay in cache.
+ */
+void gtd7d_batch(struct nrlmsise_workspace *ws, int n, \
+                 struct nrlmsise_input *input, \
+                 struct nrlmsise_flags *flags, \
+                 struct nrlmsise_output *output);
+
+
 
 /* ------------------------------------------------------------------- */
 /* ----------------------- COMPILATION TWEAKS ------------------------ */
@@ -220,3 +306,7 @@ void ghp7 (struct nrlmsise_input *input, \
 #else
 #define __inline_double double
 #endif
+
+
+
+#endif /* NRLMSISE_00_H */
@@ -14,6 +14,7 @@
 #include "GNU_iomanip.h"
 
 #include "SAT_Const.h"
+#include "SAT_Context.h"
 #include "SAT_DE.h"
 #include "SAT_Force.h"
 #include "SAT_RefSys.h"
@@ -29,11 +30,8 @@ using namespace std;
 Matrix cnm(361, 361), snm(361, 361);
 const double R_ref = 6378.1363e3;   // Earth's radius [m]; GGM03C
 const double GM_ref = 398600.4415e9; // [m^3/s^2]; GGM03C
-eopdata eoparr[eopsize];
-spwdata spwarr[spwsize];
-int dat;
-double jdeopstart, dut1, lod, xp, yp, ddpsi, ddeps, dx, dy, x, y, s, deltapsi, deltaeps;
-double jdspwstart, f107a, f107, f107bar, ap, avgap, kp, sumkp, aparr[8], kparr[8];
+eoptable eoptab;
+spwtable spwtab;
 
 // Record for passing global data between Deriv and the calling program
 struct AuxParam {
@@ -41,10 +39,11 @@ struct AuxParam {
     double  Area_drag, Area_solar, mass, CR, CD;
     int     n, m;
     bool    Sun, Moon, SRad, Drag, SolidEarthTides, OceanTides, Relativity;
+    PropagationContext* Ctx;  // 每个任务独立的 EOP/空间天气状态
 };
 
 // Accel 函数定义
-Vector Accel(double Mjd_UTC, const Vector& r, const Vector& v, double Area_drag,
+Vector Accel(PropagationContext& Ctx, double Mjd_UTC, const Vector& r, const Vector& v, double Area_drag,
     double Area_solar, double mass, double CR, double CD, int n, int m,
     bool FlagSun, bool FlagMoon, bool FlagSRad, bool FlagDrag, bool
     FlagSolidEarthTides, bool FlagOceanTides, bool FlagRelativity)
@@ -53,20 +52,17 @@ Vector Accel(double Mjd_UTC, const Vector& r, const Vector& v, double Area_drag,
     double T1;     // Julian cent. since J2000
     Vector a(3), r_Sun(3), r_Moon(3);
     Matrix P(3, 3), N(3, 3), T(3, 3), E(3, 3);
-    char interp = 'l';
+    Mat3   Pi;
 
-    jd = Mjd_UTC + 2400000.5;
-    mfme = 1440.0 * (Mjd_UTC - floor(Mjd_UTC));
-    findeopparam(jd, mfme, interp, eoparr, jdeopstart, dut1, dat, lod, xp, yp,
-        ddpsi, ddeps, dx, dy, x, y, s, deltapsi, deltaeps);
-    IERS::Set(dut1, -dat, xp, yp);
-    Mjd_UT1 = Mjd_UTC + IERS::UT1_UTC(Mjd_UTC) / 86400.0;
-    Mjd_TT = Mjd_UTC + IERS::TT_UTC(Mjd_UTC) / 86400.0;
+    Ctx.Update(Mjd_UTC);
+    Mjd_UT1 = Mjd_UTC + Ctx.UT1_UTC() / 86400.0;
+    Mjd_TT = Mjd_UTC + Ctx.TT_UTC() / 86400.0;
 
     P = PrecMatrix(MJD_J2000, Mjd_TT);
     N = NutMatrix(Mjd_TT);
     T = N * P;
-    E = PoleMatrix(Mjd_UTC) * GHAMatrix(Mjd_UT1, Mjd_TT) * T;
+    PoleMatrix(Ctx, Pi);
+    E = Matrix(Pi) * GHAMatrix(Mjd_UT1, Mjd_TT) * T;
 
     T1 = (Mjd_TT - MJD_J2000) / 36525.0;
     r_Sun = AU * Transp(EclMatrix(Mjd_TT) * P) * SunPos(T1);
@@ -74,8 +70,8 @@ Vector Accel(double Mjd_UTC, const Vector& r, const Vector& v, double Area_drag,
 
     // Acceleration due to harmonic gravity field
     if (FlagSolidEarthTides || FlagOceanTides) {
-        a = AccelHarmonic_AnelasticEarth(Mjd_UTC, r, r_Sun, r_Moon, E, GM_ref, R_ref, cnm, snm,
-            n, m, xp, yp, FlagSolidEarthTides, FlagOceanTides);
+        a = Vector(AccelHarmonic_AnelasticEarth(Ctx, Mjd_UTC, Vec3(r), Vec3(r_Sun), Vec3(r_Moon),
+            Mat3(E), GM_ref, R_ref, cnm, snm, n, m, FlagSolidEarthTides, FlagOceanTides));
     }
     else { a = AccelHarmonic(r, E, GM_ref, R_ref, cnm, snm, n, m); }
 
@@ -87,7 +83,8 @@ Vector Accel(double Mjd_UTC, const Vector& r, const Vector& v, double Area_drag,
     if (FlagSRad) a += AccelSolrad(r, r_Sun, Area_solar, mass, CR, P_Sol, AU);
 
     // Atmospheric drag
-    if (FlagDrag) a += AccelDrag(Mjd_UTC, r, v, T, E, Area_drag, mass, CD);
+    if (FlagDrag) a += Vector(AccelDrag(Ctx, Mjd_UTC, Vec3(r), Vec3(v), Mat3(T), Mat3(E),
+                                        Area_drag, mass, CD));
 
     // Relativistic Effects
     if (FlagRelativity) a += Relativity(r, v);
@@ -112,7 +109,7 @@ void Deriv(double t, const Vector& y, Vector& yp, void* pAux)
     // Acceleration
     Vector a(3);
 
-    a = Accel(Mjd_UTC, r, v, (*p).Area_drag, (*p).Area_solar, (*p).mass, (*p).CR, (*p).CD,
+    a = Accel(*(*p).Ctx, Mjd_UTC, r, v, (*p).Area_drag, (*p).Area_solar, (*p).mass, (*p).CR, (*p).CD,
         (*p).n, (*p).m, (*p).Sun, (*p).Moon, (*p).SRad, (*p).Drag, (*p).SolidEarthTides,
         (*p).OceanTides, (*p).Relativity);
 
@@ -124,6 +121,8 @@ void Deriv(double t, const Vector& y, Vector& yp, void* pAux)
 void Ephemeris(const Vector& Y0, int N_Step, double Step, AuxParam p, vector<Vector>& Eph)
 {
     double t = 0.0;  // 初始时间
+    PropagationContext Ctx;             // 本任务独立的上下文，线程间不共享
+    p.Ctx = &Ctx;
     RK4       Orbit(Deriv, 6, &p);      // 创建 RK4 对象
     Vector    Y = Y0;
 
@@ -264,8 +263,8 @@ int main() {
     inp.close();
 
     // 初始化 eop 和 spw 数据
-    initeop(eoparr, jdeopstart);
-    initspw(spwarr, jdspwstart);
+    initeop("D:\\HPOP_code\\HPOP_RK4\\EOP-All_2025.txt", eoptab);
+    initspw("D:\\HPOP_code\\HPOP_RK4\\sw_2025.txt", spwtab);
 
     // 打开卫星初始状态文件
     FILE* f1;
@@ -292,6 +291,7 @@ int main() {
     Aux.SolidEarthTides = false;
     Aux.OceanTides = false;
     Aux.Relativity = false;
+    Aux.Ctx = 0;
 
     // 创建线程池
     ThreadPool pool;